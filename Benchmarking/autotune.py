@@ -0,0 +1,162 @@
+import argparse
+import itertools
+import json
+import math
+import os
+import statistics
+import subprocess as subp
+import sys
+import tempfile
+
+# The compiler flags to tune, with their candidate values. The first value is the default.
+COMPILER_KNOBS = {
+  'max-stack-array-size': [256, 64, 128, 512, 1024, 4096],
+  'specialization-budget': [2048, 0, 512, 8192],
+}
+
+# The runtime environment variables to tune, with their candidate values. The first value is the
+# default (see `read_tunables` in `runtime.cc`).
+RUNTIME_KNOBS = {
+  'MVS_ARRAY_GROWTH': [200, 150, 300, 400],
+  'MVS_ARRAY_MIN_CAPACITY': [4, 1, 16, 64],
+}
+
+# The two-sided 95% quantiles of Student's t-distribution, indexed by degrees of freedom.
+T95 = {
+  1: 12.71, 2: 4.30, 3: 3.18, 4: 2.78, 5: 2.57, 6: 2.45, 7: 2.36, 8: 2.31, 9: 2.26, 10: 2.23,
+  15: 2.13, 20: 2.09, 30: 2.04,
+}
+
+
+def t95(dof):
+  return T95[max(k for k in T95 if k <= dof)]
+
+
+class Measurement:
+
+  def __init__(self, samples):
+    self.samples = samples
+    self.mean = statistics.mean(samples)
+    self.half_width = t95(len(samples) - 1) * statistics.stdev(samples) / math.sqrt(len(samples))
+
+  def is_faster_than(self, other):
+    """Returns whether this measurement is faster than `other` with 95% confidence."""
+    return self.mean + self.half_width < other.mean - other.half_width
+
+  def __str__(self):
+    return f'{self.mean / 1e6:.3f}ms ± {self.half_width / 1e6:.3f}ms (n={len(self.samples)})'
+
+
+class Workload:
+
+  def __init__(self, source, args, workdir):
+    self.source = source
+    self.args = args
+    self.workdir = workdir
+    self.binaries = {}
+
+    # Compile the runtime once.
+    self.runtime = os.path.join(workdir, 'runtime.o')
+    subp.run(
+      ['clang++', '-std=c++14', '-O2', '-c', 'Runtime/runtime.cc', '-o', self.runtime],
+      check=True)
+
+  def binary(self, flags):
+    """Returns the path of the workload compiled with the given compiler flags."""
+    key = tuple(sorted(flags.items()))
+    if key in self.binaries:
+      return self.binaries[key]
+
+    name = '-'.join(f'{k}={v}' for (k, v) in key)
+    obj = os.path.join(self.workdir, f'{name}.o')
+    out = os.path.join(self.workdir, f'{name}.out')
+    subp.run(
+      ['.build/release/mvs', self.source, '-O', '--benchmark', str(self.args.iterations),
+       '-o', obj] + [f'--{k}={v}' for (k, v) in key],
+      check=True)
+    subp.run(['clang++', obj, self.runtime, '-o', out], check=True)
+
+    self.binaries[key] = out
+    return out
+
+  def measure(self, config):
+    """Runs the workload with the given configuration until the 95% confidence interval of its
+    mean execution time is narrow enough, or the maximum number of runs is reached."""
+    flags = {k: v for (k, v) in config.items() if k in COMPILER_KNOBS}
+    env = dict(os.environ, **{k: str(v) for (k, v) in config.items() if k in RUNTIME_KNOBS})
+    binary = self.binary(flags)
+
+    samples = []
+    for i in itertools.count(start=1):
+      result = subp.run([binary], env=env, stdout=subp.PIPE, check=True)
+      lines = list(filter(None, result.stdout.decode('utf-8').split('\n')))
+      samples.append(float(lines[-1]))
+
+      if i >= self.args.min_runs:
+        m = Measurement(samples)
+        if (m.half_width <= self.args.tolerance * m.mean) or (i >= self.args.max_runs):
+          return m
+
+
+def tune(workload, args):
+  knobs = dict(COMPILER_KNOBS, **RUNTIME_KNOBS)
+  default = {k: values[0] for (k, values) in knobs.items()}
+  baseline = workload.measure(default)
+  print(f'baseline: {baseline}')
+
+  # Coordinate descent: tune one knob at a time, keeping the others at their best value, until a
+  # full pass yields no significant improvement.
+  best, best_time = dict(default), baseline
+  for _ in range(args.passes):
+    improved = False
+    for (knob, values) in knobs.items():
+      for value in values:
+        if value == best[knob]:
+          continue
+        candidate = dict(best, **{knob: value})
+        m = workload.measure(candidate)
+        print(f'  {knob}={value}: {m}')
+        if m.is_faster_than(best_time):
+          best, best_time, improved = candidate, m, True
+          print(f'  -> keeping {knob}={value}')
+    if not improved:
+      break
+
+  return {
+    'workload': workload.source,
+    'config': best,
+    'changes': {k: v for (k, v) in best.items() if v != default[k]},
+    'baseline_ms': baseline.mean / 1e6,
+    'best_ms': best_time.mean / 1e6,
+    'speedup': baseline.mean / best_time.mean,
+  }
+
+
+def main():
+  parser = argparse.ArgumentParser(
+    description='Searches the compiler flags and runtime knobs that minimize the execution time '
+                'of a workload, compiled in benchmark mode.')
+  parser.add_argument('source', help='the MVS program to tune')
+  parser.add_argument('--iterations', type=int, default=100,
+                      help='number of iterations of the program per run')
+  parser.add_argument('--min-runs', type=int, default=5)
+  parser.add_argument('--max-runs', type=int, default=30)
+  parser.add_argument('--tolerance', type=float, default=0.02,
+                      help='maximum half-width of the confidence interval, relative to the mean')
+  parser.add_argument('--passes', type=int, default=2,
+                      help='maximum number of passes over all knobs')
+  parser.add_argument('-o', '--output', help='write the best configuration to this JSON file')
+  args = parser.parse_args()
+
+  with tempfile.TemporaryDirectory() as workdir:
+    report = tune(Workload(args.source, args, workdir), args)
+
+  text = json.dumps(report, indent=2)
+  print(text)
+  if args.output:
+    with open(args.output, 'w') as f:
+      f.write(text + '\n')
+
+
+if __name__ == '__main__':
+  main()
@@ -1,4 +1,6 @@
+import argparse
 import itertools
+import math
 import numpy as np
 import os
 import pathlib
@@ -10,79 +12,128 @@ from .generator.gen import ROOT_DIR, SRC_DIR
 
 RUN_COUNT = 20
 OUT_DIR = os.path.join(ROOT_DIR, 'out')
-
-
-def collect_runs_p50(binary):
+CANONICAL_DIR = os.path.join(ROOT_DIR, 'canonical')
+
+# The hand-written benchmarks in `CANONICAL_DIR`, with their input size at each scale. Sources
+# contain the placeholder `@N@`, which is substituted by the input size.
+CANONICAL_SIZES = {
+  'nbody':        {'small': 100_000, 'medium': 1_000_000, 'large': 5_000_000},
+  'spectralnorm': {'small': 500,     'medium': 1_000,     'large': 3_000},
+  'binarytrees':  {'small': 12,      'medium': 16,        'large': 18},
+  'fannkuch':     {'small': 8,       'medium': 10,        'large': 11},
+  'mandelbrot':   {'small': 500,     'medium': 1_000,     'large': 4_000},
+  'knucleotide':  {'small': 100_000, 'medium': 1_000_000, 'large': 5_000_000},
+}
+
+# The compared languages, in the order of the report's columns.
+LANGUAGES = ['cpp', 'mvs', 'swift', 'scala']
+
+
+def run(binary):
+  """Runs `binary` and returns its standard output along with its maximum resident set size, as
+  reported by the operating system."""
+  proc = subp.Popen([binary], stderr=subp.DEVNULL, stdout=subp.PIPE)
+  stdout = proc.stdout.read()
+  proc.stdout.close()
+
+  (_, status, usage) = os.wait4(proc.pid, 0)
+  proc.returncode = os.waitstatus_to_exitcode(status)
+  if proc.returncode != 0:
+    raise subp.CalledProcessError(proc.returncode, binary)
+  return (stdout, usage.ru_maxrss)
+
+
+def collect_runs_p50(binary, runs=RUN_COUNT):
   exec_time = []
   memo_cons = []
 
-  for x in range(RUN_COUNT):
+  for x in range(runs):
     # Run the binary.
-    result = subp.run([binary], stderr=subp.PIPE, stdout=subp.PIPE, check=True)
+    (stdout, maxrss) = run(binary)
 
     # Parse the binary's output.
-    lines = list(filter(lambda x: x, result.stdout.decode('utf-8').split('\n')))
+    lines = list(filter(lambda x: x, stdout.decode('utf-8').split('\n')))
     value = float(lines[0])
     xtime = float(lines[-1])
     print(f'  {value:.5g} {xtime / 1_000_000:.2f}ms')
 
     # Store results.
     exec_time.append(xtime)
-    memo_cons.append(0)#float(result.stderr.splitlines()[1].split()[0]))  # Max resident set size
+    memo_cons.append(maxrss)
 
   print()
 
-  # Return the median of measured execution times and memory consumption.
+  # Return the median of measured execution times and memory consumption, along with the value
+  # computed by the last run.
   x = np.percentile(exec_time, 50)
   y = np.percentile(memo_cons, 50)
-  return (x, y)
+  return (x, y, value)
 
 
-def bench_cpp(prefix, process_kwargs):
+def bench_cpp(prefix, process_kwargs, src_dir=SRC_DIR, runs=RUN_COUNT):
   print('## cpp')
   process_kwargs['timeout'] = 300
   subp.run(
-    ['clang++', '-std=c++14', '-O2', f'{SRC_DIR}/{prefix}.cpp', '-o', f'{OUT_DIR}/{prefix}.cpp.out'],
+    ['clang++', '-std=c++14', '-O2', f'{src_dir}/{prefix}.cpp', '-o', f'{OUT_DIR}/{prefix}.cpp.out'],
     **process_kwargs)
-  return collect_runs_p50(f'./{OUT_DIR}/{prefix}.cpp.out')
+  return collect_runs_p50(f'./{OUT_DIR}/{prefix}.cpp.out', runs)
 
 
-def bench_mvs(prefix, process_kwargs):
+def bench_mvs(
+  prefix, process_kwargs, src_dir=SRC_DIR, flags=[], runtime_flags=[], runs=RUN_COUNT
+):
   print('## mvs')
   subp.run(
     [
-      '.build/release/mvs', f'{SRC_DIR}/{prefix}.mvs',
+      '.build/release/mvs', f'{src_dir}/{prefix}.mvs',
      '-o', f'{OUT_DIR}/{prefix}.mvs.o'
-    ],
+    ] + flags,
     **process_kwargs)
   subp.run(
     [
       'clang++', '-std=c++14', f'{OUT_DIR}/{prefix}.mvs.o', 'Runtime/runtime.cc',
       '-o', f'{OUT_DIR}/{prefix}.mvs.out'
-    ],
+    ] + runtime_flags,
     **process_kwargs)
-  return collect_runs_p50(f'./{OUT_DIR}/{prefix}.mvs.out')
+  return collect_runs_p50(f'./{OUT_DIR}/{prefix}.mvs.out', runs)
 
 
-def bench_swift(prefix, process_kwargs):
+def bench_swift(prefix, process_kwargs, src_dir=SRC_DIR):
   print('## swift')
   subp.run(
-    ['swiftc', '-Ounchecked', f'{SRC_DIR}/{prefix}.swift', '-o', f'{OUT_DIR}/{prefix}.swift.out'],
+    ['swiftc', '-Ounchecked', f'{src_dir}/{prefix}.swift', '-o', f'{OUT_DIR}/{prefix}.swift.out'],
     **process_kwargs)
   return collect_runs_p50(f'./{OUT_DIR}/{prefix}.swift.out')
 
 
-def bench_scala(prefix, process_kwargs):
+def bench_scala(prefix, process_kwargs, src_dir=SRC_DIR):
   print('## scala')
   os.makedirs(f'{SRC_DIR}/main/scala', exist_ok=True)
-  sh.copyfile(f'{SRC_DIR}/{prefix}.scala', f'{SRC_DIR}/main/scala/gen.scala')
+  sh.copyfile(f'{src_dir}/{prefix}.scala', f'{SRC_DIR}/main/scala/gen.scala')
   subp.run(
     ['sbt', 'nativeLink'], cwd=f'{ROOT_DIR}/',
     **process_kwargs)
   return collect_runs_p50(f'./{ROOT_DIR}/target/scala-2.12/gen-out')
 
 
-def main(verbose=False):
+def instantiate(name, scale):
+  """Writes the sources of a canonical benchmark at the given scale to `OUT_DIR` and returns
+  their prefix."""
+  prefix = f'{name}-{scale}'
+  size = str(CANONICAL_SIZES[name][scale])
+  for lang in LANGUAGES:
+    with open(f'{CANONICAL_DIR}/{name}.{lang}') as f_in:
+      with open(f'{OUT_DIR}/{prefix}.{lang}', 'w') as f_out:
+        f_out.write(f_in.read().replace('@N@', size))
+  return prefix
+
+
+def is_valid(value, expected):
+  # MVS prints floating-point numbers with six decimal places.
+  return math.isclose(value, expected, rel_tol=1e-9, abs_tol=1e-6)
+
+
+def create_report():
   # Create the output directory.
   if not os.path.exists(OUT_DIR):
     os.makedirs(OUT_DIR)
@@ -94,16 +145,58 @@ def main(verbose=False):
     report_filename = os.path.join(ROOT_DIR, f'results.{i}.csv')
     i = i + 1
 
+  f = open(report_filename, 'w')
+  f.write('bench-name,')
+  f.write('cpp-time,cpp-memo,')
+  f.write('mvs-time,mvs-memo,')
+  f.write('swift-time,swift-memo,')
+  f.write('scala-time,scala-memo\n')
+  f.flush()
+  return f
+
+
+def main_canonical(names, scale, verbose=False):
+  process_kwargs = dict(stderr=subp.PIPE, stdout=subp.PIPE, check=True) if not verbose else {}
+
+  with create_report() as f:
+    for name in names:
+      print(f'# Benchmarking {name} ({scale})')
+      prefix = instantiate(name, scale)
+
+      # Compile and measure performances. The C++ version is the reference implementation; a
+      # language that fails or computes a different value is reported with a time of zero.
+      results = {}
+      for lang in LANGUAGES:
+        try:
+          if lang == 'cpp':
+            results[lang] = bench_cpp(prefix, process_kwargs, src_dir=OUT_DIR)
+          elif lang == 'mvs':
+            results[lang] = bench_mvs(
+              prefix, process_kwargs, src_dir=OUT_DIR, flags=['-O', '--benchmark', '1'])
+          elif lang == 'swift':
+            results[lang] = bench_swift(prefix, process_kwargs, src_dir=OUT_DIR)
+          else:
+            results[lang] = bench_scala(prefix, process_kwargs, src_dir=OUT_DIR)
+        except Exception as e:
+          print(f'Benchmark {prefix} failed in {lang}: {e}\n')
+          results[lang] = (0, 0, math.nan)
+
+      expected = results['cpp'][2]
+      for (lang, (_, _, value)) in results.items():
+        if not is_valid(value, expected):
+          print(f'Benchmark {prefix} computed {value} in {lang}, expected {expected}\n')
+          results[lang] = (0, 0, value)
+
+      f.write(f'{prefix},')
+      f.write(','.join(f'{results[lang][0]},{results[lang][1]}' for lang in LANGUAGES) + '\n')
+      f.flush()
+
+
+def main(verbose=False):
   process_kwargs = dict(stderr=subp.PIPE, stdout=subp.PIPE, check=True) if not verbose else {}
 
   # Run the benchmarks.
-  with open(report_filename, 'w') as f:
-    f.write('bench-name,')
-    f.write('cpp-time,cpp-memo,')
-    f.write('mvs-time,mvs-memo,')
-    f.write('swift-time,swift-memo,')
-    f.write('scala-time,scala-memo\n')
-    f.flush()
+  with create_report() as f:
 
     for i in itertools.count(start=1):
       prefix = f'gen{i}'
@@ -125,10 +218,10 @@ def main(verbose=False):
 
       # Compile and measure performances.
       try:
-        (mvs_time, mvs_memo) = bench_mvs(prefix, process_kwargs)
-        (cpp_time, cpp_memo) = bench_cpp(prefix, process_kwargs)
-        (swf_time, swf_memo) = bench_swift(prefix, process_kwargs)
-        (scl_time, scl_memo) = bench_scala(prefix, process_kwargs)
+        (mvs_time, mvs_memo, _) = bench_mvs(prefix, process_kwargs)
+        (cpp_time, cpp_memo, _) = bench_cpp(prefix, process_kwargs)
+        (swf_time, swf_memo, _) = bench_swift(prefix, process_kwargs)
+        (scl_time, scl_memo, _) = bench_scala(prefix, process_kwargs)
 
         f.write(f'{prefix},')
         f.write(f'{cpp_time},{cpp_memo},')
@@ -143,4 +236,17 @@ def main(verbose=False):
 
 
 if __name__ == '__main__':
-  main()
+  parser = argparse.ArgumentParser(
+    description='Compares the performance of MVS, C++, Swift and Scala, on randomly generated '
+                'programs or on canonical benchmarks.')
+  parser.add_argument('--canonical', nargs='*', choices=sorted(CANONICAL_SIZES), metavar='NAME',
+                      help='run the given canonical benchmarks (all if none is given)')
+  parser.add_argument('--scale', choices=['small', 'medium', 'large'], default='medium',
+                      help='the input size of the canonical benchmarks')
+  parser.add_argument('-v', '--verbose', action='store_true')
+  args = parser.parse_args()
+
+  if args.canonical is None:
+    main(verbose=args.verbose)
+  else:
+    main_canonical(args.canonical or list(CANONICAL_SIZES), args.scale, verbose=args.verbose)
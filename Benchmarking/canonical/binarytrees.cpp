@@ -0,0 +1,46 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+struct Node {
+  std::unique_ptr<Node> left;
+  std::unique_ptr<Node> right;
+};
+
+std::unique_ptr<Node> make(int depth) {
+  std::unique_ptr<Node> node(new Node());
+  if (depth > 0) {
+    node->left = make(depth - 1);
+    node->right = make(depth - 1);
+  }
+  return node;
+}
+
+double check(const Node& node) {
+  if (node.left) {
+    return 1.0 + check(*node.left) + check(*node.right);
+  }
+  return 1.0;
+}
+
+int main() {
+  auto start = std::chrono::steady_clock::now();
+
+  const int n = @N@;
+  const int max_depth = n < 6 ? 6 : n;
+  double total = check(*make(max_depth + 1));
+
+  std::unique_ptr<Node> long_lived = make(max_depth);
+  for (int depth = 4; depth <= max_depth; depth += 2) {
+    const int iterations = 1 << (max_depth - depth + 4);
+    for (int i = 0; i < iterations; ++i) {
+      total = total + check(*make(depth));
+    }
+  }
+  const double value = total + check(*long_lived);
+
+  auto end = std::chrono::steady_clock::now();
+  printf("%f\n", value);
+  printf("%lld\n", (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+  return 0;
+}
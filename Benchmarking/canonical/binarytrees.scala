@@ -0,0 +1,36 @@
+import java.lang.System.nanoTime
+
+final class Node(val left: Node, val right: Node)
+
+object Main {
+
+  def make(depth: Int): Node =
+    if (depth == 0) new Node(null, null)
+    else new Node(make(depth - 1), make(depth - 1))
+
+  def check(node: Node): Double =
+    if (node.left == null) 1.0
+    else 1.0 + check(node.left) + check(node.right)
+
+  def main(args: Array[String]): Unit = {
+    val start = nanoTime()
+
+    val n = @N@
+    val maxDepth = if (n < 6) 6 else n
+    var total = check(make(maxDepth + 1))
+
+    val longLived = make(maxDepth)
+    for (depth <- 4 to maxDepth by 2) {
+      val iterations = 1 << (maxDepth - depth + 4)
+      for (_ <- 0 until iterations) {
+        total = total + check(make(depth))
+      }
+    }
+    val value = total + check(longLived)
+
+    val end = nanoTime()
+    println(value)
+    println(end - start)
+  }
+
+}
@@ -0,0 +1,46 @@
+import Dispatch
+
+final class Node {
+  let left: Node?
+  let right: Node?
+
+  init(left: Node?, right: Node?) {
+    self.left = left
+    self.right = right
+  }
+}
+
+func make(_ depth: Int) -> Node {
+  return depth == 0
+    ? Node(left: nil, right: nil)
+    : Node(left: make(depth - 1), right: make(depth - 1))
+}
+
+func check(_ node: Node) -> Double {
+  if let left = node.left, let right = node.right {
+    return 1.0 + check(left) + check(right)
+  }
+  return 1.0
+}
+
+func benchmark() {
+  let start = DispatchTime.now().uptimeNanoseconds
+
+  let n = @N@
+  let maxDepth = n < 6 ? 6 : n
+  var total = check(make(maxDepth + 1))
+
+  let longLived = make(maxDepth)
+  for depth in stride(from: 4, through: maxDepth, by: 2) {
+    let iterations = 1 << (maxDepth - depth + 4)
+    for _ in 0 ..< iterations {
+      total = total + check(make(depth))
+    }
+  }
+  let value = total + check(longLived)
+
+  let end = DispatchTime.now().uptimeNanoseconds
+  print(value)
+  print(end - start)
+}
+benchmark()
@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+int main() {
+  auto start = std::chrono::steady_clock::now();
+
+  const int n = @N@;
+  std::vector<int> perm(n), perm1(n), count(n);
+  for (int i = 0; i < n; ++i) {
+    perm1[i] = i;
+  }
+
+  double max_flips = 0.0;
+  double checksum = 0.0;
+  int perm_count = 0;
+  int r = n;
+  bool done = false;
+  while (!done) {
+    while (r != 1) {
+      count[r - 1] = r;
+      r = r - 1;
+    }
+
+    // Count the flips needed to bring the first element to its place.
+    std::copy(perm1.begin(), perm1.end(), perm.begin());
+    double flips = 0.0;
+    while (perm[0] != 0) {
+      std::reverse(perm.begin(), perm.begin() + perm[0] + 1);
+      flips = flips + 1.0;
+    }
+    max_flips = std::max(max_flips, flips);
+    checksum = (perm_count % 2 == 0) ? checksum + flips : checksum - flips;
+
+    // Advance to the next permutation.
+    while (true) {
+      if (r == n) {
+        done = true;
+        break;
+      }
+      const int perm0 = perm1[0];
+      std::copy(perm1.begin() + 1, perm1.begin() + r + 1, perm1.begin());
+      perm1[r] = perm0;
+      count[r] = count[r] - 1;
+      if (count[r] > 0) {
+        break;
+      }
+      r = r + 1;
+    }
+    perm_count = perm_count + 1;
+  }
+  const double value = checksum * 100.0 + max_flips;
+
+  auto end = std::chrono::steady_clock::now();
+  printf("%f\n", value);
+  printf("%lld\n", (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+  return 0;
+}
@@ -0,0 +1,66 @@
+import java.lang.System.nanoTime
+
+object Main {
+
+  def main(args: Array[String]): Unit = {
+    val start = nanoTime()
+
+    val n = @N@
+    val perm = new Array[Int](n)
+    val perm1 = Array.tabulate(n)(i => i)
+    val count = new Array[Int](n)
+
+    var maxFlips = 0.0
+    var checksum = 0.0
+    var permCount = 0
+    var r = n
+    var done = false
+    while (!done) {
+      while (r != 1) {
+        count(r - 1) = r
+        r = r - 1
+      }
+
+      // Count the flips needed to bring the first element to its place.
+      System.arraycopy(perm1, 0, perm, 0, n)
+      var flips = 0.0
+      while (perm(0) != 0) {
+        var i = 0
+        var j = perm(0)
+        while (i < j) {
+          val t = perm(i)
+          perm(i) = perm(j)
+          perm(j) = t
+          i += 1
+          j -= 1
+        }
+        flips = flips + 1.0
+      }
+      maxFlips = math.max(maxFlips, flips)
+      checksum = if (permCount % 2 == 0) checksum + flips else checksum - flips
+
+      // Advance to the next permutation.
+      var more = true
+      while (more) {
+        if (r == n) {
+          done = true
+          more = false
+        } else {
+          val perm0 = perm1(0)
+          System.arraycopy(perm1, 1, perm1, 0, r)
+          perm1(r) = perm0
+          count(r) = count(r) - 1
+          if (count(r) > 0) more = false
+          else r = r + 1
+        }
+      }
+      permCount = permCount + 1
+    }
+    val value = checksum * 100.0 + maxFlips
+
+    val end = nanoTime()
+    println(value)
+    println(end - start)
+  }
+
+}
@@ -0,0 +1,57 @@
+import Dispatch
+
+func benchmark() {
+  let start = DispatchTime.now().uptimeNanoseconds
+
+  let n = @N@
+  var perm = [Int](repeating: 0, count: n)
+  var perm1 = Array(0 ..< n)
+  var count = [Int](repeating: 0, count: n)
+
+  var maxFlips = 0.0
+  var checksum = 0.0
+  var permCount = 0
+  var r = n
+  var done = false
+  while !done {
+    while r != 1 {
+      count[r - 1] = r
+      r = r - 1
+    }
+
+    // Count the flips needed to bring the first element to its place.
+    perm = perm1
+    var flips = 0.0
+    while perm[0] != 0 {
+      perm[0 ... perm[0]].reverse()
+      flips = flips + 1.0
+    }
+    maxFlips = max(maxFlips, flips)
+    checksum = permCount % 2 == 0 ? checksum + flips : checksum - flips
+
+    // Advance to the next permutation.
+    while true {
+      if r == n {
+        done = true
+        break
+      }
+      let perm0 = perm1[0]
+      for i in 0 ..< r {
+        perm1[i] = perm1[i + 1]
+      }
+      perm1[r] = perm0
+      count[r] = count[r] - 1
+      if count[r] > 0 {
+        break
+      }
+      r = r + 1
+    }
+    permCount = permCount + 1
+  }
+  let value = checksum * 100.0 + maxFlips
+
+  let end = DispatchTime.now().uptimeNanoseconds
+  print(value)
+  print(end - start)
+}
+benchmark()
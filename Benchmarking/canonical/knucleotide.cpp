@@ -0,0 +1,48 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+/// Counts the occurrences of every `k`-nucleotide of `seq` and returns the number of distinct
+/// keys plus the sum of the squared counts.
+double count(const std::vector<int64_t>& seq, int k) {
+  std::unordered_map<int64_t, int64_t> freq;
+  const int64_t mask = (int64_t(1) << (2 * k)) - 1;
+  int64_t key = 0;
+  for (size_t i = 0; i < seq.size(); ++i) {
+    key = ((key << 2) | seq[i]) & mask;
+    if (int(i) + 1 >= k) {
+      freq[key] += 1;
+    }
+  }
+
+  double result = freq.size();
+  for (const auto& entry : freq) {
+    result = result + double(entry.second) * double(entry.second);
+  }
+  return result;
+}
+
+int main() {
+  auto start = std::chrono::steady_clock::now();
+
+  // Generate a pseudo-random sequence of nucleotides, encoded on two bits.
+  const int n = @N@;
+  std::vector<int64_t> seq;
+  int64_t seed = 42;
+  for (int i = 0; i < n; ++i) {
+    seed = (seed * 3877 + 29573) % 139968;
+    seq.push_back(seed * 4 / 139968);
+  }
+
+  double value = 0.0;
+  for (int k : { 1, 2, 3, 4, 6, 12, 18 }) {
+    value = value + count(seq, k);
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  printf("%f\n", value);
+  printf("%lld\n", (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+  return 0;
+}
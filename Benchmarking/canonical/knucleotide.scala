@@ -0,0 +1,48 @@
+import java.lang.System.nanoTime
+import scala.collection.mutable
+
+object Main {
+
+  /** Counts the occurrences of every `k`-nucleotide of `seq` and returns the number of distinct
+   *  keys plus the sum of the squared counts. */
+  def count(seq: Array[Long], k: Int): Double = {
+    val freq = mutable.HashMap.empty[Long, Long]
+    val mask = (1L << (2 * k)) - 1
+    var key = 0L
+    for (i <- seq.indices) {
+      key = ((key << 2) | seq(i)) & mask
+      if (i + 1 >= k) {
+        freq(key) = freq.getOrElse(key, 0L) + 1
+      }
+    }
+
+    var result = freq.size.toDouble
+    for (c <- freq.values) {
+      result = result + c.toDouble * c.toDouble
+    }
+    result
+  }
+
+  def main(args: Array[String]): Unit = {
+    val start = nanoTime()
+
+    // Generate a pseudo-random sequence of nucleotides, encoded on two bits.
+    val n = @N@
+    val seq = new Array[Long](n)
+    var seed = 42L
+    for (i <- 0 until n) {
+      seed = (seed * 3877 + 29573) % 139968
+      seq(i) = seed * 4 / 139968
+    }
+
+    var value = 0.0
+    for (k <- List(1, 2, 3, 4, 6, 12, 18)) {
+      value = value + count(seq, k)
+    }
+
+    val end = nanoTime()
+    println(value)
+    println(end - start)
+  }
+
+}
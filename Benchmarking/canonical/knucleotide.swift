@@ -0,0 +1,45 @@
+import Dispatch
+
+/// Counts the occurrences of every `k`-nucleotide of `seq` and returns the number of distinct
+/// keys plus the sum of the squared counts.
+func count(_ seq: [Int], _ k: Int) -> Double {
+  var freq: [Int: Int] = [:]
+  let mask = (1 << (2 * k)) - 1
+  var key = 0
+  for i in 0 ..< seq.count {
+    key = ((key << 2) | seq[i]) & mask
+    if i + 1 >= k {
+      freq[key, default: 0] += 1
+    }
+  }
+
+  var result = Double(freq.count)
+  for c in freq.values {
+    result = result + Double(c) * Double(c)
+  }
+  return result
+}
+
+func benchmark() {
+  let start = DispatchTime.now().uptimeNanoseconds
+
+  // Generate a pseudo-random sequence of nucleotides, encoded on two bits.
+  let n = @N@
+  var seq: [Int] = []
+  seq.reserveCapacity(n)
+  var seed = 42
+  for _ in 0 ..< n {
+    seed = (seed * 3877 + 29573) % 139968
+    seq.append(seed * 4 / 139968)
+  }
+
+  var value = 0.0
+  for k in [1, 2, 3, 4, 6, 12, 18] {
+    value = value + count(seq, k)
+  }
+
+  let end = DispatchTime.now().uptimeNanoseconds
+  print(value)
+  print(end - start)
+}
+benchmark()
@@ -0,0 +1,33 @@
+#include <chrono>
+#include <cstdio>
+
+int main() {
+  auto start = std::chrono::steady_clock::now();
+
+  const int n = @N@;
+  double count = 0.0;
+  for (int y = 0; y < n; ++y) {
+    const double ci = 2.0 * y / n - 1.0;
+    for (int x = 0; x < n; ++x) {
+      const double cr = 2.0 * x / n - 1.5;
+      double zr = 0.0;
+      double zi = 0.0;
+      bool escaped = false;
+      for (int i = 0; i < 50 && !escaped; ++i) {
+        const double tr = zr * zr - zi * zi + cr;
+        zi = 2.0 * zr * zi + ci;
+        zr = tr;
+        escaped = zr * zr + zi * zi > 4.0;
+      }
+      if (!escaped) {
+        count = count + 1.0;
+      }
+    }
+  }
+  const double value = count;
+
+  auto end = std::chrono::steady_clock::now();
+  printf("%f\n", value);
+  printf("%lld\n", (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+  return 0;
+}
@@ -0,0 +1,41 @@
+import java.lang.System.nanoTime
+
+object Main {
+
+  def main(args: Array[String]): Unit = {
+    val start = nanoTime()
+
+    val n = @N@
+    var count = 0.0
+    var y = 0
+    while (y < n) {
+      val ci = 2.0 * y / n - 1.0
+      var x = 0
+      while (x < n) {
+        val cr = 2.0 * x / n - 1.5
+        var zr = 0.0
+        var zi = 0.0
+        var escaped = false
+        var i = 0
+        while (i < 50 && !escaped) {
+          val tr = zr * zr - zi * zi + cr
+          zi = 2.0 * zr * zi + ci
+          zr = tr
+          escaped = zr * zr + zi * zi > 4.0
+          i += 1
+        }
+        if (!escaped) {
+          count = count + 1.0
+        }
+        x += 1
+      }
+      y += 1
+    }
+    val value = count
+
+    val end = nanoTime()
+    println(value)
+    println(end - start)
+  }
+
+}
@@ -0,0 +1,34 @@
+import Dispatch
+
+func benchmark() {
+  let start = DispatchTime.now().uptimeNanoseconds
+
+  let n = @N@
+  var count = 0.0
+  for y in 0 ..< n {
+    let ci = 2.0 * Double(y) / Double(n) - 1.0
+    for x in 0 ..< n {
+      let cr = 2.0 * Double(x) / Double(n) - 1.5
+      var zr = 0.0
+      var zi = 0.0
+      var escaped = false
+      var i = 0
+      while i < 50 && !escaped {
+        let tr = zr * zr - zi * zi + cr
+        zi = 2.0 * zr * zi + ci
+        zr = tr
+        escaped = zr * zr + zi * zi > 4.0
+        i = i + 1
+      }
+      if !escaped {
+        count = count + 1.0
+      }
+    }
+  }
+  let value = count
+
+  let end = DispatchTime.now().uptimeNanoseconds
+  print(value)
+  print(end - start)
+}
+benchmark()
@@ -0,0 +1,103 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+struct Body {
+  double x, y, z, vx, vy, vz, m;
+};
+
+const double pi = 3.141592653589793;
+const double solar_mass = 4.0 * pi * pi;
+const double days_per_year = 365.24;
+
+void advance(std::vector<Body>& bodies, double dt) {
+  const size_t n = bodies.size();
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = i + 1; j < n; ++j) {
+      const double dx = bodies[i].x - bodies[j].x;
+      const double dy = bodies[i].y - bodies[j].y;
+      const double dz = bodies[i].z - bodies[j].z;
+      const double d2 = dx * dx + dy * dy + dz * dz;
+      const double mag = dt / (d2 * std::sqrt(d2));
+      bodies[i].vx = bodies[i].vx - dx * bodies[j].m * mag;
+      bodies[i].vy = bodies[i].vy - dy * bodies[j].m * mag;
+      bodies[i].vz = bodies[i].vz - dz * bodies[j].m * mag;
+      bodies[j].vx = bodies[j].vx + dx * bodies[i].m * mag;
+      bodies[j].vy = bodies[j].vy + dy * bodies[i].m * mag;
+      bodies[j].vz = bodies[j].vz + dz * bodies[i].m * mag;
+    }
+  }
+  for (auto& b : bodies) {
+    b.x = b.x + dt * b.vx;
+    b.y = b.y + dt * b.vy;
+    b.z = b.z + dt * b.vz;
+  }
+}
+
+double energy(const std::vector<Body>& bodies) {
+  double e = 0.0;
+  const size_t n = bodies.size();
+  for (size_t i = 0; i < n; ++i) {
+    const Body& b = bodies[i];
+    e = e + 0.5 * b.m * (b.vx * b.vx + b.vy * b.vy + b.vz * b.vz);
+    for (size_t j = i + 1; j < n; ++j) {
+      const double dx = b.x - bodies[j].x;
+      const double dy = b.y - bodies[j].y;
+      const double dz = b.z - bodies[j].z;
+      e = e - b.m * bodies[j].m / std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+  }
+  return e;
+}
+
+void offset_momentum(std::vector<Body>& bodies) {
+  double px = 0.0, py = 0.0, pz = 0.0;
+  for (const auto& b : bodies) {
+    px = px + b.vx * b.m;
+    py = py + b.vy * b.m;
+    pz = pz + b.vz * b.m;
+  }
+  bodies[0].vx = 0.0 - px / solar_mass;
+  bodies[0].vy = 0.0 - py / solar_mass;
+  bodies[0].vz = 0.0 - pz / solar_mass;
+}
+
+int main() {
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<Body> bodies = {
+    { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, solar_mass },
+    {
+      4.84143144246472090e+00, -1.16032004402742839e+00, -1.03622044471123109e-01,
+      1.66007664274403694e-03 * days_per_year, 7.69901118419740425e-03 * days_per_year,
+      -6.90460016972063023e-05 * days_per_year, 9.54791938424326609e-04 * solar_mass
+    },
+    {
+      8.34336671824457987e+00, 4.12479856412430479e+00, -4.03523417114321381e-01,
+      -2.76742510726862411e-03 * days_per_year, 4.99852801234917238e-03 * days_per_year,
+      2.30417297573763929e-05 * days_per_year, 2.85885980666130812e-04 * solar_mass
+    },
+    {
+      1.28943695621391310e+01, -1.51111514016986312e+01, -2.23307578892655734e-01,
+      2.96460137564761618e-03 * days_per_year, 2.37847173959480950e-03 * days_per_year,
+      -2.96589568540237556e-05 * days_per_year, 4.36624404335156298e-05 * solar_mass
+    },
+    {
+      1.53796971148509165e+01, -2.59193146099879641e+01, 1.79258772950371181e-01,
+      2.68067772490389322e-03 * days_per_year, 1.62824170038242295e-03 * days_per_year,
+      -9.51592254519715870e-05 * days_per_year, 5.15138902046611451e-05 * solar_mass
+    },
+  };
+
+  offset_momentum(bodies);
+  for (int i = 0; i < @N@; ++i) {
+    advance(bodies, 0.01);
+  }
+  const double value = energy(bodies);
+
+  auto end = std::chrono::steady_clock::now();
+  printf("%f\n", value);
+  printf("%lld\n", (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+  return 0;
+}
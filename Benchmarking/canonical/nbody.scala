@@ -0,0 +1,112 @@
+import java.lang.System.nanoTime
+
+final class Body(
+  var x: Double, var y: Double, var z: Double,
+  var vx: Double, var vy: Double, var vz: Double,
+  val m: Double)
+
+object Main {
+
+  val pi = 3.141592653589793
+  val solarMass = 4.0 * pi * pi
+  val daysPerYear = 365.24
+
+  def advance(bodies: Array[Body], dt: Double): Unit = {
+    var i = 0
+    while (i < bodies.length) {
+      var j = i + 1
+      while (j < bodies.length) {
+        val a = bodies(i)
+        val b = bodies(j)
+        val dx = a.x - b.x
+        val dy = a.y - b.y
+        val dz = a.z - b.z
+        val d2 = dx * dx + dy * dy + dz * dz
+        val mag = dt / (d2 * math.sqrt(d2))
+        a.vx = a.vx - dx * b.m * mag
+        a.vy = a.vy - dy * b.m * mag
+        a.vz = a.vz - dz * b.m * mag
+        b.vx = b.vx + dx * a.m * mag
+        b.vy = b.vy + dy * a.m * mag
+        b.vz = b.vz + dz * a.m * mag
+        j += 1
+      }
+      i += 1
+    }
+    for (b <- bodies) {
+      b.x = b.x + dt * b.vx
+      b.y = b.y + dt * b.vy
+      b.z = b.z + dt * b.vz
+    }
+  }
+
+  def energy(bodies: Array[Body]): Double = {
+    var e = 0.0
+    var i = 0
+    while (i < bodies.length) {
+      val a = bodies(i)
+      e = e + 0.5 * a.m * (a.vx * a.vx + a.vy * a.vy + a.vz * a.vz)
+      var j = i + 1
+      while (j < bodies.length) {
+        val b = bodies(j)
+        val dx = a.x - b.x
+        val dy = a.y - b.y
+        val dz = a.z - b.z
+        e = e - a.m * b.m / math.sqrt(dx * dx + dy * dy + dz * dz)
+        j += 1
+      }
+      i += 1
+    }
+    e
+  }
+
+  def offsetMomentum(bodies: Array[Body]): Unit = {
+    var px = 0.0
+    var py = 0.0
+    var pz = 0.0
+    for (b <- bodies) {
+      px = px + b.vx * b.m
+      py = py + b.vy * b.m
+      pz = pz + b.vz * b.m
+    }
+    bodies(0).vx = 0.0 - px / solarMass
+    bodies(0).vy = 0.0 - py / solarMass
+    bodies(0).vz = 0.0 - pz / solarMass
+  }
+
+  def main(args: Array[String]): Unit = {
+    val start = nanoTime()
+
+    val bodies = Array(
+      new Body(0.0, 0.0, 0.0, 0.0, 0.0, 0.0, solarMass),
+      new Body(
+        4.84143144246472090e+00, -1.16032004402742839e+00, -1.03622044471123109e-01,
+        1.66007664274403694e-03 * daysPerYear, 7.69901118419740425e-03 * daysPerYear,
+        -6.90460016972063023e-05 * daysPerYear, 9.54791938424326609e-04 * solarMass),
+      new Body(
+        8.34336671824457987e+00, 4.12479856412430479e+00, -4.03523417114321381e-01,
+        -2.76742510726862411e-03 * daysPerYear, 4.99852801234917238e-03 * daysPerYear,
+        2.30417297573763929e-05 * daysPerYear, 2.85885980666130812e-04 * solarMass),
+      new Body(
+        1.28943695621391310e+01, -1.51111514016986312e+01, -2.23307578892655734e-01,
+        2.96460137564761618e-03 * daysPerYear, 2.37847173959480950e-03 * daysPerYear,
+        -2.96589568540237556e-05 * daysPerYear, 4.36624404335156298e-05 * solarMass),
+      new Body(
+        1.53796971148509165e+01, -2.59193146099879641e+01, 1.79258772950371181e-01,
+        2.68067772490389322e-03 * daysPerYear, 1.62824170038242295e-03 * daysPerYear,
+        -9.51592254519715870e-05 * daysPerYear, 5.15138902046611451e-05 * solarMass))
+
+    offsetMomentum(bodies)
+    var i = 0
+    while (i < @N@) {
+      advance(bodies, 0.01)
+      i += 1
+    }
+    val value = energy(bodies)
+
+    val end = nanoTime()
+    println(value)
+    println(end - start)
+  }
+
+}
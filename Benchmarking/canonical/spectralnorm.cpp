@@ -0,0 +1,60 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+double a(int i, int j) {
+  return 1.0 / ((i + j) * (i + j + 1) / 2 + i + 1);
+}
+
+void multiply_av(const std::vector<double>& v, std::vector<double>& av) {
+  const int n = v.size();
+  for (int i = 0; i < n; ++i) {
+    double sum = 0.0;
+    for (int j = 0; j < n; ++j) {
+      sum = sum + a(i, j) * v[j];
+    }
+    av[i] = sum;
+  }
+}
+
+void multiply_atv(const std::vector<double>& v, std::vector<double>& atv) {
+  const int n = v.size();
+  for (int i = 0; i < n; ++i) {
+    double sum = 0.0;
+    for (int j = 0; j < n; ++j) {
+      sum = sum + a(j, i) * v[j];
+    }
+    atv[i] = sum;
+  }
+}
+
+void multiply_atav(
+  const std::vector<double>& v, std::vector<double>& atav, std::vector<double>& tmp)
+{
+  multiply_av(v, tmp);
+  multiply_atv(tmp, atav);
+}
+
+int main() {
+  auto start = std::chrono::steady_clock::now();
+
+  const int n = @N@;
+  std::vector<double> u(n, 1.0), v(n, 0.0), tmp(n, 0.0);
+  for (int i = 0; i < 10; ++i) {
+    multiply_atav(u, v, tmp);
+    multiply_atav(v, u, tmp);
+  }
+
+  double vbv = 0.0, vv = 0.0;
+  for (int i = 0; i < n; ++i) {
+    vbv = vbv + u[i] * v[i];
+    vv = vv + v[i] * v[i];
+  }
+  const double value = std::sqrt(vbv / vv);
+
+  auto end = std::chrono::steady_clock::now();
+  printf("%f\n", value);
+  printf("%lld\n", (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+  return 0;
+}
@@ -0,0 +1,66 @@
+import java.lang.System.nanoTime
+
+object Main {
+
+  def a(i: Int, j: Int): Double =
+    1.0 / ((i + j) * (i + j + 1) / 2 + i + 1)
+
+  def multiplyAv(v: Array[Double], av: Array[Double]): Unit = {
+    var i = 0
+    while (i < v.length) {
+      var sum = 0.0
+      var j = 0
+      while (j < v.length) {
+        sum = sum + a(i, j) * v(j)
+        j += 1
+      }
+      av(i) = sum
+      i += 1
+    }
+  }
+
+  def multiplyAtv(v: Array[Double], atv: Array[Double]): Unit = {
+    var i = 0
+    while (i < v.length) {
+      var sum = 0.0
+      var j = 0
+      while (j < v.length) {
+        sum = sum + a(j, i) * v(j)
+        j += 1
+      }
+      atv(i) = sum
+      i += 1
+    }
+  }
+
+  def multiplyAtAv(v: Array[Double], atav: Array[Double], tmp: Array[Double]): Unit = {
+    multiplyAv(v, tmp)
+    multiplyAtv(tmp, atav)
+  }
+
+  def main(args: Array[String]): Unit = {
+    val start = nanoTime()
+
+    val n = @N@
+    val u = Array.fill(n)(1.0)
+    val v = Array.fill(n)(0.0)
+    val tmp = Array.fill(n)(0.0)
+    for (_ <- 0 until 10) {
+      multiplyAtAv(u, v, tmp)
+      multiplyAtAv(v, u, tmp)
+    }
+
+    var vBv = 0.0
+    var vv = 0.0
+    for (i <- 0 until n) {
+      vBv = vBv + u(i) * v(i)
+      vv = vv + v(i) * v(i)
+    }
+    val value = math.sqrt(vBv / vv)
+
+    val end = nanoTime()
+    println(value)
+    println(end - start)
+  }
+
+}
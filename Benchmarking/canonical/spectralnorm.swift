@@ -0,0 +1,56 @@
+import Dispatch
+
+func a(_ i: Int, _ j: Int) -> Double {
+  return 1.0 / Double((i + j) * (i + j + 1) / 2 + i + 1)
+}
+
+func multiplyAv(_ v: [Double], _ av: inout [Double]) {
+  for i in 0 ..< v.count {
+    var sum = 0.0
+    for j in 0 ..< v.count {
+      sum = sum + a(i, j) * v[j]
+    }
+    av[i] = sum
+  }
+}
+
+func multiplyAtv(_ v: [Double], _ atv: inout [Double]) {
+  for i in 0 ..< v.count {
+    var sum = 0.0
+    for j in 0 ..< v.count {
+      sum = sum + a(j, i) * v[j]
+    }
+    atv[i] = sum
+  }
+}
+
+func multiplyAtAv(_ v: [Double], _ atav: inout [Double], _ tmp: inout [Double]) {
+  multiplyAv(v, &tmp)
+  multiplyAtv(tmp, &atav)
+}
+
+func benchmark() {
+  let start = DispatchTime.now().uptimeNanoseconds
+
+  let n = @N@
+  var u = [Double](repeating: 1.0, count: n)
+  var v = [Double](repeating: 0.0, count: n)
+  var tmp = [Double](repeating: 0.0, count: n)
+  for _ in 0 ..< 10 {
+    multiplyAtAv(u, &v, &tmp)
+    multiplyAtAv(v, &u, &tmp)
+  }
+
+  var vBv = 0.0
+  var vv = 0.0
+  for i in 0 ..< n {
+    vBv = vBv + u[i] * v[i]
+    vv = vv + v[i] * v[i]
+  }
+  let value = (vBv / vv).squareRoot()
+
+  let end = DispatchTime.now().uptimeNanoseconds
+  print(value)
+  print(end - start)
+}
+benchmark()
@@ -1,14 +1,24 @@
-import generator
+import argparse
 import hashlib
+import json
+import math
 import multiprocessing as mp
 import os
 import shutil as sh
 import subprocess as subp
-import sys
 
-from generator import ROOT_DIR, SRC_DIR
+from collections import defaultdict
+
+from .benchmark import OUT_DIR, bench_cpp, bench_mvs
+from .generator import gen
+from .generator.gen import ROOT_DIR, SRC_DIR
+from .generator.ir import *
 
 FAIL_DIR = os.path.join(ROOT_DIR, 'fail')
+PERF_DIR = os.path.join(ROOT_DIR, 'perf')
+
+# The number of runs of each binary while shrinking a program.
+SHRINK_RUN_COUNT = 5
 
 
 def hash(s):
@@ -20,7 +30,7 @@ def hash(s):
 def main(i: int):
   while True:
     try:
-      generator.main(f'gen{i}')
+      gen.main(f'gen{i}')
     except:
       print('- generator crash')
       continue
@@ -31,12 +41,238 @@ def main(i: int):
         stderr=subp.PIPE, stdout=subp.PIPE, check=True)
     except Exception as e:
       print(f'- recording a failure: {e}')
-      h = hash(open(f'gen{i}.mvs').read().encode('utf-8'))
-      sh.copyfile(f'gen{i}.mvs', f'{FAIL_DIR}/{h}.mvs')
+      h = hash(open(f'{SRC_DIR}/gen{i}.mvs').read().encode('utf-8'))
+      sh.copyfile(f'{SRC_DIR}/gen{i}.mvs', f'{FAIL_DIR}/{h}.mvs')
+
+
+def measure(program, prefix, runs):
+  """Returns the ratios of the execution time and memory consumption of MVS over C++ on the given
+  program, or `None` if either version fails to compile or run.
+
+  Both versions are optimized, so that the ratios don't measure the gap between debug and release
+  builds."""
+  process_kwargs = dict(stderr=subp.PIPE, stdout=subp.PIPE, check=True)
+  gen.write_program(program, prefix, OUT_DIR)
+  try:
+    (mvs_time, mvs_memo, _) = bench_mvs(
+      prefix, process_kwargs, src_dir=OUT_DIR, flags=['-O'], runtime_flags=['-O2'], runs=runs)
+    (cpp_time, cpp_memo, _) = bench_cpp(prefix, process_kwargs, src_dir=OUT_DIR, runs=runs)
+  except Exception as e:
+    print(f'- benchmark failed: {e}')
+    return None
+  return (mvs_time / max(cpp_time, 1), mvs_memo / max(cpp_memo, 1))
+
+
+def is_outlier(ratios, args):
+  return (ratios is not None) and (
+    (ratios[0] >= args.time_ratio) or (ratios[1] >= args.memory_ratio))
+
+
+def repair(func):
+  """Rewrites the uses of undefined names in the given function to the last name of the same type
+  defined before them, and drops the mutations of undefined variables.
+
+  Returns `None` if a use cannot be rewritten."""
+  scope = defaultdict(list)
+  variables = defaultdict(list)
+  for param in func.params:
+    scope[param.ty].append(param)
+
+  def use(name):
+    if (name in scope[name.ty]) or not scope[name.ty]:
+      return name
+    return scope[name.ty][-1]
+
+  def mutate(name):
+    if (name in variables[name.ty]) or not variables[name.ty]:
+      return name
+    return variables[name.ty][-1]
+
+  insts = []
+  for inst in func.insts:
+    if isinstance(inst, BinaryInst):
+      inst = inst._replace(l=use(inst.l), r=use(inst.r))
+    elif isinstance(inst, ReturnInst):
+      inst = inst._replace(name=use(inst.name))
+    elif isinstance(inst, CallInst):
+      inst = inst._replace(args=[use(n) for n in inst.args])
+    elif isinstance(inst, VarInst):
+      inst = inst._replace(r=use(inst.r))
+    elif isinstance(inst, AssignInst):
+      inst = inst._replace(l=mutate(inst.l), r=use(inst.r))
+      if (inst.l not in variables[inst.l.ty]) or (inst.l == inst.r):
+        continue
+    elif isinstance(inst, NewArrayInst):
+      inst = inst._replace(elements=[use(n) for n in inst.elements])
+    elif isinstance(inst, ArrayGetInst):
+      inst = inst._replace(arr=use(inst.arr))
+    elif isinstance(inst, ArraySetInst):
+      inst = inst._replace(arr=mutate(inst.arr), r=use(inst.r))
+      if inst.arr not in variables[inst.arr.ty]:
+        continue
+    elif isinstance(inst, NewStructInst):
+      inst = inst._replace(values=[use(n) for n in inst.values])
+    elif isinstance(inst, StructGetInst):
+      inst = inst._replace(struct=use(inst.struct))
+    elif isinstance(inst, StructSetInst):
+      inst = inst._replace(struct=mutate(inst.struct), r=use(inst.r))
+      if inst.struct not in variables[inst.struct.ty]:
+        continue
+
+    # Fail if a name could not be rewritten.
+    if any(n not in scope[n.ty] for n in operands(inst)):
+      return None
+
+    insts.append(inst)
+    if isinstance(inst, VarInst):
+      variables[inst.name.ty].append(inst.name)
+    if hasattr(inst, 'name') and not isinstance(inst, ReturnInst):
+      scope[inst.name.ty].append(inst.name)
+
+  return Func(func.name, func.params, insts)
+
+
+def restrict(program, kept):
+  """Returns the given program with only the instructions in `kept`, identified by the position
+  of their function and their position in that function, and its return instructions, or `None`
+  if the result is ill-formed.
+
+  The uses of removed instructions are rewritten and functions that are no longer called are
+  removed."""
+  funcs = []
+  for (fi, func) in enumerate(program.funcs):
+    insts = [inst for (ii, inst) in enumerate(func.insts)
+             if isinstance(inst, ReturnInst) or ((fi, ii) in kept)]
+    func = repair(Func(func.name, func.params, insts))
+    if func is None:
+      return None
+    funcs.append(func)
+
+  # Keep the entry point and the functions it calls transitively.
+  func_map = {func.name.str: func for func in funcs}
+  called = set()
+  work = [funcs[0].name.str]
+  while work:
+    name = work.pop()
+    if name not in called:
+      called.add(name)
+      work.extend(inst.func_name.str for inst in func_map[name].insts
+                  if isinstance(inst, CallInst))
+
+  funcs = [func for func in funcs if func.name.str in called]
+  return Program(structs=program.structs, funcs=funcs, meta=program.meta)
+
+
+def ddmin(items, is_interesting):
+  """Returns a 1-minimal subset of `items` that is still interesting, using the complement-only
+  variant of Zeller's delta debugging algorithm."""
+  n = 2
+  while len(items) >= 2:
+    size = math.ceil(len(items) / n)
+    reduced = False
+    for start in range(0, len(items), size):
+      complement = items[:start] + items[start + size:]
+      if is_interesting(complement):
+        items = complement
+        n = max(n - 1, 2)
+        reduced = True
+        break
+
+    if not reduced:
+      if n >= len(items):
+        break
+      n = min(n * 2, len(items))
+
+  return items
+
+
+def shrink(program, prefix, args):
+  """Removes instructions from the given program as long as it remains an outlier, and returns
+  the reduced program along with its time and memory ratios."""
+  items = [(fi, ii) for (fi, func) in enumerate(program.funcs)
+           for (ii, inst) in enumerate(func.insts) if not isinstance(inst, ReturnInst)]
+  cache = {}
+  best = (program, None)
+
+  def is_interesting(kept):
+    nonlocal best
+    key = frozenset(kept)
+    if key not in cache:
+      candidate = restrict(program, key)
+      if candidate is None:
+        cache[key] = False
+      else:
+        ratios = measure(candidate, prefix, SHRINK_RUN_COUNT)
+        cache[key] = is_outlier(ratios, args)
+        if cache[key]:
+          best = (candidate, ratios)
+          print(f'- reduced to {len(kept)} instructions, ratios {ratios}')
+    return cache[key]
+
+  ddmin(items, is_interesting)
+  return best
+
+
+def record(program, ratios, reduced, reduced_ratios):
+  """Writes the sources of an outlier and of its reduced version to `PERF_DIR`."""
+  dst = os.path.join(PERF_DIR, hash(repr(program.funcs).encode('utf-8'))[:16])
+  gen.write_program(program, 'original', dst)
+  gen.write_program(reduced, 'reduced', dst)
+  with open(f'{dst}/report.json', 'w') as f:
+    f.write(json.dumps({
+      'time_ratio': ratios[0],
+      'memory_ratio': ratios[1],
+      'reduced_time_ratio': reduced_ratios and reduced_ratios[0],
+      'reduced_memory_ratio': reduced_ratios and reduced_ratios[1],
+      'original_insts': sum(len(func.insts) for func in program.funcs),
+      'reduced_insts': sum(len(func.insts) for func in reduced.funcs),
+    }, indent=2))
+  print(f'- recorded {dst}')
+
+
+def main_perf(i: int, args):
+  prefix = f'perf{i}'
+  while True:
+    try:
+      program = None
+      while program is None:
+        program = gen.validate_program(gen.gen_program())
+    except:
+      print('- generator crash')
+      continue
+
+    ratios = measure(program, prefix, args.runs)
+    if not is_outlier(ratios, args):
+      continue
+
+    print(f'- found an outlier with ratios {ratios}')
+    (reduced, reduced_ratios) = shrink(program, prefix, args)
+    record(program, ratios, reduced, reduced_ratios)
 
 
 if __name__ == '__main__':
-  n = int(sys.argv[1]) if len(sys.argv) > 1 else 1
-  for i in range(n):
-    p = mp.Process(target=main, args=(i,))
+  parser = argparse.ArgumentParser(
+    description='Searches generated programs for compiler crashes or, with --perf, for programs '
+                'on which MVS is much slower or uses much more memory than C++.')
+  parser.add_argument('jobs', type=int, nargs='?', default=1,
+                      help='the number of programs searched in parallel')
+  parser.add_argument('--perf', action='store_true',
+                      help='search for performance outliers and shrink them to minimal '
+                           'reproducers')
+  parser.add_argument('--time-ratio', type=float, default=2.0,
+                      help='the MVS/C++ execution time ratio above which a program is an outlier')
+  parser.add_argument('--memory-ratio', type=float, default=2.0,
+                      help='the MVS/C++ memory consumption ratio above which a program is an '
+                           'outlier')
+  parser.add_argument('--runs', type=int, default=10,
+                      help='the number of runs of each binary when searching for outliers')
+  args = parser.parse_args()
+
+  os.makedirs(OUT_DIR, exist_ok=True)
+  os.makedirs(PERF_DIR if args.perf else FAIL_DIR, exist_ok=True)
+  for i in range(args.jobs):
+    if args.perf:
+      p = mp.Process(target=main_perf, args=(i, args))
+    else:
+      p = mp.Process(target=main, args=(i,))
     p.start()
@@ -569,24 +569,29 @@ def validate_program(program):
     return None
 
 
-def main(prefix):
-  program = None
-  while program is None:
-    program = validate_program(gen_program())
-  if not os.path.exists(SRC_DIR):
-    os.makedirs(SRC_DIR)
-  with open(f"{SRC_DIR}/{prefix}.json", "w") as f:
+def write_program(program, prefix, src_dir=SRC_DIR):
+  if not os.path.exists(src_dir):
+    os.makedirs(src_dir)
+  with open(f"{src_dir}/{prefix}.json", "w") as f:
     f.write(json.dumps(program.meta))
-  with open(f"{SRC_DIR}/{prefix}.swift", "w") as f:
+  with open(f"{src_dir}/{prefix}.swift", "w") as f:
     print_swift(f, "Gen", program, "swift")
-  with open(f"{SRC_DIR}/{prefix}.mvs", "w") as f:
+  with open(f"{src_dir}/{prefix}.mvs", "w") as f:
     print_swift(f, "Gen", program, "mvs")
-  with open(f"{SRC_DIR}/{prefix}.cpp", "w") as f:
+  with open(f"{src_dir}/{prefix}.cpp", "w") as f:
     print_cpp(f, program)
-  with open(f"{SRC_DIR}/{prefix}.scala", "w") as f:
+  with open(f"{src_dir}/{prefix}.scala", "w") as f:
     print_scala(f, program)
 
 
+def main(prefix):
+  program = None
+  while program is None:
+    program = validate_program(gen_program())
+  write_program(program, prefix)
+  return program
+
+
 if __name__ == "__main__":
   for i in itertools.count(start=1):
     prefix = f'gen{i}'
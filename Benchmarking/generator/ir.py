@@ -30,6 +30,34 @@ StructType = namedtuple("StructType", ["name", "properties"])
 StructType.__str__ = lambda self: self.name.str
 
 
+def operands(inst):
+  """Returns the names read or written by the given instruction, excluding the one it defines."""
+  if isinstance(inst, BinaryInst):
+    return [inst.l, inst.r]
+  elif isinstance(inst, ReturnInst):
+    return [inst.name]
+  elif isinstance(inst, CallInst):
+    return list(inst.args)
+  elif isinstance(inst, VarInst):
+    return [inst.r]
+  elif isinstance(inst, AssignInst):
+    return [inst.l, inst.r]
+  elif isinstance(inst, NewArrayInst):
+    return list(inst.elements)
+  elif isinstance(inst, ArrayGetInst):
+    return [inst.arr]
+  elif isinstance(inst, ArraySetInst):
+    return [inst.arr, inst.r]
+  elif isinstance(inst, NewStructInst):
+    return list(inst.values)
+  elif isinstance(inst, StructGetInst):
+    return [inst.struct]
+  elif isinstance(inst, StructSetInst):
+    return [inst.struct, inst.r]
+  else:
+    raise Exception("Unknown instruction: {}".format(inst))
+
+
 class StructValue:
   def __init__(self, name, values):
     self.name = name
@@ -0,0 +1,79 @@
+import argparse
+import mmap
+import os
+import struct
+import sys
+import time
+
+# The layout of the stats page published by the runtime (see `StatsPage` in `runtime.cc`).
+HEADER = struct.Struct('<8sQQ')
+COUNTERS = struct.Struct('<8Q')
+FIELDS = [
+  'allocs', 'frees', 'alloc_bytes', 'free_bytes',
+  'retains', 'releases', 'cow_copies', 'cow_bytes',
+]
+
+
+def read(page):
+  return dict(zip(FIELDS, COUNTERS.unpack_from(page, HEADER.size)))
+
+
+def is_alive(pid):
+  try:
+    os.kill(pid, 0)
+    return True
+  except ProcessLookupError:
+    return False
+  except PermissionError:
+    return True
+
+
+def human(n):
+  for unit in ['', 'K', 'M', 'G']:
+    if abs(n) < 1024:
+      return f'{n:.1f}{unit}'
+    n /= 1024
+  return f'{n:.1f}T'
+
+
+def main():
+  parser = argparse.ArgumentParser(
+    description='Samples the counters published by a program run with MVS_STATS_FILE set.')
+  parser.add_argument('file', help='the stats file of the program')
+  parser.add_argument('-i', '--interval', type=float, default=1.0, help='seconds between samples')
+  args = parser.parse_args()
+
+  with open(args.file, 'rb') as f:
+    page = mmap.mmap(f.fileno(), HEADER.size + COUNTERS.size, access=mmap.ACCESS_READ)
+
+  magic, version, pid = HEADER.unpack_from(page)
+  if magic != b'MVSSTATS' or version != 1:
+    sys.exit(f'{args.file} is not a stats file')
+
+  print(f'{"alloc/s":>10} {"free/s":>10} {"live":>10} '
+        f'{"retain/s":>10} {"release/s":>10} {"cow/s":>10} {"cow B/s":>10}')
+
+  prev = read(page)
+  last = time.monotonic()
+  while True:
+    time.sleep(args.interval)
+    curr = read(page)
+    now = time.monotonic()
+    dt = now - last
+
+    def rate(field):
+      return (curr[field] - prev[field]) / dt
+
+    live = curr['alloc_bytes'] - curr['free_bytes']
+    print(f'{human(rate("allocs")):>10} {human(rate("frees")):>10} {human(live):>10} '
+          f'{human(rate("retains")):>10} {human(rate("releases")):>10} '
+          f'{human(rate("cow_copies")):>10} {human(rate("cow_bytes")):>10}')
+    sys.stdout.flush()
+
+    prev, last = curr, now
+    if not is_alive(pid):
+      break
+
+
+if __name__ == '__main__':
+  main()
@@ -18,7 +18,7 @@ let package = Package(
     .target(
       name: "Driver",
       dependencies: [
-        "AST", "CodeGen", "LLVM", "Parse", "Sema",
+        "AST", "CodeGen", "LLVM", "Modules", "Parse", "Sema",
         .product(name: "ArgumentParser", package: "swift-argument-parser"),
       ]
     ),
@@ -26,11 +26,12 @@ let package = Package(
     .target(name: "AST", dependencies: ["Basic"]),
     .target(name: "Basic"),
     .target(name: "CodeGen", dependencies: ["AST", "Basic", "LLVM"]),
+    .target(name: "Modules", dependencies: ["AST", "Basic", "CodeGen", "LLVM", "Parse", "Sema"]),
     .target(name: "Parse", dependencies: ["AST", "Basic", "Diesel"]),
     .target(name: "Sema", dependencies: ["AST", "Basic"]),
 
     .testTarget(
       name: "MVSTests",
-      dependencies: ["AST", "CodeGen", "LLVM", "Parse", "Sema"],
+      dependencies: ["AST", "CodeGen", "LLVM", "Modules", "Parse", "Sema"],
       resources: [.copy("TestCases")]),
   ])
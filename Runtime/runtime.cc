@@ -1,4 +1,6 @@
 #include <atomic>
+#include <cerrno>
+#include <cinttypes>
 #include <chrono>
 #include <cmath>
 #include <cassert>
@@ -6,6 +8,26 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #ifdef DEBUG
 #define mvs_assert(c) (assert(c))
@@ -39,6 +61,49 @@ struct mvs_MetaType {
   /// The type-erased equality function for instances of the type.
   const int64_t (*equal)(const void*, const void*);
 
+  /// The kind of the type's representation, which describes how to serialize its instances.
+  const int64_t kind;
+
+  /// A description of the type's representation, whose meaning depends on `kind`.
+  ///
+  /// It is a pointer to the metatype of the elements of an array, or to a table of `mvs_Field`
+  /// terminated by a null type for a structure. It is null for all other kinds.
+  const void* layout;
+
+};
+
+/// The kinds of type representations.
+enum mvs_TypeKind : int64_t {
+
+  /// A type whose instances can be copied bitwise, like `Int`, `Float` or trivial structures.
+  mvs_kind_trivial = 0,
+
+  /// An array.
+  mvs_kind_array = 1,
+
+  /// A string.
+  mvs_kind_string = 2,
+
+  /// An existential container.
+  mvs_kind_existential = 3,
+
+  /// A closure.
+  mvs_kind_closure = 4,
+
+  /// A non-trivial structure.
+  mvs_kind_struct = 5,
+
+};
+
+/// The description of a stored property in the layout of a structure.
+struct mvs_Field {
+
+  /// The offset of the property, in bytes.
+  int64_t offset;
+
+  /// The metatype of the property.
+  const mvs_MetaType* type;
+
 };
 
 /// A type-erased array.
@@ -58,6 +123,38 @@ struct mvs_AnyArray {
 
 };
 
+/// A string of bytes.
+///
+/// Strings of at most 15 bytes are stored inline: their bytes are stored at the beginning of the
+/// structure, padded with zeros, and the last byte holds their count, with its high bit set.
+///
+/// Longer strings are stored out-of-line, in storage that has the same layout and reference
+/// counting scheme as that of an array of bytes. The last byte of the structure is then zero, as
+/// the count of a string is smaller than 2^56 and stored in little-endian order.
+///
+/// A zero-initialized structure denotes an empty string.
+struct mvs_String {
+
+  union {
+
+    /// The bytes of a small string.
+    uint8_t bytes[16];
+
+    /// The representation of a large string.
+    struct {
+
+      /// A pointer to the string's bytes, offset by `sizeof(ArrayHeader)` from its storage.
+      uint8_t* payload;
+
+      /// The number of bytes in the string.
+      int64_t count;
+
+    } large;
+
+  };
+
+};
+
 /// An existential container.
 struct mvs_Existential {
 
@@ -71,9 +168,39 @@ struct mvs_Existential {
 
 }
 
+/// The kinds of memory holding the storage of arrays and strings.
+enum StorageKind : uint32_t {
+
+  /// Memory allocated with `mvs_malloc`.
+  storage_heap = 0,
+
+  /// A shared mapping of a scratch file, whose pages are written back to the file rather than
+  /// kept in memory when the system runs low on memory.
+  storage_file = 1,
+
+};
+
 /// The header of an array.
+///
+/// The reference counter, count and capacity are the last three words of the header, so that
+/// their offsets from the payload do not depend on the fields preceding them.
+///
+/// The header immediately precedes the payload, but not necessarily the memory allocated for the
+/// storage: removing the first element of an array moves the header forward over the element,
+/// and inserting an element at the front moves it back, so that the array's structure still
+/// points to its first element.
 struct ArrayHeader {
 
+  /// The kind of memory holding the array's storage.
+  uint16_t kind;
+
+  /// The access pattern advised for the array's storage, as an `MADV_*` value, if the storage is
+  /// mapped from a file.
+  uint16_t advice;
+
+  /// The number of bytes between the start of the array's storage and the header.
+  uint32_t head;
+
   /// The number of references to the array's storage.
   std::atomic<uint64_t> refc;
 
@@ -93,6 +220,93 @@ inline ArrayHeader* get_array_header(mvs_AnyArray* array) {
   return (ArrayHeader*)((uint8_t*)array->payload - sizeof(ArrayHeader));
 }
 
+/// The counters that the runtime publishes while a program runs.
+///
+/// Counters are monotonic, so that a reader can compute rates from the difference between two
+/// samples. They are updated with relaxed atomic operations, without any lock.
+struct StatsPage {
+
+  /// The constant "MVSSTATS", identifying the file.
+  char magic[8];
+
+  /// The version of this layout.
+  uint64_t version;
+
+  /// The identifier of the process that publishes the counters.
+  uint64_t pid;
+
+  /// The number of allocations.
+  std::atomic<uint64_t> allocs;
+
+  /// The number of deallocations.
+  std::atomic<uint64_t> frees;
+
+  /// The number of bytes allocated.
+  std::atomic<uint64_t> alloc_bytes;
+
+  /// The number of bytes deallocated.
+  std::atomic<uint64_t> free_bytes;
+
+  /// The number of reference counter increments.
+  std::atomic<uint64_t> retains;
+
+  /// The number of reference counter decrements.
+  std::atomic<uint64_t> releases;
+
+  /// The number of copies of shared array storage made to uniquify it before a mutation.
+  std::atomic<uint64_t> cow_copies;
+
+  /// The number of bytes copied to uniquify array storage.
+  std::atomic<uint64_t> cow_bytes;
+
+};
+
+/// The runtime's stats page, or `nullptr` if statistics are disabled.
+static StatsPage* stats_page = nullptr;
+
+/// Adds `n` to the counter `field` of the stats page, if statistics are enabled.
+#define mvs_count(field, n) \
+  do { \
+    if (stats_page != nullptr) { stats_page->field.fetch_add(n, std::memory_order_relaxed); } \
+  } while (0)
+
+/// Maps the stats page to the file at the path given by the environment variable
+/// `MVS_STATS_FILE`, if it is set.
+///
+/// The file is created or truncated, and remains after the program exits, so that its final
+/// counters can still be read.
+__attribute__((constructor))
+static void map_stats_page() {
+  const char* path = getenv("MVS_STATS_FILE");
+  if (path == nullptr) { return; }
+
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) { return; }
+  if (ftruncate(fd, sizeof(StatsPage)) != 0) {
+    close(fd);
+    return;
+  }
+
+  void* page = mmap(nullptr, sizeof(StatsPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (page == MAP_FAILED) { return; }
+
+  // The file is zero-filled, which is a valid initial state for the counters.
+  stats_page = (StatsPage*)page;
+  stats_page->version = 1;
+  stats_page->pid = static_cast<uint64_t>(getpid());
+  memcpy(stats_page->magic, "MVSSTATS", 8);
+}
+
+/// Returns the number of bytes actually reserved for the given allocation.
+inline uint64_t allocation_size(void* ptr) {
+#if defined(__APPLE__)
+  return malloc_size(ptr);
+#else
+  return malloc_usable_size(ptr);
+#endif
+}
+
 extern "C" {
 
 uint8_t* mvs_malloc(int64_t size) {
@@ -103,13 +317,274 @@ uint8_t* mvs_malloc(int64_t size) {
     exit(-1);
   }
 #endif
+
+  mvs_count(allocs, 1);
+  mvs_count(alloc_bytes, allocation_size(ptr));
   return ptr;
 }
 
 void mvs_free(void* ptr) {
+  if (ptr != nullptr) {
+    mvs_count(frees, 1);
+    mvs_count(free_bytes, allocation_size(ptr));
+  }
   free(ptr);
 }
 
+}
+
+/// The capacity, in bytes, from which the storage of arrays and strings is mapped from a scratch
+/// file rather than allocated on the heap, or zero if storage is mapped only on demand.
+///
+/// It is read from the environment variable `MVS_FILE_ARRAY_THRESHOLD` at startup.
+static int64_t file_array_threshold = 0;
+
+/// The directory in which scratch files are created.
+///
+/// It is read from the environment variable `MVS_SCRATCH_DIR` at startup, and defaults to
+/// `TMPDIR`, or to `/tmp` if that variable is not set either.
+static const char* scratch_dir = "/tmp";
+
+/// Returns the start of the memory allocated for the storage of the given header.
+inline uint8_t* get_storage_base(ArrayHeader* header) {
+  return (uint8_t*)header - header->head;
+}
+
+/// Returns the size of the memory mapped for the storage of the given header.
+inline int64_t get_mapping_size(const ArrayHeader* header) {
+  return header->head + sizeof(ArrayHeader) + header->capacity;
+}
+
+/// Maps a new scratch file of `size` bytes, or returns `nullptr` if it could not be created.
+///
+/// The file is unlinked as soon as it is mapped, so that its blocks are reclaimed when the mapping
+/// is removed, even if the program is killed. Its contents are initially zero.
+static uint8_t* map_scratch_file(int64_t size) {
+  char path[4096];
+  int n = snprintf(path, sizeof(path), "%s/mvs-array-XXXXXX", scratch_dir);
+  if ((n < 0) || (n >= (int)sizeof(path))) { return nullptr; }
+
+  int fd = mkstemp(path);
+  if (fd < 0) { return nullptr; }
+  unlink(path);
+
+  void* ptr = MAP_FAILED;
+  if (ftruncate(fd, size) == 0) {
+    ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  return (ptr != MAP_FAILED) ? (uint8_t*)ptr : nullptr;
+}
+
+/// Advises the kernel that the storage of the given header is about to be accessed according to
+/// the given `MADV_*` pattern, if it is mapped from a file.
+inline void advise_storage(ArrayHeader* header, int advice) {
+  if (header->kind == storage_file) {
+    madvise(get_storage_base(header), get_mapping_size(header), advice);
+  }
+}
+
+/// Allocates storage for an array or string whose payload has at least `capacity` bytes, and
+/// returns its header, configured with a reference count of 1 and `count` elements.
+///
+/// The storage is mapped from a scratch file if `file_backed` is set or if `capacity` is at least
+/// `file_array_threshold`, in which case its capacity is rounded up to fill the mapped pages and
+/// its payload is zero-filled. Otherwise, or if no scratch file could be created, the storage is
+/// allocated with `mvs_malloc` and its payload is uninitialized.
+ArrayHeader* allocate_storage(int64_t count, int64_t capacity, bool file_backed = false) {
+  bool is_large = (file_array_threshold > 0) && (capacity >= file_array_threshold);
+  if (file_backed || is_large) {
+    int64_t page = sysconf(_SC_PAGESIZE);
+    int64_t size = (sizeof(ArrayHeader) + capacity + page - 1) / page * page;
+    if (auto* storage = map_scratch_file(size)) {
+#ifdef DEBUG
+      fprintf(stderr, "  map   %lli bytes at %p\n", size, storage);
+#endif
+
+      auto* header = (ArrayHeader*)storage;
+      header->kind     = storage_file;
+      header->advice   = MADV_NORMAL;
+      header->head     = 0;
+      header->refc     = 1;
+      header->count    = count;
+      header->capacity = size - sizeof(ArrayHeader);
+      return header;
+    }
+
+#ifdef DEBUG
+    fprintf(stderr, "  failed to map a scratch file in '%s' (error %i)\n", scratch_dir, errno);
+#endif
+  }
+
+  auto* storage = mvs_malloc(sizeof(ArrayHeader) + capacity);
+#ifdef DEBUG
+  fprintf(stderr, "  alloc %lu+%lli bytes at %p\n", sizeof(ArrayHeader), capacity, storage);
+#endif
+
+  auto* header = (ArrayHeader*)storage;
+  header->kind     = storage_heap;
+  header->advice   = MADV_NORMAL;
+  header->head     = 0;
+  header->refc     = 1;
+  header->count    = count;
+  header->capacity = capacity;
+  return header;
+}
+
+/// Deallocates the storage of an array or string, whose elements must have been dropped.
+inline void deallocate_storage(ArrayHeader* header) {
+#ifdef DEBUG
+  fprintf(stderr, "  dealloc %p\n", header);
+#endif
+
+  if (header->kind == storage_file) {
+    munmap(get_storage_base(header), get_mapping_size(header));
+  } else {
+    mvs_free(get_storage_base(header));
+  }
+}
+
+/// Returns the payload of the storage with the given header.
+inline uint8_t* get_payload(ArrayHeader* header) {
+  return (uint8_t*)header + sizeof(ArrayHeader);
+}
+
+inline bool is_small_string(const mvs_String* string);
+
+/// Returns the header of the reference-counted storage of the given array or string, or
+/// `nullptr` if the value has no such storage or is of another kind.
+inline ArrayHeader* get_shared_storage(const void* elem, const mvs_MetaType* elem_type) {
+  if (elem_type->kind == mvs_kind_array) {
+    return get_array_header((mvs_AnyArray*)elem);
+  }
+  if (elem_type->kind == mvs_kind_string) {
+    auto* string = (const mvs_String*)elem;
+    if (is_small_string(string) || (string->large.payload == nullptr)) { return nullptr; }
+    return (ArrayHeader*)(string->large.payload - sizeof(ArrayHeader));
+  }
+  return nullptr;
+}
+
+/// The metatype of the bytes of a string.
+static const mvs_MetaType byte_metatype = {
+  1, nullptr, nullptr, nullptr, nullptr, mvs_kind_trivial, nullptr
+};
+
+/// Returns the metatype of the elements of the storage of an array or string.
+inline const mvs_MetaType* get_storage_elem_type(const mvs_MetaType* type) {
+  return (type->kind == mvs_kind_array) ? (const mvs_MetaType*)type->layout : &byte_metatype;
+}
+
+/// Returns whether the elements of the given type are arrays or strings whose storage can be
+/// retained and released without calling their metatype's functions.
+inline bool has_shared_storage(const mvs_MetaType* elem_type) {
+  return (elem_type->kind == mvs_kind_string) ||
+         ((elem_type->kind == mvs_kind_array) && (elem_type->layout != nullptr));
+}
+
+/// Returns the number of elements from the `i`-th one that share the storage with the given
+/// header, assuming the `i`-th one does.
+inline int64_t get_run_length(const uint8_t* payload, int64_t i, int64_t count,
+                              const mvs_MetaType* elem_type, const ArrayHeader* header) {
+  int64_t stride = elem_type->size;
+  int64_t j = i + 1;
+  while ((j < count) && (get_shared_storage(&payload[j * stride], elem_type) == header)) { ++j; }
+  return j - i;
+}
+
+void release_elements(uint8_t* payload, int64_t count, const mvs_MetaType* elem_type);
+
+/// Decrements the reference counter of the given storage by `n`, dropping its elements and
+/// deallocating it if the counter reaches zero.
+///
+/// - Returns: `true` if the storage was deallocated.
+bool release_storage(ArrayHeader* header, const mvs_MetaType* elem_type, int64_t n) {
+  auto value = header->refc.fetch_sub(n, std::memory_order_acq_rel);
+  mvs_count(releases, 1);
+
+  // If the reference counter didn't reach zero, we're done.
+  if (value != static_cast<uint64_t>(n)) {
+#ifdef DEBUG
+    fprintf(stderr, "  release %p (%lli)\n", header, value - n);
+#endif
+    return false;
+  }
+
+#ifdef DEBUG
+  fprintf(stderr, "  drop    %p\n", header);
+#endif
+
+  // If the reference counter reached zero, we must deallocate the storage.
+  release_elements(get_payload(header), header->count, elem_type);
+  deallocate_storage(header);
+  return true;
+}
+
+/// Drops `count` contiguous elements.
+///
+/// Consecutive arrays or strings that share the same storage are released together, with a
+/// single atomic operation.
+void release_elements(uint8_t* payload, int64_t count, const mvs_MetaType* elem_type) {
+  if (elem_type->drop == nullptr) { return; }
+  int64_t stride = elem_type->size;
+
+  if (!has_shared_storage(elem_type)) {
+    for (int64_t i = 0; i < count; ++i) {
+      elem_type->drop(&payload[i * stride]);
+    }
+    return;
+  }
+
+  const auto* storage_elem_type = get_storage_elem_type(elem_type);
+  for (int64_t i = 0; i < count;) {
+    auto* header = get_shared_storage(&payload[i * stride], elem_type);
+    if (header == nullptr) {
+      ++i;
+      continue;
+    }
+
+    int64_t n = get_run_length(payload, i, count, elem_type, header);
+    release_storage(header, storage_elem_type, n);
+    i += n;
+  }
+}
+
+/// Copies `count` contiguous elements to uninitialized memory.
+///
+/// Arrays and strings are copied bitwise, and consecutive ones that share the same storage are
+/// retained together, with a single atomic operation.
+void copy_elements(uint8_t* dst, const uint8_t* src, int64_t count,
+                   const mvs_MetaType* elem_type) {
+  int64_t stride = elem_type->size;
+  if (elem_type->copy == nullptr) {
+    memcpy(dst, src, count * stride);
+    return;
+  }
+
+  if (!has_shared_storage(elem_type)) {
+    for (int64_t i = 0; i < count; ++i) {
+      elem_type->copy(&dst[i * stride], const_cast<uint8_t*>(&src[i * stride]));
+    }
+    return;
+  }
+
+  memcpy(dst, src, count * stride);
+  for (int64_t i = 0; i < count;) {
+    auto* header = get_shared_storage(&src[i * stride], elem_type);
+    if (header == nullptr) {
+      ++i;
+      continue;
+    }
+
+    int64_t n = get_run_length(src, i, count, elem_type, header);
+    header->refc.fetch_add(n, std::memory_order_relaxed);
+    mvs_count(retains, 1);
+    i += n;
+  }
+}
+
+extern "C" {
+
 /// Initializes an array structure.
 ///
 /// - Parameters:
@@ -128,26 +603,17 @@ void mvs_array_init(mvs_AnyArray* array,
   if (count > 0) {
     // Allocate new storage.
     int64_t capacity = count * stride;
-    auto* storage = mvs_malloc(sizeof(ArrayHeader) + capacity);
-    array->payload = storage + sizeof(ArrayHeader);
-
-#ifdef DEBUG
-    fprintf(stderr, "  alloc %lu+%lli bytes at %p\n", sizeof(ArrayHeader), capacity, storage);
-#endif
-
-    // Configure the storage's header.
-    auto* header = (ArrayHeader*)storage;
-    header->refc     = 1;
-    header->count    = count;
-    header->capacity = capacity;
+    auto* header = allocate_storage(count, capacity);
+    array->payload = get_payload(header);
 
-    // Initialize the storage's payload.
+    // Initialize the storage's payload. Mapped storage is already zero-filled, and writing it
+    // would only dirty pages that must then be written back.
     uint8_t* payload = (uint8_t*)array->payload;
     if (elem_type->init != nullptr) {
       for (size_t i = 0; i < count; ++i) {
         elem_type->init(&payload[i * stride]);
       }
-    } else {
+    } else if (header->kind == storage_heap) {
       memset(payload, 0, capacity);
     }
   } else {
@@ -172,35 +638,59 @@ void mvs_array_drop(mvs_AnyArray* array, const mvs_MetaType* elem_type) {
   if (header == nullptr) { return; }
   mvs_assert(header->count > 0);
 
-  // Decrement the reference counter.
-  auto value = header->refc.fetch_sub(1, std::memory_order_acq_rel);
+  if (release_storage(header, elem_type, 1)) {
+    array->payload = nullptr;
+  }
+}
 
-  // If the reference counter didn't reach zero, we're done.
-  if (value != 1) {
+/// Reinitializes an array structure with new storage, reusing its current storage if possible.
+///
+/// The current storage is reused if it is uniquely referenced and large enough to hold `count`
+/// elements, in which case its elements are dropped and reinitialized in place. Otherwise, the
+/// array is dropped and initialized with new storage, as if by `mvs_array_drop` followed by
+/// `mvs_array_init`.
+///
+/// - Parameters:
+///   - array: A pointer an initialized array structure.
+///   - elem_type: A pointer to the metatype of the type of the array's elements.
+///   - count: The number of elements in the array.
+///   - stride: The stride of each element, in bytes.
+void mvs_array_reinit(mvs_AnyArray* array,
+                      const mvs_MetaType* elem_type,
+                      int64_t count,
+                      int64_t stride) {
 #ifdef DEBUG
-    fprintf(stderr, "  release %p (%lli)\n", header, value - 1);
+  fprintf(stderr, "mvs_array_reinit(%p, %p, %lli, %lli)\n", array, elem_type, count, stride);
 #endif
+
+  auto* header = get_array_header(array);
+  if ((header == nullptr) ||
+      (count == 0) ||
+      (header->capacity < count * stride) ||
+      (header->refc.load(std::memory_order_acquire) != 1))
+  {
+    mvs_array_drop(array, elem_type);
+    mvs_array_init(array, elem_type, count, stride);
     return;
   }
 
 #ifdef DEBUG
-  fprintf(stderr, "  drop    %p\n", header);
+  fprintf(stderr, "  reuse   %p\n", header);
 #endif
 
-  // If the reference counter reached zero, we must deallocate the storage.
-  if (elem_type->drop != nullptr) {
-    uint8_t* payload = (uint8_t*)array->payload;
-    for (size_t i = 0; i < header->count; ++i) {
-      elem_type->drop(&payload[i * elem_type->size]);
+  // Drop the current elements.
+  uint8_t* payload = (uint8_t*)array->payload;
+  release_elements(payload, header->count, elem_type);
+
+  // Initialize the new elements.
+  header->count = count;
+  if (elem_type->init != nullptr) {
+    for (int64_t i = 0; i < count; ++i) {
+      elem_type->init(&payload[i * stride]);
     }
+  } else {
+    memset(payload, 0, count * stride);
   }
-
-#ifdef DEBUG
-  fprintf(stderr, "  dealloc %p\n", header);
-#endif
-
-  mvs_free(header);
-  array->payload = nullptr;
 }
 
 /// Copies an array.
@@ -222,11 +712,57 @@ void mvs_array_copy(mvs_AnyArray* dst, mvs_AnyArray* src) {
   mvs_assert(header->count > 0);
 
   auto value = header->refc.fetch_add(1, std::memory_order_relaxed);
+  mvs_count(retains, 1);
 #ifdef DEBUG
   fprintf(stderr, "  retain  %p (%lli)\n", header, value + 1);
 #endif
 }
 
+/// Increments the reference counter of an array's storage by `n`, with a single atomic operation.
+///
+/// This is equivalent to `n` bitwise copies of the array followed by `n` calls to
+/// `mvs_array_copy`, and is used when the copies are known to denote the same storage.
+///
+/// - Parameters:
+///   - array: A pointer to the array whose storage should be retained.
+///   - n: The number of copies of the array that have been made bitwise.
+void mvs_array_retain_n(const mvs_AnyArray* array, int64_t n) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_array_retain_n(%p, %lli)\n", array, n);
+#endif
+
+  auto* header = get_array_header(const_cast<mvs_AnyArray*>(array));
+  if ((header == nullptr) || (n <= 0)) { return; }
+
+  auto value = header->refc.fetch_add(n, std::memory_order_relaxed);
+  (void)value;
+  mvs_count(retains, 1);
+#ifdef DEBUG
+  fprintf(stderr, "  retain  %p (%lli)\n", header, value + n);
+#endif
+}
+
+/// Decrements the reference counter of an array's storage by `n`, with a single atomic operation,
+/// deallocating the storage if the counter reaches zero.
+///
+/// This is equivalent to dropping `n` copies of the array that denote the same storage.
+///
+/// - Parameters:
+///   - array: A pointer to one of the copies.
+///   - elem_type: A pointer to the metatype of the type of the array's elements.
+///   - n: The number of copies to drop.
+void mvs_array_release_n(mvs_AnyArray* array, const mvs_MetaType* elem_type, int64_t n) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_array_release_n(%p, %p, %lli)\n", array, elem_type, n);
+#endif
+
+  auto* header = get_array_header(array);
+  if ((header == nullptr) || (n <= 0)) { return; }
+  if (release_storage(header, elem_type, n)) {
+    array->payload = nullptr;
+  }
+}
+
 /// Guarantees that the given array structure has a unique storage.
 ///
 /// - Parameters:
@@ -242,34 +778,27 @@ void mvs_array_uniq(mvs_AnyArray* array, const mvs_MetaType* elem_type) {
   if ((header == nullptr) || (header->refc.load(std::memory_order_acquire) == 1)) { return; }
   mvs_assert(header->count > 0);
 
-  // Allocate a new storage.
-  auto unique_storage = mvs_malloc(sizeof(ArrayHeader) + header->capacity);
-#ifdef DEBUG
-  fprintf(stderr, "  alloc %lu+%lli bytes at %p\n", sizeof(ArrayHeader), header->capacity, unique_storage);
-#endif
-
-  auto* new_header  = (ArrayHeader*)unique_storage;
-  auto* new_payload = (uint8_t*)unique_storage + sizeof(ArrayHeader);
-
-  // Initialize the new header.
-  new_header->refc     = 1;
-  new_header->count    = header->count;
-  new_header->capacity = header->capacity;
+  // Allocate a new storage, mapped from a new scratch file if the current one is. Both are
+  // traversed once, in order.
+  auto* new_header = allocate_storage(
+    header->count, header->capacity, header->kind == storage_file);
+  auto* new_payload = get_payload(new_header);
+  new_header->advice = header->advice;
+  advise_storage(header, MADV_SEQUENTIAL);
+  advise_storage(new_header, MADV_SEQUENTIAL);
 
   // Copy the contents of the current storage.
-  if (elem_type->copy == nullptr) {
-    memcpy(new_payload, array->payload, header->capacity);
-  } else {
-    uint8_t* src = (uint8_t*)array->payload;
-    uint8_t* dst = (uint8_t*)unique_storage + sizeof(ArrayHeader);
-    for (size_t i = 0; i < header->count; ++i) {
-      elem_type->copy(&dst[i * elem_type->size], &src[i * elem_type->size]);
-    }
-  }
+  copy_elements(new_payload, (uint8_t*)array->payload, header->count, elem_type);
+
+  advise_storage(header, header->advice);
+  advise_storage(new_header, new_header->advice);
 
   // Substitute the old array's storage and decrement the reference counter on the old storage.
-  array->payload = (uint8_t*)unique_storage + sizeof(ArrayHeader);
+  array->payload = new_payload;
   header->refc.fetch_sub(1, std::memory_order_acq_rel);
+  mvs_count(releases, 1);
+  mvs_count(cow_copies, 1);
+  mvs_count(cow_bytes, header->count * elem_type->size);
 }
 
 /// Returns whether the two given arrays are equal, assuming they are of the same type.
@@ -304,112 +833,2159 @@ int64_t mvs_array_equal(const mvs_AnyArray* lhs,
   return 1;
 }
 
-/// Destroys an existential container, including out-of-line storage, if any.
-///
-/// - Parameter container: A pointer to the container that should be destroyed.
-void mvs_exist_drop(mvs_Existential* container) {
-#ifdef DEBUG
-  fprintf(stderr, "mvs_exist_drop(%p)\n", container);
-#endif
-  if (container->witness->size <= sizeof(int64_t) * 3) {
-    // Storage is inline.
-    if (container->witness->drop != nullptr) {
-      container->witness->drop(reinterpret_cast<uint8_t*>(container->storage));
-    }
+}
+
+/// A type-erased comparison function `less(lhs, rhs, context)`, returning whether `lhs` is ordered
+/// before `rhs`.
+typedef int64_t (*mvs_LessFunc)(const void*, const void*, void*);
+
+/// Copies an element to uninitialized memory.
+inline void copy_element(uint8_t* dst, const void* src, const mvs_MetaType* elem_type) {
+  if (elem_type->copy == nullptr) {
+    memcpy(dst, src, elem_type->size);
   } else {
-    // Storage is out-of-line.
-    auto storage = reinterpret_cast<uint8_t**>(container->storage)[0];
-    if (container->witness->drop != nullptr) {
-      container->witness->drop(storage);
-    }
-    mvs_free(storage);
-#ifdef DEBUG
-    fprintf(stderr, "  dealloc %p\n", storage);
-#endif
+    elem_type->copy(dst, const_cast<void*>(src));
   }
-
-  memset(container, 0, sizeof(mvs_Existential));
 }
 
-/// Copies an existential container.
+/// Zero-initializes an element.
+inline void init_element(void* dst, const mvs_MetaType* elem_type) {
+  if (elem_type->init == nullptr) {
+    memset(dst, 0, elem_type->size);
+  } else {
+    elem_type->init(dst);
+  }
+}
+
+/// Swaps the `size` bytes at the given addresses.
+inline void swap_bytes(uint8_t* a, uint8_t* b, int64_t size) {
+  for (int64_t i = 0; i < size; ++i) {
+    uint8_t t = a[i];
+    a[i] = b[i];
+    b[i] = t;
+  }
+}
+
+/// Drops an element.
+inline void drop_element(void* elem, const mvs_MetaType* elem_type) {
+  if (elem_type->drop != nullptr) { elem_type->drop(elem); }
+}
+
+/// Clamps the range `[*start, *end)` to the positions of a sequence of `count` elements, and
+/// returns the number of elements in the clamped range.
+inline int64_t clamp_range(int64_t* start, int64_t* end, int64_t count) {
+  *start = (*start < 0) ? 0 : ((*start > count) ? count : *start);
+  *end = (*end < *start) ? *start : ((*end > count) ? count : *end);
+  return *end - *start;
+}
+
+/// Returns whether all the bytes of the given element are equal to its first one.
+inline bool is_byte_pattern(const uint8_t* elem, int64_t size) {
+  for (int64_t i = 1; i < size; ++i) {
+    if (elem[i] != elem[0]) { return false; }
+  }
+  return true;
+}
+
+/// Writes `count` bitwise copies of the element at `elem` to `dst`.
+///
+/// Elements whose bytes are all equal are written with `memset`. Elements of 8 or 16 bytes are
+/// broadcast to 16-byte SIMD registers and stored a register at a time, when SIMD instructions are
+/// available. Other elements are written by copying the filled prefix with doubling `memcpy`s.
+inline void broadcast(uint8_t* dst, const void* elem, int64_t stride, int64_t count) {
+  if (is_byte_pattern((const uint8_t*)elem, stride)) {
+    memset(dst, *(const uint8_t*)elem, count * stride);
+    return;
+  }
+
+#if defined(__SSE2__)
+  if ((stride == 8) || (stride == 16)) {
+    __m128i value;
+    if (stride == 8) {
+      int64_t word;
+      memcpy(&word, elem, sizeof(word));
+      value = _mm_set1_epi64x(word);
+    } else {
+      value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(elem));
+    }
+
+    int64_t size = count * stride;
+    int64_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), value);
+    }
+    if (i < size) { memcpy(dst + i, elem, stride); }
+    return;
+  }
+#endif
+
+  memcpy(dst, elem, stride);
+  for (int64_t filled = 1; filled < count; filled *= 2) {
+    int64_t m = (filled < count - filled) ? filled : count - filled;
+    memcpy(&dst[filled * stride], dst, m * stride);
+  }
+}
+
+/// The factor by which the capacity of an array's storage grows when it is full, in percent.
+///
+/// It is read from the environment variable `MVS_ARRAY_GROWTH` at startup, and must be at least
+/// 125 so that insertions run in amortized constant time.
+static int64_t array_growth_percent = 200;
+
+/// The capacity, in elements, of the storage allocated when inserting into an empty array.
+///
+/// It is read from the environment variable `MVS_ARRAY_MIN_CAPACITY` at startup.
+static int64_t array_min_capacity = 4;
+
+/// The number of worker processes of the executor used by `mvs_scatter`.
+///
+/// It is read from the environment variable `MVS_WORKERS` at startup, and defaults to the number
+/// of online processors. If it is zero, functions are applied in the calling process.
+static int64_t executor_workers = -1;
+
+/// The number of elements sent to a worker in a single message, or zero to split each call into
+/// about four batches per worker.
+///
+/// It is read from the environment variable `MVS_EXECUTOR_BATCH` at startup.
+static int64_t executor_batch = 0;
+
+/// The maximum number of batches sent to a worker and not answered yet.
+///
+/// It is read from the environment variable `MVS_EXECUTOR_INFLIGHT` at startup.
+static int64_t executor_inflight = 2;
+
+/// Reads the runtime's tunable parameters from the environment, ignoring invalid values.
+__attribute__((constructor))
+static void read_tunables() {
+  if (const char* value = getenv("MVS_ARRAY_GROWTH")) {
+    int64_t n = strtoll(value, nullptr, 10);
+    if (n >= 125) { array_growth_percent = n; }
+  }
+  if (const char* value = getenv("MVS_ARRAY_MIN_CAPACITY")) {
+    int64_t n = strtoll(value, nullptr, 10);
+    if (n >= 1) { array_min_capacity = n; }
+  }
+  if (const char* value = getenv("MVS_WORKERS")) {
+    int64_t n = strtoll(value, nullptr, 10);
+    if (n >= 0) { executor_workers = n; }
+  }
+  if (const char* value = getenv("MVS_EXECUTOR_BATCH")) {
+    int64_t n = strtoll(value, nullptr, 10);
+    if (n >= 1) { executor_batch = n; }
+  }
+  if (const char* value = getenv("MVS_EXECUTOR_INFLIGHT")) {
+    int64_t n = strtoll(value, nullptr, 10);
+    if (n >= 1) { executor_inflight = n; }
+  }
+  if (const char* value = getenv("MVS_FILE_ARRAY_THRESHOLD")) {
+    int64_t n = strtoll(value, nullptr, 10);
+    if (n >= 0) { file_array_threshold = n; }
+  }
+  if (const char* value = getenv("MVS_SCRATCH_DIR")) {
+    if (*value != 0) { scratch_dir = value; }
+  } else if (const char* value = getenv("TMPDIR")) {
+    if (*value != 0) { scratch_dir = value; }
+  }
+}
+
+/// Guarantees that the given array has a unique storage, large enough to hold `count` elements.
+///
+/// New storage is allocated if the current one is shared or too small. Its capacity grows
+/// geometrically, by `array_growth_percent`, so that a sequence of insertions runs in amortized
+/// constant time per element.
+///
+/// - Returns: The header of the array's storage.
+ArrayHeader* reserve_unique(mvs_AnyArray* array, const mvs_MetaType* elem_type, int64_t count) {
+  int64_t stride = elem_type->size;
+  auto* header = get_array_header(array);
+  bool is_unique = (header != nullptr) && (header->refc.load(std::memory_order_acquire) == 1);
+  if (is_unique && (header->capacity >= count * stride)) { return header; }
+
+  // Allocate new storage.
+  int64_t old_count = (header != nullptr) ? header->count : 0;
+  int64_t capacity = (header != nullptr)
+    ? header->capacity * array_growth_percent / 100
+    : array_min_capacity * stride;
+  if (capacity < count * stride) { capacity = count * stride; }
+
+  // Mapped storage remains mapped when it grows or is copied.
+  bool file_backed = (header != nullptr) && (header->kind == storage_file);
+  auto* new_header = allocate_storage(old_count, capacity, file_backed);
+  uint8_t* new_payload = get_payload(new_header);
+  if (file_backed) { new_header->advice = header->advice; }
+
+  if (is_unique) {
+    // Move the elements out of the current storage, which can then be deallocated.
+    memcpy(new_payload, array->payload, old_count * stride);
+    deallocate_storage(header);
+  } else if (header != nullptr) {
+    // Copy the elements of the current storage, and release it.
+    copy_elements(new_payload, (uint8_t*)array->payload, old_count, elem_type);
+    mvs_array_drop(array, elem_type);
+    mvs_count(cow_copies, 1);
+    mvs_count(cow_bytes, old_count * stride);
+  }
+
+  array->payload = new_payload;
+  return new_header;
+}
+
+/// Moves the last element of a non-empty array with a unique storage to uninitialized memory.
+///
+/// The storage is deallocated if the array becomes empty, as allocated storage always contains at
+/// least one element.
+void move_last(mvs_AnyArray* array, const mvs_MetaType* elem_type, void* dst) {
+  auto* header = get_array_header(array);
+  int64_t last = header->count - 1;
+  memcpy(dst, (uint8_t*)array->payload + last * elem_type->size, elem_type->size);
+
+  if (last == 0) {
+    deallocate_storage(header);
+    array->payload = nullptr;
+  } else {
+    header->count = last;
+  }
+}
+
+/// Moves the header of an array with a unique storage by `delta` bytes, which must be a multiple
+/// of the array's stride, and makes the array's structure point to the payload that follows it.
+///
+/// The header may overlap its former location. The capacity of the storage is adjusted so that it
+/// still ends at the same address.
+///
+/// - Returns: The header at its new location.
+ArrayHeader* move_header(mvs_AnyArray* array, int64_t delta) {
+  auto* header = get_array_header(array);
+  uint16_t kind = header->kind;
+  uint16_t advice = header->advice;
+  int64_t head = header->head + delta;
+  uint64_t refc = header->refc.load(std::memory_order_relaxed);
+  int64_t count = header->count;
+  int64_t capacity = header->capacity - delta;
+
+  auto* moved = (ArrayHeader*)((uint8_t*)header + delta);
+  moved->kind     = kind;
+  moved->advice   = advice;
+  moved->head     = head;
+  moved->refc     = refc;
+  moved->count    = count;
+  moved->capacity = capacity;
+  array->payload = get_payload(moved);
+  return moved;
+}
+
+/// Guarantees that the given array has a unique storage, with room for at least one element
+/// before its first one and large enough to hold `count` elements.
+///
+/// New storage is allocated if the current one is shared or has no room at its front. Its free
+/// space is proportional to the number of elements, and split evenly between the front and the
+/// back of the elements, so that a sequence of insertions at either end runs in amortized constant
+/// time per element.
+///
+/// - Returns: The header of the array's storage.
+ArrayHeader* reserve_front(mvs_AnyArray* array, const mvs_MetaType* elem_type, int64_t count) {
+  int64_t stride = elem_type->size;
+  auto* header = get_array_header(array);
+  bool is_unique = (header != nullptr) && (header->refc.load(std::memory_order_acquire) == 1);
+  if (is_unique && (header->head >= stride) && (header->capacity >= (count - 1) * stride)) {
+    return header;
+  }
+
+  // Allocate new storage, with room for as many elements at the front as at the back. Its size
+  // depends on the number of elements rather than on the size of the current storage, whose free
+  // space may be at its back.
+  int64_t old_count = (header != nullptr) ? header->count : 0;
+  int64_t capacity = 2 * count * stride * array_growth_percent / 100;
+  if (capacity < array_min_capacity * stride) { capacity = array_min_capacity * stride; }
+
+  bool file_backed = (header != nullptr) && (header->kind == storage_file);
+  auto* new_header = allocate_storage(old_count, capacity, file_backed);
+  uint8_t* new_payload = get_payload(new_header);
+  if (file_backed) { new_header->advice = header->advice; }
+
+  // The head is stored on 32 bits.
+  int64_t front = (stride > 0) ? (new_header->capacity / stride - old_count) / 2 * stride : 0;
+  if (front > UINT32_MAX) { front = UINT32_MAX / stride * stride; }
+  new_payload += front;
+
+  if (is_unique) {
+    // Move the elements out of the current storage, which can then be deallocated.
+    memcpy(new_payload, array->payload, old_count * stride);
+    deallocate_storage(header);
+  } else if (header != nullptr) {
+    // Copy the elements of the current storage, and release it.
+    copy_elements(new_payload, (uint8_t*)array->payload, old_count, elem_type);
+    mvs_array_drop(array, elem_type);
+    mvs_count(cow_copies, 1);
+    mvs_count(cow_bytes, old_count * stride);
+  }
+
+  array->payload = get_payload(new_header);
+  return move_header(array, front);
+}
+
+/// Moves the first element of a non-empty array with a unique storage to uninitialized memory.
+///
+/// The header of the storage is moved over the element, unless the array becomes empty, in which
+/// case the storage is deallocated. If the head of the storage can't grow any further, the
+/// remaining elements are moved to the start of the storage instead.
+void move_first(mvs_AnyArray* array, const mvs_MetaType* elem_type, void* dst) {
+  auto* header = get_array_header(array);
+  int64_t stride = elem_type->size;
+  memcpy(dst, array->payload, stride);
+
+  if (header->count == 1) {
+    deallocate_storage(header);
+    array->payload = nullptr;
+  } else if (header->head + stride <= UINT32_MAX) {
+    header = move_header(array, stride);
+    header->count -= 1;
+  } else {
+    int64_t count = header->count - 1;
+    uint8_t* elements = (uint8_t*)array->payload + stride;
+    header = move_header(array, -(int64_t)header->head);
+    memmove(array->payload, elements, count * stride);
+    header->count = count;
+  }
+}
+
+/// Restores the heap property of the `i`-th element of a heap with respect to its ancestors.
+void sift_up(uint8_t* payload, int64_t stride, int64_t i, mvs_LessFunc less, void* context) {
+  while (i > 0) {
+    int64_t parent = (i - 1) / 2;
+    if (!less(&payload[i * stride], &payload[parent * stride], context)) { return; }
+    swap_bytes(&payload[i * stride], &payload[parent * stride], stride);
+    i = parent;
+  }
+}
+
+/// Restores the heap property of the `i`-th element of a heap with respect to its descendants.
+void sift_down(uint8_t* payload, int64_t stride, int64_t count, int64_t i,
+               mvs_LessFunc less, void* context) {
+  while (true) {
+    int64_t min = 2 * i + 1;
+    if (min >= count) { return; }
+    if ((min + 1 < count) && less(&payload[(min + 1) * stride], &payload[min * stride], context)) {
+      min = min + 1;
+    }
+
+    if (!less(&payload[min * stride], &payload[i * stride], context)) { return; }
+    swap_bytes(&payload[i * stride], &payload[min * stride], stride);
+    i = min;
+  }
+}
+
+extern "C" {
+
+/// Appends a copy of an element at the end of an array.
+///
+/// The array's storage is uniquified if necessary, and grown geometrically so that appending runs
+/// in amortized constant time.
 ///
 /// - Parameters:
-///   - dst: A pointer to the destination container.
-///   - src: A pointer to the source container.
-void mvs_exist_copy(mvs_Existential* dst, mvs_Existential* src) {
+///   - array: A pointer to an array.
+///   - elem_type: A pointer to the metatype of the type of the array's elements.
+///   - elem: A pointer to the element to append.
+///
+/// - Returns: The number of elements in the array after the insertion.
+int64_t mvs_array_append(mvs_AnyArray* array, const mvs_MetaType* elem_type, const void* elem) {
 #ifdef DEBUG
-  fprintf(stderr, "mvs_exist_copy(%p, %p)\n", dst, src);
+  fprintf(stderr, "mvs_array_append(%p, %p, %p)\n", array, elem_type, elem);
 #endif
 
-  // Copy the witness.
-  dst->witness = src->witness;
+  int64_t count = (array->payload != nullptr) ? get_array_header(array)->count : 0;
+  auto* header = reserve_unique(array, elem_type, count + 1);
+  copy_element((uint8_t*)array->payload + count * elem_type->size, elem, elem_type);
+  header->count = count + 1;
+  return count + 1;
+}
 
-  // Prepare the destination's storage.
-  uint8_t* srcStorage = nullptr;
-  uint8_t* dstStorage = nullptr;
-  if (src->witness->size <= sizeof(int64_t) * 3) {
-    // Storage is inline.
-    srcStorage = reinterpret_cast<uint8_t*>(src->storage);
-    dstStorage = reinterpret_cast<uint8_t*>(dst->storage);
-  } else {
-    // Storage is out-of-line.
-    srcStorage = *(reinterpret_cast<uint8_t**>(src->storage));
-    dstStorage = mvs_malloc(src->witness->size);
-    reinterpret_cast<uint8_t**>(dst->storage)[0] = dstStorage;
+/// Removes the last element of an array and moves it to uninitialized memory.
+///
+/// If the array is empty, `dst` is zero-initialized.
+///
+/// - Parameters:
+///   - array: A pointer to an array.
+///   - elem_type: A pointer to the metatype of the type of the array's elements.
+///   - dst: A pointer to uninitialized memory.
+void mvs_array_pop_last(mvs_AnyArray* array, const mvs_MetaType* elem_type, void* dst) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_array_pop_last(%p, %p, %p)\n", array, elem_type, dst);
+#endif
+
+  if (array->payload == nullptr) { return init_element(dst, elem_type); }
+  mvs_array_uniq(array, elem_type);
+  move_last(array, elem_type, dst);
+}
+
+/// Inserts a copy of an element at the front of an array.
+///
+/// The array's storage is uniquified if necessary, and grown geometrically at its front so that
+/// inserting at the front runs in amortized constant time.
+///
+/// - Parameters:
+///   - array: A pointer to an array.
+///   - elem_type: A pointer to the metatype of the type of the array's elements.
+///   - elem: A pointer to the element to insert.
+///
+/// - Returns: The number of elements in the array after the insertion.
+int64_t mvs_array_push_front(mvs_AnyArray* array, const mvs_MetaType* elem_type,
+                             const void* elem) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_array_push_front(%p, %p, %p)\n", array, elem_type, elem);
+#endif
+
+  int64_t count = (array->payload != nullptr) ? get_array_header(array)->count : 0;
+  reserve_front(array, elem_type, count + 1);
+  auto* header = move_header(array, -elem_type->size);
+  copy_element((uint8_t*)array->payload, elem, elem_type);
+  header->count = count + 1;
+  return count + 1;
+}
 
+/// Removes the first element of an array and moves it to uninitialized memory, in constant time.
+///
+/// If the array is empty, `dst` is zero-initialized.
+///
+/// - Parameters:
+///   - array: A pointer to an array.
+///   - elem_type: A pointer to the metatype of the type of the array's elements.
+///   - dst: A pointer to uninitialized memory.
+void mvs_array_pop_front(mvs_AnyArray* array, const mvs_MetaType* elem_type, void* dst) {
 #ifdef DEBUG
-    fprintf(stderr, "  alloc %lli bytes at %p\n", src->witness->size, dstStorage);
+  fprintf(stderr, "mvs_array_pop_front(%p, %p, %p)\n", array, elem_type, dst);
+#endif
+
+  if (array->payload == nullptr) { return init_element(dst, elem_type); }
+  mvs_array_uniq(array, elem_type);
+  move_first(array, elem_type, dst);
+}
+
+/// Inserts a copy of an element into an array that satisfies the heap property with respect to
+/// the given comparison function, in logarithmic time.
+///
+/// - Parameters:
+///   - array: A pointer to an array organized as a binary heap.
+///   - elem_type: A pointer to the metatype of the type of the array's elements.
+///   - elem: A pointer to the element to insert.
+///   - less: A comparison function.
+///   - context: The context passed to the comparison function.
+///
+/// - Returns: The number of elements in the heap after the insertion.
+int64_t mvs_heap_push(mvs_AnyArray* array, const mvs_MetaType* elem_type, const void* elem,
+                      mvs_LessFunc less, void* context) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_heap_push(%p, %p, %p)\n", array, elem_type, elem);
+#endif
+
+  int64_t count = mvs_array_append(array, elem_type, elem);
+  sift_up((uint8_t*)array->payload, elem_type->size, count - 1, less, context);
+  return count;
+}
+
+/// Removes the minimum element of an array that satisfies the heap property with respect to the
+/// given comparison function, and moves it to uninitialized memory, in logarithmic time.
+///
+/// If the heap is empty, `dst` is zero-initialized.
+///
+/// - Parameters:
+///   - array: A pointer to an array organized as a binary heap.
+///   - elem_type: A pointer to the metatype of the type of the array's elements.
+///   - dst: A pointer to uninitialized memory.
+///   - less: A comparison function.
+///   - context: The context passed to the comparison function.
+void mvs_heap_pop(mvs_AnyArray* array, const mvs_MetaType* elem_type, void* dst,
+                  mvs_LessFunc less, void* context) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_heap_pop(%p, %p, %p)\n", array, elem_type, dst);
 #endif
+
+  if (array->payload == nullptr) { return init_element(dst, elem_type); }
+  mvs_array_uniq(array, elem_type);
+
+  // Swap the minimum element with the last one, and restore the heap property.
+  uint8_t* payload = (uint8_t*)array->payload;
+  int64_t stride = elem_type->size;
+  int64_t count = get_array_header(array)->count;
+  swap_bytes(payload, &payload[(count - 1) * stride], stride);
+  move_last(array, elem_type, dst);
+  if (count > 2) {
+    sift_down(payload, stride, count - 1, 0, less, context);
   }
+}
 
-  // Copy the contents of the source container.
-  if (src->witness->copy == nullptr) {
-    memcpy(dstStorage, srcStorage, src->witness->size);
+/// Replaces the elements of an array from position `at` with copies of the elements of another
+/// array in the range `[start, end)`, clamped so that both ranges fit in their arrays.
+///
+/// The destination is uniquified once, before any element is written. Trivial elements are copied
+/// with a single `memmove`; other elements are dropped and copied in a single sweep, ordered so
+/// that overlapping ranges of the same storage are handled correctly.
+///
+/// - Parameters:
+///   - dst: A pointer to the destination array.
+///   - elem_type: A pointer to the metatype of the type of the arrays' elements.
+///   - at: The position of the first element to replace in `dst`.
+///   - src: A pointer to the source array, which may be the destination.
+///   - start: The position of the first element to copy in `src`.
+///   - end: The position after the last element to copy in `src`.
+///
+/// - Returns: The number of elements copied.
+int64_t mvs_array_copy_range(mvs_AnyArray* dst, const mvs_MetaType* elem_type, int64_t at,
+                             const mvs_AnyArray* src, int64_t start, int64_t end) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_array_copy_range(%p, %p, %lli, %p)\n", dst, elem_type, at, src);
+#endif
+
+  int64_t src_count = (src->payload != nullptr)
+    ? get_array_header(const_cast<mvs_AnyArray*>(src))->count
+    : 0;
+  int64_t dst_count = (dst->payload != nullptr) ? get_array_header(dst)->count : 0;
+  int64_t n = clamp_range(&start, &end, src_count);
+  at = (at < 0) ? 0 : ((at > dst_count) ? dst_count : at);
+  n = (n < dst_count - at) ? n : dst_count - at;
+  if (n == 0) { return 0; }
+
+  // Uniquify the destination first, as `src` may denote the same array.
+  mvs_array_uniq(dst, elem_type);
+  int64_t stride = elem_type->size;
+  uint8_t* d = (uint8_t*)dst->payload + at * stride;
+  uint8_t* s = (uint8_t*)src->payload + start * stride;
+  if (d == s) { return n; }
+
+  if (elem_type->copy == nullptr) {
+    memmove(d, s, n * stride);
+  } else if (d < s) {
+    for (int64_t i = 0; i < n; ++i) {
+      drop_element(&d[i * stride], elem_type);
+      elem_type->copy(&d[i * stride], &s[i * stride]);
+    }
   } else {
-    src->witness->copy(dstStorage, srcStorage);
+    for (int64_t i = n - 1; i >= 0; --i) {
+      drop_element(&d[i * stride], elem_type);
+      elem_type->copy(&d[i * stride], &s[i * stride]);
+    }
   }
+  return n;
 }
 
-/// Returns whether the two given existential containers are equal.
+/// Replaces the elements of an array in the range `[start, end)`, clamped to its bounds, with
+/// copies of the given element.
+///
+/// Trivial elements are written with `broadcast`.
 ///
 /// - Parameters:
-///   - lhs: A container.
-///   - rhs: Another container.
-int64_t mvs_exist_equal(const mvs_Existential* lhs, const mvs_Existential* rhs) {
-  // Clearly false if the container don't have the same witness.
-  if (lhs->witness != rhs->witness) { return 0; }
+///   - array: A pointer to an array.
+///   - elem_type: A pointer to the metatype of the type of the array's elements.
+///   - start: The position of the first element to replace.
+///   - end: The position after the last element to replace.
+///   - elem: A pointer to the element to copy.
+///
+/// - Returns: The number of elements replaced.
+int64_t mvs_array_fill(mvs_AnyArray* array, const mvs_MetaType* elem_type,
+                       int64_t start, int64_t end, const void* elem) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_array_fill(%p, %p, %lli, %lli, %p)\n", array, elem_type, start, end, elem);
+#endif
 
-  if (lhs->witness->size <= sizeof(int64_t) * 3) {
-    // Storage is inline.
-    auto a = reinterpret_cast<const uint8_t*>(lhs->storage);
-    auto b = reinterpret_cast<const uint8_t*>(rhs->storage);
-    return lhs->witness->equal(a, b);
+  int64_t count = (array->payload != nullptr) ? get_array_header(array)->count : 0;
+  int64_t n = clamp_range(&start, &end, count);
+  if (n == 0) { return 0; }
+
+  mvs_array_uniq(array, elem_type);
+  int64_t stride = elem_type->size;
+  uint8_t* d = (uint8_t*)array->payload + start * stride;
+
+  if (elem_type->copy != nullptr) {
+    for (int64_t i = 0; i < n; ++i) {
+      drop_element(&d[i * stride], elem_type);
+      elem_type->copy(&d[i * stride], const_cast<void*>(elem));
+    }
   } else {
-    // Storage is out-of-line.
-    auto a = reinterpret_cast<uint8_t* const*>(lhs->storage)[0];
-    auto b = reinterpret_cast<uint8_t* const*>(rhs->storage)[0];
-    return lhs->witness->equal(a, b);
+    broadcast(d, elem, stride, n);
   }
+  return n;
 }
 
-/// Returns the square root of the specified number.
-double mvs_sqrt(double x) {
-  return sqrt(x);
+/// Reverses the order of the elements of an array in the range `[start, end)`, clamped to its
+/// bounds.
+///
+/// Elements are swapped bitwise, without being copied.
+///
+/// - Parameters:
+///   - array: A pointer to an array.
+///   - elem_type: A pointer to the metatype of the type of the array's elements.
+///   - start: The position of the first element of the range.
+///   - end: The position after the last element of the range.
+///
+/// - Returns: The number of elements in the range.
+int64_t mvs_array_reverse(mvs_AnyArray* array, const mvs_MetaType* elem_type,
+                          int64_t start, int64_t end) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_array_reverse(%p, %p, %lli, %lli)\n", array, elem_type, start, end);
+#endif
+
+  int64_t count = (array->payload != nullptr) ? get_array_header(array)->count : 0;
+  int64_t n = clamp_range(&start, &end, count);
+  if (n < 2) { return n; }
+
+  mvs_array_uniq(array, elem_type);
+  int64_t stride = elem_type->size;
+  uint8_t* payload = (uint8_t*)array->payload;
+  for (int64_t i = start, j = end - 1; i < j; ++i, --j) {
+    swap_bytes(&payload[i * stride], &payload[j * stride], stride);
+  }
+  return n;
 }
 
-/// Returns the number of nanoseconds since boot, excluding any time the system spent asleep.
-double mvs_uptime_nanoseconds() {
-  auto clock = std::chrono::high_resolution_clock::now();
-  auto delta = std::chrono::duration_cast<std::chrono::nanoseconds>(clock.time_since_epoch());
-  return delta.count();
+/// Initializes an array with the concatenation of two arrays.
+///
+/// If either array is empty, the result shares the storage of the other one. Otherwise, trivial
+/// elements are copied with two `memcpy`s.
+///
+/// - Parameters:
+///   - dst: A pointer to an uninitialized array structure.
+///   - elem_type: A pointer to the metatype of the type of the arrays' elements.
+///   - lhs: A pointer to the first array.
+///   - rhs: A pointer to the second array.
+void mvs_array_concat(mvs_AnyArray* dst, const mvs_MetaType* elem_type,
+                      mvs_AnyArray* lhs, mvs_AnyArray* rhs) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_array_concat(%p, %p, %p, %p)\n", dst, elem_type, lhs, rhs);
+#endif
+
+  if (rhs->payload == nullptr) { return mvs_array_copy(dst, lhs); }
+  if (lhs->payload == nullptr) { return mvs_array_copy(dst, rhs); }
+
+  int64_t stride = elem_type->size;
+  int64_t lhs_count = get_array_header(lhs)->count;
+  int64_t rhs_count = get_array_header(rhs)->count;
+  dst->payload = nullptr;
+  auto* header = reserve_unique(dst, elem_type, lhs_count + rhs_count);
+
+  uint8_t* d = (uint8_t*)dst->payload;
+  uint8_t* l = (uint8_t*)lhs->payload;
+  uint8_t* r = (uint8_t*)rhs->payload;
+  copy_elements(d, l, lhs_count, elem_type);
+  copy_elements(&d[lhs_count * stride], r, rhs_count, elem_type);
+  header->count = lhs_count + rhs_count;
 }
 
-void mvs_print_i64(int64_t value) {
-  printf("%lli\n", value);
+/// Initializes an array with `count` copies of an element, in a single allocation.
+///
+/// Trivial elements are written with `broadcast`. Arrays and strings are copied bitwise, and the
+/// reference counter of their storage is incremented once by `count`, rather than once per copy.
+///
+/// - Parameters:
+///   - array: A pointer to an uninitialized array structure.
+///   - elem_type: A pointer to the metatype of the type of the array's elements.
+///   - elem: A pointer to the element to copy.
+///   - count: The number of elements in the array.
+void mvs_array_repeating(mvs_AnyArray* array, const mvs_MetaType* elem_type,
+                         const void* elem, int64_t count) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_array_repeating(%p, %p, %p, %lli)\n", array, elem_type, elem, count);
+#endif
+
+  if (count <= 0) {
+    array->payload = nullptr;
+    return;
+  }
+
+  // Allocate new storage.
+  int64_t stride = elem_type->size;
+  int64_t capacity = count * stride;
+  array->payload = get_payload(allocate_storage(count, capacity));
+
+  uint8_t* d = (uint8_t*)array->payload;
+  if (elem_type->copy == nullptr) {
+    broadcast(d, elem, stride, count);
+  } else if ((elem_type->kind == mvs_kind_array) || (elem_type->kind == mvs_kind_string)) {
+    broadcast(d, elem, stride, count);
+    if (auto* shared = get_shared_storage(elem, elem_type)) {
+      shared->refc.fetch_add(count, std::memory_order_relaxed);
+      mvs_count(retains, 1);
+    }
+  } else {
+    for (int64_t i = 0; i < count; ++i) {
+      elem_type->copy(&d[i * stride], const_cast<void*>(elem));
+    }
+  }
 }
 
-void mvs_print_f64(double value) {
-  printf("%f\n", value);
+/// Moves the elements of an array to storage mapped from a new scratch file, unless its storage
+/// is already mapped.
+///
+/// The elements are moved bitwise if the current storage is unique, or copied otherwise. The
+/// array keeps its storage if no scratch file could be created.
+///
+/// - Parameters:
+///   - array: A pointer to an array.
+///   - elem_type: A pointer to the metatype of the type of the array's elements.
+///
+/// - Returns: The number of elements in the array.
+int64_t mvs_array_spill(mvs_AnyArray* array, const mvs_MetaType* elem_type) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_array_spill(%p, %p)\n", array, elem_type);
+#endif
+
+  auto* header = get_array_header(array);
+  if (header == nullptr) { return 0; }
+  if (header->kind == storage_file) { return header->count; }
+
+  auto* new_header = allocate_storage(header->count, header->capacity, true);
+  if (new_header->kind != storage_file) {
+    deallocate_storage(new_header);
+    return header->count;
+  }
+
+  int64_t stride = elem_type->size;
+  uint8_t* new_payload = get_payload(new_header);
+  if (header->refc.load(std::memory_order_acquire) == 1) {
+    memcpy(new_payload, array->payload, header->count * stride);
+    deallocate_storage(header);
+  } else {
+    copy_elements(new_payload, (uint8_t*)array->payload, header->count, elem_type);
+    mvs_array_drop(array, elem_type);
+  }
+
+  array->payload = new_payload;
+  return new_header->count;
+}
+
+/// Advises the kernel of the pattern in which the elements of an array will be accessed, if its
+/// storage is mapped from a file.
+///
+/// The advice is kept by the storage, and inherited by the storage to which it is copied.
+///
+/// - Parameters:
+///   - array: A pointer to an array.
+///   - pattern: `1` for sequential accesses, `2` for random accesses, or any other value for the
+///     default behavior.
+///
+/// - Returns: The number of elements in the array.
+int64_t mvs_array_advise(const mvs_AnyArray* array, int64_t pattern) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_array_advise(%p, %lli)\n", array, pattern);
+#endif
+
+  auto* header = get_array_header(const_cast<mvs_AnyArray*>(array));
+  if (header == nullptr) { return 0; }
+
+  if (header->kind == storage_file) {
+    header->advice = (pattern == 1) ? MADV_SEQUENTIAL : (pattern == 2) ? MADV_RANDOM : MADV_NORMAL;
+    advise_storage(header, header->advice);
+  }
+  return header->count;
+}
+
+/// Destroys an existential container, including out-of-line storage, if any.
+///
+/// - Parameter container: A pointer to the container that should be destroyed.
+void mvs_exist_drop(mvs_Existential* container) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_exist_drop(%p)\n", container);
+#endif
+  if (container->witness->size <= sizeof(int64_t) * 3) {
+    // Storage is inline.
+    if (container->witness->drop != nullptr) {
+      container->witness->drop(reinterpret_cast<uint8_t*>(container->storage));
+    }
+  } else {
+    // Storage is out-of-line.
+    auto storage = reinterpret_cast<uint8_t**>(container->storage)[0];
+    if (container->witness->drop != nullptr) {
+      container->witness->drop(storage);
+    }
+    mvs_free(storage);
+#ifdef DEBUG
+    fprintf(stderr, "  dealloc %p\n", storage);
+#endif
+  }
+
+  memset(container, 0, sizeof(mvs_Existential));
+}
+
+/// Copies an existential container.
+///
+/// - Parameters:
+///   - dst: A pointer to the destination container.
+///   - src: A pointer to the source container.
+void mvs_exist_copy(mvs_Existential* dst, mvs_Existential* src) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_exist_copy(%p, %p)\n", dst, src);
+#endif
+
+  // Copy the witness.
+  dst->witness = src->witness;
+
+  // Prepare the destination's storage.
+  uint8_t* srcStorage = nullptr;
+  uint8_t* dstStorage = nullptr;
+  if (src->witness->size <= sizeof(int64_t) * 3) {
+    // Storage is inline.
+    srcStorage = reinterpret_cast<uint8_t*>(src->storage);
+    dstStorage = reinterpret_cast<uint8_t*>(dst->storage);
+  } else {
+    // Storage is out-of-line.
+    srcStorage = *(reinterpret_cast<uint8_t**>(src->storage));
+    dstStorage = mvs_malloc(src->witness->size);
+    reinterpret_cast<uint8_t**>(dst->storage)[0] = dstStorage;
+
+#ifdef DEBUG
+    fprintf(stderr, "  alloc %lli bytes at %p\n", src->witness->size, dstStorage);
+#endif
+  }
+
+  // Copy the contents of the source container.
+  if (src->witness->copy == nullptr) {
+    memcpy(dstStorage, srcStorage, src->witness->size);
+  } else {
+    src->witness->copy(dstStorage, srcStorage);
+  }
+}
+
+/// Returns whether the two given existential containers are equal.
+///
+/// - Parameters:
+///   - lhs: A container.
+///   - rhs: Another container.
+int64_t mvs_exist_equal(const mvs_Existential* lhs, const mvs_Existential* rhs) {
+  // Clearly false if the container don't have the same witness.
+  if (lhs->witness != rhs->witness) { return 0; }
+
+  if (lhs->witness->size <= sizeof(int64_t) * 3) {
+    // Storage is inline.
+    auto a = reinterpret_cast<const uint8_t*>(lhs->storage);
+    auto b = reinterpret_cast<const uint8_t*>(rhs->storage);
+    return lhs->witness->equal(a, b);
+  } else {
+    // Storage is out-of-line.
+    auto a = reinterpret_cast<uint8_t* const*>(lhs->storage)[0];
+    auto b = reinterpret_cast<uint8_t* const*>(rhs->storage)[0];
+    return lhs->witness->equal(a, b);
+  }
+}
+
+}
+
+/// The maximum number of bytes of a string stored inline.
+const int64_t small_string_capacity = 15;
+
+/// Returns whether the given string is stored inline.
+inline bool is_small_string(const mvs_String* string) {
+  return (string->bytes[15] & 0x80) != 0;
+}
+
+/// Returns the number of bytes in the given string.
+inline int64_t get_string_count(const mvs_String* string) {
+  return is_small_string(string) ? (string->bytes[15] & 0x7f) : string->large.count;
+}
+
+/// Returns a pointer to the bytes of the given string.
+inline const uint8_t* get_string_bytes(const mvs_String* string) {
+  return is_small_string(string) ? string->bytes : string->large.payload;
+}
+
+/// Returns whether the `count` bytes at the given addresses are equal.
+///
+/// Bytes are compared by blocks of 16 using SIMD instructions, when available.
+inline bool bytes_equal(const uint8_t* lhs, const uint8_t* rhs, int64_t count) {
+  int64_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 16 <= count; i += 16) {
+    auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+    auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xffff) { return false; }
+  }
+#endif
+  return memcmp(lhs + i, rhs + i, count - i) == 0;
+}
+
+/// Returns the position of the first occurrence of `needle` in `haystack`, or -1.
+///
+/// Candidate positions are found by comparing the first byte of the needle against blocks of 16
+/// bytes of the haystack using SIMD instructions, when available.
+inline int64_t bytes_find(const uint8_t* haystack, int64_t count,
+                          const uint8_t* needle, int64_t needle_count) {
+  if (needle_count == 0) { return 0; }
+  if (needle_count > count) { return -1; }
+
+  int64_t last = count - needle_count;
+  int64_t i = 0;
+#if defined(__SSE2__)
+  auto first = _mm_set1_epi8(static_cast<char>(needle[0]));
+  for (; i + 16 <= last + 1; i += 16) {
+    auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, first));
+    while (mask != 0) {
+      int j = __builtin_ctz(mask);
+      if (memcmp(haystack + i + j, needle, needle_count) == 0) { return i + j; }
+      mask &= mask - 1;
+    }
+  }
+#endif
+  for (; i <= last; ++i) {
+    if ((haystack[i] == needle[0]) && (memcmp(haystack + i, needle, needle_count) == 0)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+extern "C" {
+
+/// Initializes a string with a copy of the given bytes.
+///
+/// - Parameters:
+///   - string: A pointer to an uninitialized string.
+///   - bytes: A pointer to the bytes of the string.
+///   - count: The number of bytes in the string.
+void mvs_string_init(mvs_String* string, const uint8_t* bytes, int64_t count) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_string_init(%p, %p, %lli)\n", string, bytes, count);
+#endif
+
+  memset(string, 0, sizeof(mvs_String));
+  if (count == 0) { return; }
+
+  if (count <= small_string_capacity) {
+    memcpy(string->bytes, bytes, count);
+    string->bytes[15] = 0x80 | static_cast<uint8_t>(count);
+    return;
+  }
+
+  // Allocate new storage.
+  string->large.payload = get_payload(allocate_storage(count, count));
+  string->large.count = count;
+  memcpy(string->large.payload, bytes, count);
+}
+
+/// Destroys a string, deallocating memory as necessary.
+///
+/// - Parameter string: A pointer to the string that should be destroyed.
+void mvs_string_drop(mvs_String* string) {
+  if (is_small_string(string) || (string->large.payload == nullptr)) { return; }
+
+  auto* header = (ArrayHeader*)(string->large.payload - sizeof(ArrayHeader));
+  release_storage(header, &byte_metatype, 1);
+
+  memset(string, 0, sizeof(mvs_String));
+}
+
+/// Copies a string.
+///
+/// Small strings are copied bitwise. The storage of large strings is shared. There is no need to
+/// uniquify it, as strings are immutable.
+///
+/// - Parameters:
+///   - dst: A pointer to the destination string.
+///   - src: A pointer to the source string.
+void mvs_string_copy(mvs_String* dst, const mvs_String* src) {
+  *dst = *src;
+  if (is_small_string(src) || (src->large.payload == nullptr)) { return; }
+
+  auto* header = (ArrayHeader*)(src->large.payload - sizeof(ArrayHeader));
+  header->refc.fetch_add(1, std::memory_order_relaxed);
+  mvs_count(retains, 1);
+}
+
+/// Returns whether the two given strings are equal.
+int64_t mvs_string_equal(const mvs_String* lhs, const mvs_String* rhs) {
+  // Small strings are zero-padded, so they can be compared bitwise. A small string is never equal
+  // to a large one, as both representations do not overlap.
+  if (is_small_string(lhs) || is_small_string(rhs)) {
+    return (memcmp(lhs, rhs, sizeof(mvs_String)) == 0) ? 1 : 0;
+  }
+
+  if (lhs->large.count != rhs->large.count) { return 0; }
+  if (lhs->large.payload == rhs->large.payload) { return 1; }
+  return bytes_equal(lhs->large.payload, rhs->large.payload, lhs->large.count) ? 1 : 0;
+}
+
+/// Returns the number of bytes in the given string.
+int64_t mvs_string_count(const mvs_String* string) {
+  return get_string_count(string);
+}
+
+/// Returns the byte at the given position in the given string.
+int64_t mvs_string_byte(const mvs_String* string, int64_t index) {
+  mvs_assert((0 <= index) && (index < get_string_count(string)));
+  return get_string_bytes(string)[index];
+}
+
+/// Returns a hash of the given string.
+///
+/// Bytes are hashed 16 at a time, in two independent 64-bit lanes that are combined at the end.
+int64_t mvs_string_hash(const mvs_String* string) {
+  const uint64_t k = 0x9e3779b97f4a7c15ull;
+  const uint8_t* bytes = get_string_bytes(string);
+  int64_t count = get_string_count(string);
+
+  uint64_t h0 = k ^ static_cast<uint64_t>(count);
+  uint64_t h1 = ~k;
+  int64_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    uint64_t a, b;
+    memcpy(&a, bytes + i, 8);
+    memcpy(&b, bytes + i + 8, 8);
+    h0 = (h0 ^ a) * k;
+    h1 = (h1 ^ b) * k;
+    h0 ^= h0 >> 29;
+    h1 ^= h1 >> 29;
+  }
+
+  uint8_t tail[16] = {};
+  memcpy(tail, bytes + i, count - i);
+  uint64_t a, b;
+  memcpy(&a, tail, 8);
+  memcpy(&b, tail + 8, 8);
+  h0 = (h0 ^ a) * k;
+  h1 = (h1 ^ b) * k;
+
+  uint64_t h = (h0 ^ (h1 >> 32) ^ (h1 << 32)) * k;
+  return static_cast<int64_t>(h ^ (h >> 31));
+}
+
+/// Returns the position of the first occurrence of `needle` in `string`, or -1.
+int64_t mvs_string_find(const mvs_String* string, const mvs_String* needle) {
+  return bytes_find(
+    get_string_bytes(string), get_string_count(string),
+    get_string_bytes(needle), get_string_count(needle));
+}
+
+/// Initializes a string with the bytes of another string in the range `[start, end)`, clamped to
+/// the bounds of the source.
+///
+/// - Parameters:
+///   - dst: A pointer to an uninitialized string.
+///   - src: A pointer to the source string.
+///   - start: The position of the first byte to copy.
+///   - end: The position after the last byte to copy.
+void mvs_string_slice(mvs_String* dst, const mvs_String* src, int64_t start, int64_t end) {
+  int64_t count = get_string_count(src);
+  start = (start < 0) ? 0 : ((start > count) ? count : start);
+  end = (end < start) ? start : ((end > count) ? count : end);
+
+  // The slice of a string shares its storage if it covers it entirely.
+  if ((start == 0) && (end == count)) {
+    mvs_string_copy(dst, src);
+  } else {
+    mvs_string_init(dst, get_string_bytes(src) + start, end - start);
+  }
+}
+
+/// Initializes a string with the concatenation of two strings.
+///
+/// - Parameters:
+///   - dst: A pointer to an uninitialized string.
+///   - lhs: A pointer to the first string.
+///   - rhs: A pointer to the second string.
+void mvs_string_concat(mvs_String* dst, const mvs_String* lhs, const mvs_String* rhs) {
+  int64_t lhs_count = get_string_count(lhs);
+  int64_t rhs_count = get_string_count(rhs);
+  if (rhs_count == 0) { return mvs_string_copy(dst, lhs); }
+  if (lhs_count == 0) { return mvs_string_copy(dst, rhs); }
+
+  int64_t count = lhs_count + rhs_count;
+  if (count <= small_string_capacity) {
+    uint8_t bytes[small_string_capacity];
+    memcpy(bytes, get_string_bytes(lhs), lhs_count);
+    memcpy(bytes + lhs_count, get_string_bytes(rhs), rhs_count);
+    return mvs_string_init(dst, bytes, count);
+  }
+
+  memset(dst, 0, sizeof(mvs_String));
+  dst->large.payload = get_payload(allocate_storage(count, count));
+  dst->large.count = count;
+  memcpy(dst->large.payload, get_string_bytes(lhs), lhs_count);
+  memcpy(dst->large.payload + lhs_count, get_string_bytes(rhs), rhs_count);
+}
+
+/// Returns the square root of the specified number.
+double mvs_sqrt(double x) {
+  return sqrt(x);
+}
+
+/// Returns the number of nanoseconds since boot, excluding any time the system spent asleep.
+double mvs_uptime_nanoseconds() {
+  auto clock = std::chrono::high_resolution_clock::now();
+  auto delta = std::chrono::duration_cast<std::chrono::nanoseconds>(clock.time_since_epoch());
+  return delta.count();
+}
+
+void mvs_print_i64(int64_t value) {
+  printf("%lli\n", value);
+}
+
+void mvs_print_f64(double value) {
+  printf("%f\n", value);
+}
+
+void mvs_print_string(const mvs_String* value) {
+  fwrite(get_string_bytes(value), 1, get_string_count(value), stdout);
+  fputc('\n', stdout);
+}
+
+}
+
+/// A closure, as represented by the compiler.
+struct AnyClosure {
+
+  /// A pointer to the closure's function.
+  void* fn;
+
+  /// A pointer to the closure's environment, or null if it has no captures.
+  void* env;
+
+  /// A pointer to the closure's value witness table.
+  const void* vtable;
+
+};
+
+/// Appends `count` bytes at `bytes` to the given buffer.
+inline void write_bytes(std::vector<uint8_t>& out, const void* bytes, size_t count) {
+  auto* first = static_cast<const uint8_t*>(bytes);
+  out.insert(out.end(), first, first + count);
+}
+
+/// Appends a 64-bit word to the given buffer.
+inline void write_word(std::vector<uint8_t>& out, uint64_t word) {
+  write_bytes(out, &word, sizeof(word));
+}
+
+/// A cursor over serialized values.
+struct Reader {
+
+  /// The bytes being read.
+  const uint8_t* bytes;
+
+  /// The number of bytes remaining.
+  size_t count;
+
+  /// Returns a pointer to the next `n` bytes and moves past them.
+  const uint8_t* take(size_t n) {
+    if (n > count) {
+      fprintf(stderr, "fatal error: truncated message from worker process\n");
+      abort();
+    }
+    auto* result = bytes;
+    bytes += n;
+    count -= n;
+    return result;
+  }
+
+  /// Reads a 64-bit word.
+  uint64_t word() {
+    uint64_t result;
+    memcpy(&result, take(sizeof(result)), sizeof(result));
+    return result;
+  }
+
+};
+
+/// Returns a pointer to the payload of an existential container.
+inline uint8_t* get_exist_payload(const mvs_Existential* container) {
+  if (container->witness->size <= static_cast<int64_t>(sizeof(int64_t) * 3)) {
+    return (uint8_t*)container->storage;
+  } else {
+    uint8_t* payload;
+    memcpy(&payload, container->storage, sizeof(payload));
+    return payload;
+  }
+}
+
+/// Appends the serialized representation of a value to the given buffer.
+///
+/// Values are serialized structurally, following the description of their representation in
+/// their metatype. Pointers to metatypes and functions are written as is, as they are only read
+/// by processes forked from the writer, which share its code and static data.
+///
+/// - Parameters:
+///   - out: The buffer to which the value is written.
+///   - src: A pointer to the value.
+///   - type: The metatype of the value.
+void serialize(std::vector<uint8_t>& out, const void* src, const mvs_MetaType* type) {
+  switch (type->kind) {
+  case mvs_kind_trivial:
+    write_bytes(out, src, type->size);
+    return;
+
+  case mvs_kind_array: {
+    auto* elem_type = static_cast<const mvs_MetaType*>(type->layout);
+    auto* header = get_array_header((mvs_AnyArray*)src);
+    int64_t count = (header != nullptr) ? header->count : 0;
+    auto* payload = static_cast<const uint8_t*>(((mvs_AnyArray*)src)->payload);
+    write_word(out, count);
+    if (elem_type->kind == mvs_kind_trivial) {
+      write_bytes(out, payload, count * elem_type->size);
+    } else {
+      for (int64_t i = 0; i < count; ++i) {
+        serialize(out, payload + i * elem_type->size, elem_type);
+      }
+    }
+    return;
+  }
+
+  case mvs_kind_string: {
+    auto* string = static_cast<const mvs_String*>(src);
+    write_word(out, get_string_count(string));
+    write_bytes(out, get_string_bytes(string), get_string_count(string));
+    return;
+  }
+
+  case mvs_kind_existential: {
+    auto* container = static_cast<const mvs_Existential*>(src);
+    write_word(out, reinterpret_cast<uint64_t>(container->witness));
+    if (container->witness != nullptr) {
+      serialize(out, get_exist_payload(container), container->witness);
+    }
+    return;
+  }
+
+  case mvs_kind_closure: {
+    auto* closure = static_cast<const AnyClosure*>(src);
+    if (closure->env != nullptr) {
+      fprintf(stderr, "fatal error: cannot send a closure with captures to a worker process\n");
+      abort();
+    }
+    write_word(out, reinterpret_cast<uint64_t>(closure->fn));
+    write_word(out, reinterpret_cast<uint64_t>(closure->vtable));
+    return;
+  }
+
+  case mvs_kind_struct:
+    for (auto* field = static_cast<const mvs_Field*>(type->layout); field->type; ++field) {
+      serialize(out, static_cast<const uint8_t*>(src) + field->offset, field->type);
+    }
+    return;
+  }
+}
+
+/// Reads a value serialized by `serialize`.
+///
+/// - Parameters:
+///   - in: The reader from which the value is read.
+///   - dst: A pointer to uninitialized or zero-initialized storage for the value.
+///   - type: The metatype of the value.
+void deserialize(Reader& in, void* dst, const mvs_MetaType* type) {
+  switch (type->kind) {
+  case mvs_kind_trivial:
+    memcpy(dst, in.take(type->size), type->size);
+    return;
+
+  case mvs_kind_array: {
+    auto* elem_type = static_cast<const mvs_MetaType*>(type->layout);
+    int64_t count = in.word();
+    auto* array = static_cast<mvs_AnyArray*>(dst);
+    mvs_array_init(array, elem_type, count, elem_type->size);
+    auto* payload = static_cast<uint8_t*>(array->payload);
+    if (elem_type->kind == mvs_kind_trivial) {
+      memcpy(payload, in.take(count * elem_type->size), count * elem_type->size);
+    } else {
+      // Zero-initialized elements own no memory and can be overwritten.
+      for (int64_t i = 0; i < count; ++i) {
+        deserialize(in, payload + i * elem_type->size, elem_type);
+      }
+    }
+    return;
+  }
+
+  case mvs_kind_string: {
+    int64_t count = in.word();
+    mvs_string_init(static_cast<mvs_String*>(dst), in.take(count), count);
+    return;
+  }
+
+  case mvs_kind_existential: {
+    auto* container = static_cast<mvs_Existential*>(dst);
+    memset(container, 0, sizeof(mvs_Existential));
+    container->witness = reinterpret_cast<mvs_MetaType*>(in.word());
+    if (container->witness == nullptr) { return; }
+    if (container->witness->size > static_cast<int64_t>(sizeof(int64_t) * 3)) {
+      auto* payload = mvs_malloc(container->witness->size);
+      memcpy(container->storage, &payload, sizeof(payload));
+    }
+    deserialize(in, get_exist_payload(container), container->witness);
+    return;
+  }
+
+  case mvs_kind_closure: {
+    auto* closure = static_cast<AnyClosure*>(dst);
+    closure->fn = reinterpret_cast<void*>(in.word());
+    closure->env = nullptr;
+    closure->vtable = reinterpret_cast<const void*>(in.word());
+    return;
+  }
+
+  case mvs_kind_struct:
+    for (auto* field = static_cast<const mvs_Field*>(type->layout); field->type; ++field) {
+      deserialize(in, static_cast<uint8_t*>(dst) + field->offset, field->type);
+    }
+    return;
+  }
+}
+
+/// A function that applies the closure `closure` to the value at `src` and writes its result to
+/// the uninitialized storage at `dst`.
+typedef void (*mvs_ApplyFn)(void* dst, const void* src, void* closure);
+
+#if defined(MSG_NOSIGNAL)
+/// The flags of the calls to `send`, which must not raise `SIGPIPE` if the peer is gone.
+static const int send_flags = MSG_NOSIGNAL;
+#else
+static const int send_flags = 0;
+#endif
+
+/// The statistics of a worker process.
+struct WorkerStats {
+
+  /// The number of elements processed.
+  uint64_t items = 0;
+
+  /// The number of batches processed.
+  uint64_t batches = 0;
+
+  /// The number of bytes sent to the worker.
+  uint64_t bytes_sent = 0;
+
+  /// The number of bytes received from the worker.
+  uint64_t bytes_received = 0;
+
+  /// The time spent by the worker applying functions, in nanoseconds.
+  uint64_t busy_ns = 0;
+
+  /// The number of times the worker has been restarted after it died.
+  uint64_t restarts = 0;
+
+};
+
+/// A worker process, as seen from the process that sends it work.
+struct Worker {
+
+  /// The identifier of the process.
+  pid_t pid = -1;
+
+  /// The socket connected to the process.
+  int fd = -1;
+
+  /// The bytes that remain to be sent.
+  std::vector<uint8_t> output;
+
+  /// The number of bytes of `output` already sent.
+  size_t output_offset = 0;
+
+  /// The bytes received and not processed yet.
+  std::vector<uint8_t> input;
+
+  /// The indices of the batches sent to the worker and not answered yet, in order.
+  std::deque<size_t> inflight;
+
+  /// The worker's statistics.
+  WorkerStats stats;
+
+};
+
+/// A range of elements of the array passed to `mvs_scatter`, sent to a worker as one message.
+struct Batch {
+
+  /// The position of the first element.
+  int64_t start;
+
+  /// The position after the last element.
+  int64_t end;
+
+  /// The number of workers that died while processing the batch.
+  int64_t failures;
+
+};
+
+/// The number of times a batch may kill a worker before the program is aborted.
+static const int64_t max_batch_failures = 3;
+
+/// The executor's worker processes, forked by the first call to `mvs_scatter`.
+static std::vector<Worker> workers;
+
+/// Whether this process is a worker.
+static bool is_worker_process = false;
+
+/// Returns the number of nanoseconds elapsed since an arbitrary point in time.
+inline uint64_t now_ns() {
+  auto delta = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(delta).count();
+}
+
+/// Writes all the given bytes to a blocking socket, returning whether it succeeded.
+static bool send_all(int fd, const uint8_t* bytes, size_t count) {
+  while (count > 0) {
+    ssize_t n = send(fd, bytes, count, send_flags);
+    if (n < 0) {
+      if (errno == EINTR) { continue; }
+      return false;
+    }
+    bytes += n;
+    count -= n;
+  }
+  return true;
+}
+
+/// Reads exactly `count` bytes from a blocking socket, returning whether it succeeded.
+static bool recv_all(int fd, uint8_t* bytes, size_t count) {
+  while (count > 0) {
+    ssize_t n = recv(fd, bytes, count, 0);
+    if (n == 0) { return false; }
+    if (n < 0) {
+      if (errno == EINTR) { continue; }
+      return false;
+    }
+    bytes += n;
+    count -= n;
+  }
+  return true;
+}
+
+/// Runs the loop of a worker process, which answers the batches it receives on `fd` until the
+/// socket is closed.
+///
+/// A batch is a message of the form `{ length, apply, fn, vtable, arg_type, result_type, count,
+/// args... }`, and its answer is a message of the form `{ length, busy_ns, results... }`, where
+/// `length` is the number of bytes that follow it.
+[[noreturn]] static void run_worker(int fd) {
+  std::vector<uint8_t> message;
+  std::vector<uint8_t> answer;
+  std::vector<uint8_t> arg;
+  std::vector<uint8_t> result;
+
+  uint64_t length;
+  while (recv_all(fd, (uint8_t*)&length, sizeof(length))) {
+    message.resize(length);
+    if (!recv_all(fd, message.data(), length)) { break; }
+
+    Reader in = { message.data(), message.size() };
+    auto apply = reinterpret_cast<mvs_ApplyFn>(in.word());
+    AnyClosure closure = {
+      reinterpret_cast<void*>(in.word()), nullptr, reinterpret_cast<const void*>(in.word()) };
+    auto arg_type = reinterpret_cast<const mvs_MetaType*>(in.word());
+    auto result_type = reinterpret_cast<const mvs_MetaType*>(in.word());
+    int64_t count = in.word();
+
+    arg.resize(arg_type->size);
+    result.resize(result_type->size);
+    answer.assign(sizeof(uint64_t) * 2, 0);
+
+    uint64_t start = now_ns();
+    for (int64_t i = 0; i < count; ++i) {
+      deserialize(in, arg.data(), arg_type);
+      apply(result.data(), arg.data(), &closure);
+      serialize(answer, result.data(), result_type);
+      drop_element(result.data(), result_type);
+      drop_element(arg.data(), arg_type);
+    }
+
+    uint64_t header[2] = { answer.size() - sizeof(uint64_t), now_ns() - start };
+    memcpy(answer.data(), header, sizeof(header));
+    fflush(stdout);
+    if (!send_all(fd, answer.data(), answer.size())) { break; }
+  }
+
+  fflush(stdout);
+  _exit(0);
+}
+
+/// Forks the worker process at index `i`.
+static void spawn_worker(size_t i) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    fprintf(stderr, "fatal error: cannot create socket for worker process (error %i)\n", errno);
+    abort();
+  }
+#if defined(SO_NOSIGPIPE)
+  int one = 1;
+  setsockopt(fds[0], SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+  setsockopt(fds[1], SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+  // Flush buffered output so that it is not written again by the child.
+  fflush(stdout);
+  fflush(stderr);
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    fprintf(stderr, "fatal error: cannot fork worker process (error %i)\n", errno);
+    abort();
+  }
+
+  if (pid == 0) {
+    // Close the sockets of the other workers, so that they see the end of their input when the
+    // parent closes its own end.
+    is_worker_process = true;
+    close(fds[0]);
+    for (size_t j = 0; j < workers.size(); ++j) {
+      if ((j != i) && (workers[j].fd >= 0)) { close(workers[j].fd); }
+    }
+    run_worker(fds[1]);
+  }
+
+  close(fds[1]);
+  fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+  workers[i].pid = pid;
+  workers[i].fd = fds[0];
+  workers[i].output.clear();
+  workers[i].output_offset = 0;
+  workers[i].input.clear();
+  workers[i].inflight.clear();
+}
+
+/// Stops the workers and prints their statistics if the environment variable
+/// `MVS_EXECUTOR_STATS` is set.
+static void stop_workers() {
+  for (auto& worker : workers) {
+    close(worker.fd);
+  }
+  for (auto& worker : workers) {
+    waitpid(worker.pid, nullptr, 0);
+  }
+
+  if (getenv("MVS_EXECUTOR_STATS") != nullptr) {
+    fprintf(stderr, "%6s %8s %10s %8s %12s %12s %10s %8s\n",
+            "worker", "pid", "items", "batches", "sent", "received", "busy ms", "restarts");
+    for (size_t i = 0; i < workers.size(); ++i) {
+      auto& s = workers[i].stats;
+      fprintf(stderr, "%6zu %8i %10llu %8llu %12llu %12llu %10.1f %8llu\n",
+              i, workers[i].pid, (unsigned long long)s.items, (unsigned long long)s.batches,
+              (unsigned long long)s.bytes_sent, (unsigned long long)s.bytes_received,
+              s.busy_ns / 1e6, (unsigned long long)s.restarts);
+    }
+  }
+  workers.clear();
+}
+
+/// Forks the worker processes, unless they are already running.
+static void start_workers() {
+  if (!workers.empty()) { return; }
+  if (executor_workers < 0) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    executor_workers = (n > 0) ? n : 1;
+  }
+
+  workers.resize(executor_workers);
+  for (size_t i = 0; i < workers.size(); ++i) {
+    spawn_worker(i);
+  }
+  atexit(stop_workers);
+}
+
+/// Appends the message of a batch to the output of a worker.
+static void send_batch(Worker& worker, const Batch& batch, mvs_ApplyFn apply,
+                       const AnyClosure* closure, const mvs_AnyArray* src,
+                       const mvs_MetaType* arg_type, const mvs_MetaType* result_type) {
+  auto& out = worker.output;
+  size_t start = out.size();
+  write_word(out, 0);
+  write_word(out, reinterpret_cast<uint64_t>(apply));
+  write_word(out, reinterpret_cast<uint64_t>(closure->fn));
+  write_word(out, reinterpret_cast<uint64_t>(closure->vtable));
+  write_word(out, reinterpret_cast<uint64_t>(arg_type));
+  write_word(out, reinterpret_cast<uint64_t>(result_type));
+  write_word(out, batch.end - batch.start);
+
+  auto* payload = static_cast<const uint8_t*>(src->payload);
+  for (int64_t i = batch.start; i < batch.end; ++i) {
+    serialize(out, payload + i * arg_type->size, arg_type);
+  }
+
+  uint64_t length = out.size() - start - sizeof(uint64_t);
+  memcpy(&out[start], &length, sizeof(length));
+  worker.stats.bytes_sent += out.size() - start;
+}
+
+/// Restarts a worker that died, sending the batches it was processing back to `pending`.
+static void restart_worker(size_t i, std::vector<Batch>& batches, std::deque<size_t>& pending) {
+  auto& worker = workers[i];
+  close(worker.fd);
+  worker.fd = -1;
+  waitpid(worker.pid, nullptr, 0);
+
+  for (auto it = worker.inflight.rbegin(); it != worker.inflight.rend(); ++it) {
+    auto& batch = batches[*it];
+    if (++batch.failures >= max_batch_failures) {
+      fprintf(stderr,
+              "fatal error: worker processes died %" PRId64 " times on elements "
+              "[%" PRId64 ", %" PRId64 ")\n",
+              batch.failures, batch.start, batch.end);
+      abort();
+    }
+    pending.push_front(*it);
+  }
+
+  spawn_worker(i);
+  worker.stats.restarts += 1;
+}
+
+extern "C" {
+
+/// Applies a function to each element of an array in worker processes, and writes the results
+/// to a new array.
+///
+/// The elements are split into batches, which are serialized and sent to the workers over Unix
+/// domain sockets. Each worker has at most `executor_inflight` batches to process at any time,
+/// so that the memory used by pending messages is bounded. The batches of a worker that dies are
+/// sent to another one.
+///
+/// The function is applied in the calling process if there are no workers, if it is called from
+/// a worker, or if the closure has captures, which cannot be serialized.
+///
+/// - Parameters:
+///   - dst: A pointer to an uninitialized array that receives the results.
+///   - result_type: The metatype of the function's result.
+///   - src: A pointer to the array of arguments.
+///   - arg_type: The metatype of the function's argument.
+///   - apply: A function that applies the closure to one argument.
+///   - closure: A pointer to the closure.
+void mvs_scatter(mvs_AnyArray* dst, const mvs_MetaType* result_type,
+                 const mvs_AnyArray* src, const mvs_MetaType* arg_type,
+                 mvs_ApplyFn apply, void* closure) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_scatter(%p, %p, %p, %p, %p, %p)\n",
+          dst, result_type, src, arg_type, apply, closure);
+#endif
+
+  auto* header = get_array_header((mvs_AnyArray*)src);
+  int64_t count = (header != nullptr) ? header->count : 0;
+  mvs_array_init(dst, result_type, count, result_type->size);
+  if (count == 0) { return; }
+
+  auto* args = static_cast<const uint8_t*>(src->payload);
+  auto* results = static_cast<uint8_t*>(dst->payload);
+  auto* fn = static_cast<const AnyClosure*>(closure);
+  if ((executor_workers == 0) || is_worker_process || (fn->env != nullptr)) {
+    for (int64_t i = 0; i < count; ++i) {
+      apply(results + i * result_type->size, args + i * arg_type->size, closure);
+    }
+    return;
+  }
+
+  start_workers();
+  if (workers.empty()) {
+    for (int64_t i = 0; i < count; ++i) {
+      apply(results + i * result_type->size, args + i * arg_type->size, closure);
+    }
+    return;
+  }
+
+  // Split the elements into batches.
+  int64_t batch_size = executor_batch;
+  if (batch_size == 0) {
+    batch_size = (count + workers.size() * 4 - 1) / (workers.size() * 4);
+  }
+
+  std::vector<Batch> batches;
+  std::deque<size_t> pending;
+  for (int64_t i = 0; i < count; i += batch_size) {
+    pending.push_back(batches.size());
+    batches.push_back({ i, (i + batch_size < count) ? i + batch_size : count, 0 });
+  }
+
+  std::vector<pollfd> fds(workers.size());
+  size_t done = 0;
+  while (done < batches.size()) {
+    // Send batches to the workers that have capacity.
+    for (size_t i = 0; i < workers.size(); ++i) {
+      auto& worker = workers[i];
+      while (!pending.empty() && (worker.inflight.size() < (size_t)executor_inflight)) {
+        send_batch(worker, batches[pending.front()], apply, fn, src, arg_type, result_type);
+        worker.inflight.push_back(pending.front());
+        pending.pop_front();
+      }
+
+      fds[i].fd = worker.fd;
+      fds[i].events = POLLIN;
+      if (worker.output_offset < worker.output.size()) { fds[i].events |= POLLOUT; }
+      fds[i].revents = 0;
+    }
+
+    if (poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR) { continue; }
+      fprintf(stderr, "fatal error: cannot wait for worker processes (error %i)\n", errno);
+      abort();
+    }
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+      auto& worker = workers[i];
+      bool is_dead = false;
+
+      // Send pending output.
+      if (fds[i].revents & POLLOUT) {
+        ssize_t n = send(worker.fd, worker.output.data() + worker.output_offset,
+                         worker.output.size() - worker.output_offset, send_flags);
+        if (n > 0) {
+          worker.output_offset += n;
+          if (worker.output_offset == worker.output.size()) {
+            worker.output.clear();
+            worker.output_offset = 0;
+          }
+        } else if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+          is_dead = true;
+        }
+      }
+
+      // Receive answers.
+      if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+        uint8_t buffer[65536];
+        ssize_t n = recv(worker.fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+          worker.input.insert(worker.input.end(), buffer, buffer + n);
+        } else if ((n == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))) {
+          is_dead = true;
+        }
+      }
+
+      // Process complete answers.
+      size_t offset = 0;
+      while (worker.input.size() - offset >= sizeof(uint64_t)) {
+        uint64_t length;
+        memcpy(&length, &worker.input[offset], sizeof(length));
+        if (worker.input.size() - offset - sizeof(uint64_t) < length) { break; }
+
+        auto& batch = batches[worker.inflight.front()];
+        Reader in = { &worker.input[offset + sizeof(uint64_t)], length };
+        worker.stats.busy_ns += in.word();
+        for (int64_t j = batch.start; j < batch.end; ++j) {
+          deserialize(in, results + j * result_type->size, result_type);
+        }
+
+        worker.stats.items += batch.end - batch.start;
+        worker.stats.batches += 1;
+        worker.stats.bytes_received += length + sizeof(uint64_t);
+        worker.inflight.pop_front();
+        offset += length + sizeof(uint64_t);
+        done += 1;
+      }
+      worker.input.erase(worker.input.begin(), worker.input.begin() + offset);
+
+      if (is_dead) { restart_worker(i, batches, pending); }
+    }
+  }
+}
+
+}
+
+/// The number of elements in a block of a packed array.
+const int64_t packed_block_size = 128;
+
+/// The number of elements in a group of a block, whose bits start at a word boundary.
+const int64_t packed_group_size = 64;
+
+/// The number of words in the header of a packed array, before its directory.
+const int64_t packed_header_size = 2;
+
+/// The number of words describing each block in the directory of a packed array.
+const int64_t packed_entry_size = 3;
+
+/// The encoding of a block storing the offsets of its elements from a common base.
+const uint64_t packed_mode_for = 0;
+
+/// The encoding of a block storing the differences between its consecutive elements, offset by
+/// a common step.
+const uint64_t packed_mode_delta = 1;
+
+/// The metatype of `Int`, used by the runtime to create arrays of integers.
+static const mvs_MetaType int64_metatype = {
+  sizeof(int64_t), nullptr, nullptr, nullptr, nullptr, mvs_kind_trivial, nullptr };
+
+/// Returns the number of bits needed to represent `value`.
+inline int64_t bit_width(uint64_t value) {
+  return (value == 0) ? 0 : 64 - __builtin_clzll(value);
+}
+
+/// Returns a mask of the `width` low-order bits of a word.
+inline uint64_t low_bits(int64_t width) {
+  return (width >= 64) ? ~0ull : ((1ull << width) - 1);
+}
+
+/// Reads the `i`-th value of `width` bits in a group starting at `words`.
+inline uint64_t extract_bits(const uint64_t* words, int64_t i, int64_t width) {
+  if (width == 0) { return 0; }
+  int64_t bit = i * width;
+  int64_t shift = bit % 64;
+  const uint64_t* w = words + bit / 64;
+  uint64_t value = w[0] >> shift;
+  if (shift + width > 64) { value |= w[1] << (64 - shift); }
+  return value & low_bits(width);
+}
+
+/// Writes the `i`-th value of `width` bits in a group starting at `words`.
+inline void insert_bits(uint64_t* words, int64_t i, int64_t width, uint64_t value) {
+  if (width == 0) { return; }
+  int64_t bit = i * width;
+  int64_t shift = bit % 64;
+  uint64_t* w = words + bit / 64;
+  uint64_t mask = low_bits(width);
+  w[0] = (w[0] & ~(mask << shift)) | ((value & mask) << shift);
+  if (shift + width > 64) {
+    w[1] = (w[1] & ~(mask >> (64 - shift))) | ((value & mask) >> (64 - shift));
+  }
+}
+
+/// Decodes the values at positions `J...` of a group of values of `W` bits.
+template <int W, size_t... J>
+inline void unpack_values(const uint64_t* words, uint64_t* values, std::index_sequence<J...>) {
+  int unused[] = { (values[J] = extract_bits(words, J, W), 0)... };
+  (void)unused;
+}
+
+/// Decodes a group of 64 values of `W` bits.
+///
+/// The width and the positions are template parameters so that the decoding is fully unrolled
+/// and all shifts and masks are constants, which lets the compiler vectorize it.
+template <int W>
+void unpack_group(const uint64_t* words, uint64_t* values) {
+  unpack_values<W>(words, values, std::make_index_sequence<packed_group_size>());
+}
+
+/// A function decoding a group of 64 values of a fixed width.
+typedef void (*UnpackGroupFn)(const uint64_t*, uint64_t*);
+
+/// Returns a table of the functions decoding a group, indexed by width.
+template <size_t... W>
+static std::vector<UnpackGroupFn> make_unpack_table(std::index_sequence<W...>) {
+  return { &unpack_group<W>... };
+}
+
+/// The functions decoding a group, indexed by width.
+static const std::vector<UnpackGroupFn> unpack_table =
+  make_unpack_table(std::make_index_sequence<65>());
+
+/// Returns a pointer to the directory entry of the given block of a packed array.
+inline const uint64_t* get_packed_entry(const uint64_t* words, int64_t block) {
+  return words + packed_header_size + block * packed_entry_size;
+}
+
+/// Encodes `count` elements as a block, writing its directory entry to `entry`, without the
+/// offset of its data, and appending its data to `data`.
+///
+/// The block is encoded with frame of reference if its elements are within a small range, or
+/// with delta encoding if they are closer to their predecessors, e.g., if they are sorted.
+static void encode_block(const int64_t* values, int64_t count, uint64_t* entry,
+                         std::vector<uint64_t>& data) {
+  // Compute the width of both encodings.
+  uint64_t min = values[0];
+  uint64_t max = values[0];
+  for (int64_t i = 1; i < count; ++i) {
+    if (values[i] < (int64_t)min) { min = values[i]; }
+    if (values[i] > (int64_t)max) { max = values[i]; }
+  }
+  int64_t for_width = bit_width(max - min);
+
+  int64_t step = 0;
+  int64_t delta_width = 64;
+  if (count > 1) {
+    step = (uint64_t)values[1] - (uint64_t)values[0];
+    for (int64_t i = 2; i < count; ++i) {
+      int64_t d = (uint64_t)values[i] - (uint64_t)values[i - 1];
+      if (d < step) { step = d; }
+    }
+    uint64_t range = 0;
+    for (int64_t i = 1; i < count; ++i) {
+      uint64_t u = (uint64_t)values[i] - (uint64_t)values[i - 1] - (uint64_t)step;
+      if (u > range) { range = u; }
+    }
+    delta_width = bit_width(range);
+  }
+
+  // Write the block's data, one group at a time.
+  bool is_delta = delta_width < for_width;
+  int64_t width = is_delta ? delta_width : for_width;
+  int64_t start = data.size();
+  int64_t groups = (count + packed_group_size - 1) / packed_group_size;
+  data.resize(start + groups * width, 0);
+
+  for (int64_t i = 0; (i < count) && (width > 0); ++i) {
+    uint64_t u;
+    if (!is_delta) {
+      u = (uint64_t)values[i] - min;
+    } else if (i == 0) {
+      u = 0;
+    } else {
+      u = (uint64_t)values[i] - (uint64_t)values[i - 1] - (uint64_t)step;
+    }
+    uint64_t* group = &data[start + (i / packed_group_size) * width];
+    insert_bits(group, i % packed_group_size, width, u);
+  }
+
+  entry[0] = is_delta ? values[0] : min;
+  entry[1] = step;
+  entry[2] = width | ((is_delta ? packed_mode_delta : packed_mode_for) << 7);
+}
+
+/// Decodes the first `count` elements of a block into `values`.
+static void decode_block(const uint64_t* words, int64_t block, int64_t count, int64_t* values) {
+  auto* entry = get_packed_entry(words, block);
+  uint64_t base = entry[0];
+  uint64_t step = entry[1];
+  int64_t width = entry[2] & 0x7f;
+  uint64_t mode = (entry[2] >> 7) & 1;
+  const uint64_t* data = words + (entry[2] >> 8);
+  auto unpack = unpack_table[width];
+
+  // The first element of a delta-encoded block is its base, as its difference is stored as zero.
+  uint64_t previous = base - step;
+  uint64_t group[packed_group_size];
+  for (int64_t i = 0; i < count; i += packed_group_size) {
+    unpack(data + (i / packed_group_size) * width, group);
+    int64_t n = (count - i < packed_group_size) ? count - i : packed_group_size;
+    if (mode == packed_mode_for) {
+      for (int64_t j = 0; j < n; ++j) {
+        values[i + j] = base + group[j];
+      }
+    } else {
+      for (int64_t j = 0; j < n; ++j) {
+        previous += step + group[j];
+        values[i + j] = previous;
+      }
+    }
+  }
+}
+
+/// Returns the number of elements in the given block of a packed array of `count` elements.
+inline int64_t get_block_count(int64_t count, int64_t block) {
+  int64_t remaining = count - block * packed_block_size;
+  return (remaining < packed_block_size) ? remaining : packed_block_size;
+}
+
+/// Reports that a packed array is malformed and aborts.
+[[noreturn]] static void packed_array_error(const char* reason) {
+  fprintf(stderr, "fatal error: malformed packed array (%s)\n", reason);
+  abort();
+}
+
+/// Returns the words of a packed array and its number of elements, after checking that its
+/// header is consistent with the size of its storage.
+///
+/// Packed arrays are arrays of integers that programs can modify, so their contents cannot be
+/// trusted. Returns `nullptr` if the array has no storage, in which case it is empty.
+static const uint64_t* get_packed_words(const mvs_AnyArray* array, int64_t* count) {
+  auto* header = get_array_header((mvs_AnyArray*)array);
+  if (header == nullptr) {
+    *count = 0;
+    return nullptr;
+  }
+
+  auto* words = static_cast<const uint64_t*>(array->payload);
+  int64_t size = header->count;
+  if (size < packed_header_size) { packed_array_error("missing header"); }
+  if ((int64_t)words[0] < 0) { packed_array_error("negative count"); }
+
+  int64_t blocks = ((int64_t)words[0] + packed_block_size - 1) / packed_block_size;
+  if ((int64_t)words[1] != blocks) { packed_array_error("invalid block count"); }
+  if (blocks > (size - packed_header_size) / packed_entry_size) {
+    packed_array_error("truncated directory");
+  }
+
+  *count = words[0];
+  return words;
+}
+
+/// Checks that the directory entry of the given block of a packed array of `size` words, which
+/// contains `count` elements, describes data within the array's storage.
+static void check_packed_block(const uint64_t* words, int64_t size, int64_t block,
+                               int64_t count) {
+  auto* entry = get_packed_entry(words, block);
+  uint64_t width = entry[2] & 0x7f;
+  uint64_t offset = entry[2] >> 8;
+  uint64_t start = packed_header_size + words[1] * packed_entry_size;
+  uint64_t length = ((count + packed_group_size - 1) / packed_group_size) * width;
+
+  if (width > 64) { packed_array_error("invalid width"); }
+  if ((offset < start) || (offset > (uint64_t)size) || (length > size - offset)) {
+    packed_array_error("invalid block offset");
+  }
+}
+
+extern "C" {
+
+/// Initializes an array with the packed representation of an array of integers.
+///
+/// The elements are split into blocks of 128, each encoded with the fewest bits per element
+/// using either frame of reference or delta encoding. A packed array is an array of words:
+///
+///     { count; block_count; directory: { base; step; width | mode << 7 | offset << 8 }[];
+///       data... }
+///
+/// where `offset` is the position of a block's data in the array.
+///
+/// - Parameters:
+///   - dst: A pointer to an uninitialized array structure.
+///   - src: A pointer to an array of integers.
+void mvs_packed_init(mvs_AnyArray* dst, const mvs_AnyArray* src) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_packed_init(%p, %p)\n", dst, src);
+#endif
+
+  auto* header = get_array_header((mvs_AnyArray*)src);
+  int64_t count = (header != nullptr) ? header->count : 0;
+  int64_t blocks = (count + packed_block_size - 1) / packed_block_size;
+  auto* values = static_cast<const int64_t*>(src->payload);
+
+  std::vector<uint64_t> directory(blocks * packed_entry_size);
+  std::vector<uint64_t> data;
+  for (int64_t b = 0; b < blocks; ++b) {
+    uint64_t* entry = &directory[b * packed_entry_size];
+    int64_t offset = packed_header_size + directory.size() + data.size();
+    encode_block(values + b * packed_block_size, get_block_count(count, b), entry, data);
+    entry[2] |= offset << 8;
+  }
+
+  mvs_array_init(dst, &int64_metatype, packed_header_size + directory.size() + data.size(),
+                 sizeof(int64_t));
+  auto* words = static_cast<uint64_t*>(dst->payload);
+  words[0] = count;
+  words[1] = blocks;
+  if (blocks > 0) {
+    memcpy(words + packed_header_size, directory.data(), directory.size() * sizeof(uint64_t));
+  }
+  if (!data.empty()) {
+    memcpy(words + packed_header_size + directory.size(), data.data(),
+           data.size() * sizeof(uint64_t));
+  }
+}
+
+/// Initializes an array with the elements of a packed array.
+///
+/// - Parameters:
+///   - dst: A pointer to an uninitialized array structure.
+///   - src: A pointer to a packed array.
+void mvs_packed_unpack(mvs_AnyArray* dst, const mvs_AnyArray* src) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_packed_unpack(%p, %p)\n", dst, src);
+#endif
+
+  int64_t count;
+  auto* words = get_packed_words(src, &count);
+  int64_t size = (words != nullptr) ? get_array_header((mvs_AnyArray*)src)->count : 0;
+  for (int64_t b = 0; b * packed_block_size < count; ++b) {
+    check_packed_block(words, size, b, get_block_count(count, b));
+  }
+  mvs_array_init(dst, &int64_metatype, count, sizeof(int64_t));
+
+  auto* values = static_cast<int64_t*>(dst->payload);
+  for (int64_t b = 0; b * packed_block_size < count; ++b) {
+    decode_block(words, b, get_block_count(count, b), values + b * packed_block_size);
+  }
+}
+
+/// Returns the number of elements in a packed array.
+int64_t mvs_packed_count(const mvs_AnyArray* array) {
+  int64_t count;
+  get_packed_words(array, &count);
+  return count;
+}
+
+/// Returns the element at the given position in a packed array.
+///
+/// Elements of blocks encoded with frame of reference are read directly. Blocks encoded with
+/// delta encoding are decoded up to the group containing the element.
+int64_t mvs_packed_get(const mvs_AnyArray* array, int64_t index) {
+  int64_t count;
+  auto* words = get_packed_words(array, &count);
+  if ((index < 0) || (index >= count)) {
+    fprintf(stderr, "fatal error: index %" PRId64 " out of range of packed array\n", index);
+    abort();
+  }
+
+  int64_t block = index / packed_block_size;
+  int64_t i = index % packed_block_size;
+  check_packed_block(
+    words, get_array_header((mvs_AnyArray*)array)->count, block, get_block_count(count, block));
+  auto* entry = get_packed_entry(words, block);
+  int64_t width = entry[2] & 0x7f;
+  const uint64_t* data = words + (entry[2] >> 8);
+
+  if (((entry[2] >> 7) & 1) == packed_mode_for) {
+    auto* group = data + (i / packed_group_size) * width;
+    return entry[0] + extract_bits(group, i % packed_group_size, width);
+  }
+
+  int64_t values[packed_block_size];
+  decode_block(words, block, i + 1, values);
+  return values[i];
+}
+
+/// Replaces the element at the given position in a packed array, and returns its former value.
+///
+/// The array's storage is uniquified first. The element is written in place if it fits in the
+/// width of its block. Otherwise, the block is decoded, modified and encoded again, and the data
+/// of the following blocks is moved if its size changed.
+int64_t mvs_packed_set(mvs_AnyArray* array, int64_t index, int64_t value) {
+#ifdef DEBUG
+  fprintf(stderr, "mvs_packed_set(%p, %lli, %lli)\n", array, index, value);
+#endif
+
+  int64_t count;
+  get_packed_words(array, &count);
+  if ((index < 0) || (index >= count)) {
+    fprintf(stderr, "fatal error: index %" PRId64 " out of range of packed array\n", index);
+    abort();
+  }
+
+  int64_t block = index / packed_block_size;
+  int64_t i = index % packed_block_size;
+  mvs_array_uniq(array, &int64_metatype);
+  auto* words = static_cast<uint64_t*>(array->payload);
+  check_packed_block(
+    words, get_array_header(array)->count, block, get_block_count(count, block));
+  auto* entry = (uint64_t*)get_packed_entry(words, block);
+  int64_t width = entry[2] & 0x7f;
+
+  // Write the element in place if possible.
+  if (((entry[2] >> 7) & 1) == packed_mode_for) {
+    uint64_t* group = words + (entry[2] >> 8) + (i / packed_group_size) * width;
+    int64_t former = entry[0] + extract_bits(group, i % packed_group_size, width);
+    uint64_t u = (uint64_t)value - entry[0];
+    if (u <= low_bits(width)) {
+      insert_bits(group, i % packed_group_size, width, u);
+      return former;
+    }
+  }
+
+  // Encode the block again.
+  int64_t n = get_block_count(count, block);
+  int64_t values[packed_block_size];
+  decode_block(words, block, n, values);
+  int64_t former = values[i];
+  values[i] = value;
+
+  uint64_t new_entry[packed_entry_size];
+  std::vector<uint64_t> data;
+  encode_block(values, n, new_entry, data);
+
+  int64_t offset = entry[2] >> 8;
+  int64_t old_size = ((n + packed_group_size - 1) / packed_group_size) * width;
+  int64_t delta = data.size() - old_size;
+  int64_t total = get_array_header(array)->count;
+
+  // Move the data of the following blocks.
+  if (delta != 0) {
+    if (delta > 0) {
+      reserve_unique(array, &int64_metatype, total + delta);
+      words = static_cast<uint64_t*>(array->payload);
+    }
+    memmove(words + offset + data.size(), words + offset + old_size,
+            (total - offset - old_size) * sizeof(uint64_t));
+    get_array_header(array)->count = total + delta;
+
+    int64_t blocks = words[1];
+    for (int64_t b = block + 1; b < blocks; ++b) {
+      auto* e = (uint64_t*)get_packed_entry(words, b);
+      e[2] = (e[2] & 0xff) | ((uint64_t)((e[2] >> 8) + delta) << 8);
+    }
+  }
+
+  entry = (uint64_t*)get_packed_entry(words, block);
+  entry[0] = new_entry[0];
+  entry[1] = new_entry[1];
+  entry[2] = new_entry[2] | ((uint64_t)offset << 8);
+  if (!data.empty()) { memcpy(words + offset, data.data(), data.size() * sizeof(uint64_t)); }
+  return former;
 }
 
 }
@@ -14,6 +14,10 @@ struct CaptureCollector: ExprVisitor {
     return [:]
   }
 
+  mutating func visit(_ expr: inout StringExpr) -> ExprResult {
+    return [:]
+  }
+
   mutating func visit(_ expr: inout ArrayExpr) -> ExprResult {
     var names: ExprResult = [:]
     for i in 0 ..< expr.elems.count {
@@ -94,3 +94,56 @@ public struct ParamDecl: Decl {
   }
 
 }
+
+/// A declaration of a function defined in another module.
+public struct FuncDecl: Decl {
+
+  public var range: SourceRange
+
+  public var type: Type?
+
+  /// The name of the function.
+  public var name: String
+
+  /// The parameters of the function.
+  public var params: [ParamDecl]
+
+  /// The signature of the function's return type.
+  public var output: Sign
+
+  /// The name of the symbol that defines the function, in the module that exports it.
+  public var symbol: String?
+
+  public init(name: String, params: [ParamDecl], output: Sign, range: SourceRange) {
+    self.name = name
+    self.params = params
+    self.output = output
+    self.range = range
+  }
+
+  public mutating func accept<V>(_ visitor: inout V) -> V.DeclResult where V: DeclVisitor {
+    visitor.visit(&self)
+  }
+
+}
+
+/// An import declaration.
+public struct ImportDecl: Decl {
+
+  public var range: SourceRange
+
+  public let type: Type? = nil
+
+  /// The name of the imported module.
+  public var name: String
+
+  public init(name: String, range: SourceRange) {
+    self.name = name
+    self.range = range
+  }
+
+  public mutating func accept<V>(_ visitor: inout V) -> V.DeclResult where V: DeclVisitor {
+    visitor.visit(&self)
+  }
+
+}
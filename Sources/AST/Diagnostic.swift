@@ -27,6 +27,9 @@ public struct Diagnostic {
     /// An error that does not prevent compilation.
     case warning
 
+    /// A report about an optimization decision.
+    case remark
+
     public var description: String {
       return rawValue
     }
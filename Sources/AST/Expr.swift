@@ -58,6 +58,27 @@ public struct FloatExpr: Expr {
 
 }
 
+/// A constant string literal.
+public struct StringExpr: Expr {
+
+  /// The value of the literal.
+  public var value: String
+
+  public var range: SourceRange
+
+  public let type: Type? = .string
+
+  public init(value: String, range: SourceRange) {
+    self.value = value
+    self.range = range
+  }
+
+  public mutating func accept<V>(_ visitor: inout V) -> V.ExprResult where V: ExprVisitor {
+    visitor.visit(&self)
+  }
+
+}
+
 /// An array literal.
 public struct ArrayExpr: Expr {
 
@@ -218,6 +239,7 @@ public struct OperExpr: Expr {
     case eq, ne
     case lt, le, ge, gt
     case add, sub, mul, div
+    case and, or, xor, shl, shr
 
     /// Returns the type of the operator overload given the type of its operands.
     ///
@@ -236,6 +258,11 @@ public struct OperExpr: Expr {
         return (operandType == .int) || (operandType == .float)
           ? .func(params: [operandType, operandType], output: operandType)
           : nil
+
+      case .and, .or, .xor, .shl, .shr:
+        return (operandType == .int)
+          ? .func(params: [operandType, operandType], output: operandType)
+          : nil
       }
     }
 
@@ -335,6 +362,9 @@ public struct FuncBindingExpr: Expr {
   /// The body of the expression.
   public var body: Expr
 
+  /// The name of the symbol under which the function is exported to other modules, if any.
+  public var symbol: String?
+
   public init(name: String, literal: FuncExpr, body: Expr, range: SourceRange) {
     self.name = name
     self.literal = literal
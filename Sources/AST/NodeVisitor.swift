@@ -6,6 +6,8 @@ public protocol DeclVisitor {
   mutating func visit(_ decl: inout StructDecl) -> DeclResult
   mutating func visit(_ decl: inout BindingDecl) -> DeclResult
   mutating func visit(_ decl: inout ParamDecl) -> DeclResult
+  mutating func visit(_ decl: inout FuncDecl) -> DeclResult
+  mutating func visit(_ decl: inout ImportDecl) -> DeclResult
 
 }
 
@@ -16,6 +18,7 @@ public protocol ExprVisitor {
 
   mutating func visit(_ expr: inout IntExpr) -> ExprResult
   mutating func visit(_ expr: inout FloatExpr) -> ExprResult
+  mutating func visit(_ expr: inout StringExpr) -> ExprResult
   mutating func visit(_ expr: inout ArrayExpr) -> ExprResult
   mutating func visit(_ expr: inout StructExpr) -> ExprResult
   mutating func visit(_ expr: inout FuncExpr) -> ExprResult
@@ -144,7 +144,7 @@ public struct ElemPath: Path {
     else { return false }
 
     guard let lIndex = index as? IntExpr,
-          let rIndex = index as? IntExpr
+          let rIndex = rPath.index as? IntExpr
     else { return false }
 
     return (lIndex.value == rIndex.value) && lBase.denotesSameLocation(as: rBase)
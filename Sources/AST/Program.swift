@@ -1,14 +1,27 @@
 /// A program.
+///
+/// A program may also denote a module, whose entry is a chain of function bindings that the
+/// module exports, ending with a placeholder expression.
 public struct Program{
 
+  /// The modules imported by the program.
+  public var imports: [ImportDecl]
+
   /// The struct definitions of the program.
   public var types: [StructDecl]
 
+  /// The functions declared by the program and defined in other modules.
+  public var funcs: [FuncDecl]
+
   /// The entry point of the program.
   public var entry: Expr
 
-  public init(types: [StructDecl], entry: Expr) {
+  public init(
+    imports: [ImportDecl] = [], types: [StructDecl], funcs: [FuncDecl] = [], entry: Expr
+  ) {
+    self.imports = imports
     self.types = types
+    self.funcs = funcs
     self.entry = entry
   }
 
@@ -7,6 +7,9 @@ public indirect enum Type: Hashable {
   /// The built-in floating point type (a.k.a. `Float`).
   case float
 
+  /// The built-in string type (a.k.a. `String`).
+  case string
+
   /// A (user-defined) struct type.
   case `struct`(name: String, props: [StructProp])
 
@@ -81,6 +84,7 @@ extension Type: CustomStringConvertible {
     switch self {
     case .int                 : return "Int"
     case .float               : return "Float"
+    case .string              : return "String"
     case .struct(let name, _) : return name
     case .array(let elem)     : return "[\(elem)]"
     case .inout(let base)     : return "&\(base)"
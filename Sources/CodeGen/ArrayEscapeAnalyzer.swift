@@ -8,6 +8,13 @@ struct ArrayEscapeAnalzyer: ExprVisitor {
   /// The name of the array binding to analyze.
   let name: String
 
+  /// Whether the array binding is captured by a closure.
+  private(set) var isCapturedByClosure = false
+
+  init(name: String) {
+    self.name = name
+  }
+
   mutating func visit(_ expr: inout IntExpr) -> Bool {
     return false
   }
@@ -16,6 +23,10 @@ struct ArrayEscapeAnalzyer: ExprVisitor {
     return false
   }
 
+  mutating func visit(_ expr: inout StringExpr) -> Bool {
+    return false
+  }
+
   mutating func visit(_ expr: inout ArrayExpr) -> Bool {
     for i in 0 ..< expr.elems.count {
       if expr.elems[i].accept(&self) {
@@ -38,7 +49,11 @@ struct ArrayEscapeAnalzyer: ExprVisitor {
 
   mutating func visit(_ expr: inout FuncExpr) -> Bool {
     let captures = expr.collectCaptures()
-    return captures[name] != nil
+    if captures[name] != nil {
+      isCapturedByClosure = true
+      return true
+    }
+    return false
   }
 
   mutating func visit(_ expr: inout CallExpr) -> Bool {
@@ -0,0 +1,43 @@
+import AST
+import Basic
+
+extension Diagnostic {
+
+  static func arrayNotStackPromoted(
+    name: String, reason: String, range: SourceRange
+  ) -> Diagnostic {
+    return Diagnostic(
+      range: range,
+      message: "array '\(name)' not stack-promoted: \(reason)",
+      level: .remark)
+  }
+
+  static func uniqNotHoisted(range: SourceRange) -> Diagnostic {
+    return Diagnostic(
+      range: range,
+      message: "uniq not hoisted: array uniquified on every iteration of the loop",
+      level: .remark)
+  }
+
+  static func copyNotElided(type: Type, range: SourceRange) -> Diagnostic {
+    return Diagnostic(
+      range: range,
+      message: "copy not elided: value of type '\(type)' is copied",
+      level: .remark)
+  }
+
+  static func existentialBoxedOutOfLine(type: Type, size: Int, range: SourceRange) -> Diagnostic {
+    return Diagnostic(
+      range: range,
+      message: "existential boxed out-of-line: value of type '\(type)' has \(size) bytes",
+      level: .remark)
+  }
+
+  static func closureCallNotDevirtualized(range: SourceRange) -> Diagnostic {
+    return Diagnostic(
+      range: range,
+      message: "call not devirtualized: callee is a closure value",
+      level: .remark)
+  }
+
+}
@@ -0,0 +1,340 @@
+import AST
+
+/// A summary of the side effects of a function.
+///
+/// Summaries are conservative: a flag that is unset guarantees the absence of the corresponding
+/// effect, whereas a flag that is set only indicates that the effect may occur.
+struct EffectSummary {
+
+  /// Whether the function may allocate or release heap memory, either directly or by copying and
+  /// dropping non-trivial values.
+  var allocates = false
+
+  /// The positions of the `inout` parameters that the function may write.
+  var writtenParams: Set<Int> = []
+
+  /// Whether the function may call closures or builtins whose effects are unknown.
+  var callsOpaqueFunctions = false
+
+  /// Whether the function may read memory that is reachable from its parameters but that is not
+  /// addressed by them directly (e.g., the payload of an array).
+  var readsIndirectMemory = false
+
+  /// Whether the function may not return, because it contains a loop or is recursive.
+  var mayNotReturn = false
+
+  /// Whether the function calls itself, which is how loops are typically written.
+  ///
+  /// Unlike the other effects, this property is not merged into the summaries of callers, nor
+  /// exported to other modules.
+  var isRecursive = false
+
+  /// Merges the effects of a call to a function with the given summary.
+  ///
+  /// - Parameters:
+  ///   - callee: The summary of the callee.
+  ///   - args: The arguments of the call.
+  ///   - params: The positions of the caller's `inout` parameters, indexed by name.
+  mutating func merge(callee: EffectSummary, args: [Expr], params: [String: Int]) {
+    allocates = allocates || callee.allocates
+    callsOpaqueFunctions = callsOpaqueFunctions || callee.callsOpaqueFunctions
+    readsIndirectMemory = readsIndirectMemory || callee.readsIndirectMemory
+    mayNotReturn = mayNotReturn || callee.mayNotReturn
+
+    for j in callee.writtenParams where j < args.count {
+      if let arg = args[j] as? InoutExpr,
+         let root = arg.path.root as? NamePath,
+         let i = params[root.name]
+      {
+        writtenParams.insert(i)
+      }
+    }
+  }
+
+}
+
+extension EffectSummary: Codable {
+
+  private enum CodingKeys: String, CodingKey {
+
+    case allocates, writtenParams, callsOpaqueFunctions, readsIndirectMemory, mayNotReturn
+
+  }
+
+  init(from decoder: Decoder) throws {
+    let container = try decoder.container(keyedBy: CodingKeys.self)
+    allocates = try container.decode(Bool.self, forKey: .allocates)
+    writtenParams = try container.decode(Set<Int>.self, forKey: .writtenParams)
+    callsOpaqueFunctions = try container.decode(Bool.self, forKey: .callsOpaqueFunctions)
+    readsIndirectMemory = try container.decode(Bool.self, forKey: .readsIndirectMemory)
+    mayNotReturn = try container.decode(Bool.self, forKey: .mayNotReturn)
+  }
+
+  func encode(to encoder: Encoder) throws {
+    // Parameters are sorted so that the encoding of a summary is deterministic.
+    var container = encoder.container(keyedBy: CodingKeys.self)
+    try container.encode(allocates, forKey: .allocates)
+    try container.encode(writtenParams.sorted(), forKey: .writtenParams)
+    try container.encode(callsOpaqueFunctions, forKey: .callsOpaqueFunctions)
+    try container.encode(readsIndirectMemory, forKey: .readsIndirectMemory)
+    try container.encode(mayNotReturn, forKey: .mayNotReturn)
+  }
+
+}
+
+/// An AST visitor that computes the effect summary of a function's body.
+///
+/// Calls to global functions are resolved with the summaries of their callees, which must have
+/// been computed beforehand. Recursive calls are assumed to have no other effect than possibly
+/// not returning; calls to any other function are treated as opaque.
+struct EffectAnalyzer: ExprVisitor {
+
+  typealias ExprResult = Void
+
+  /// The name of the function being analyzed, used to identify recursive calls.
+  let name: String?
+
+  /// The positions of the function's `inout` parameters, indexed by name.
+  let params: [String: Int]
+
+  /// The summaries of the global functions in scope, indexed by name.
+  let summaries: [String: EffectSummary]
+
+  /// The names of the bindings declared in the function's body, which shadow global symbols.
+  private var locals: Set<String> = []
+
+  /// The summary being computed.
+  private(set) var summary = EffectSummary()
+
+  init(literal: FuncExpr, name: String?, summaries: [String: EffectSummary]) {
+    self.name = name
+    self.summaries = summaries
+
+    var params: [String: Int] = [:]
+    for (i, param) in literal.params.enumerated() where param.type!.isInoutType {
+      params[param.name] = i
+    }
+    self.params = params
+    self.locals = Set(literal.params.map({ $0.name }))
+  }
+
+  /// Returns the effect summary of the given function literal.
+  static func summarize(
+    _ literal: FuncExpr, name: String?, summaries: [String: EffectSummary]
+  ) -> EffectSummary {
+    var analyzer = EffectAnalyzer(literal: literal, name: name, summaries: summaries)
+    var body = literal.body
+    body.accept(&analyzer)
+    return analyzer.summary
+  }
+
+  mutating func visit(_ expr: inout IntExpr) {}
+
+  mutating func visit(_ expr: inout FloatExpr) {}
+
+  mutating func visit(_ expr: inout StringExpr) {
+    // Only large strings are allocated out-of-line.
+    if expr.value.utf8.count > 15 {
+      summary.allocates = true
+    }
+  }
+
+  mutating func visit(_ expr: inout ArrayExpr) {
+    if !expr.elems.isEmpty {
+      summary.allocates = true
+    }
+    for i in 0 ..< expr.elems.count {
+      expr.elems[i].accept(&self)
+    }
+  }
+
+  mutating func visit(_ expr: inout StructExpr) {
+    if !expr.type!.isTrivial {
+      summary.allocates = true
+    }
+    for i in 0 ..< expr.args.count {
+      expr.args[i].accept(&self)
+    }
+  }
+
+  mutating func visit(_ expr: inout FuncExpr) {
+    // The function's body is emitted separately; only the creation of its environment matters.
+    if !expr.collectCaptures().isEmpty {
+      summary.allocates = true
+    }
+  }
+
+  mutating func visit(_ expr: inout CallExpr) {
+    if !expr.type!.isTrivial {
+      summary.allocates = true
+    }
+
+    if let path = expr.callee as? NamePath, !locals.contains(path.name) {
+      if path.name == name {
+        summary.mayNotReturn = true
+        summary.isRecursive = true
+      } else if let callee = summaries[path.name] {
+        summary.merge(callee: callee, args: expr.args, params: params)
+      } else {
+        summary.callsOpaqueFunctions = true
+      }
+    } else {
+      expr.callee.accept(&self)
+      summary.callsOpaqueFunctions = true
+    }
+
+    for i in 0 ..< expr.args.count {
+      // Constant lvalues are passed by reference, without any copy.
+      if let path = expr.args[i] as? NamePath, path.mutability == .let {
+        continue
+      }
+      expr.args[i].accept(&self)
+    }
+  }
+
+  mutating func visit(_ expr: inout InfixExpr) {
+    switch expr.lhs.type! {
+    case .int, .float:
+      break
+    case .any, .func:
+      // Equality is dispatched through value witnesses or closure thunks.
+      summary.callsOpaqueFunctions = true
+    default:
+      summary.readsIndirectMemory = true
+    }
+
+    visit(operand: &expr.lhs)
+    visit(operand: &expr.rhs)
+  }
+
+  mutating func visit(_ expr: inout OperExpr) {}
+
+  mutating func visit(_ expr: inout InoutExpr) {
+    visit(lvalue: expr.path)
+  }
+
+  mutating func visit(_ expr: inout BindingExpr) {
+    if !expr.decl.type!.isTrivial {
+      summary.allocates = true
+    }
+    expr.initializer.accept(&self)
+
+    let (isNew, _) = locals.insert(expr.decl.name)
+    expr.body.accept(&self)
+    if isNew { locals.remove(expr.decl.name) }
+  }
+
+  mutating func visit(_ expr: inout FuncBindingExpr) {
+    // Nested functions are emitted separately, and calls to them are treated as opaque.
+    let (isNew, _) = locals.insert(expr.name)
+    expr.body.accept(&self)
+    if isNew { locals.remove(expr.name) }
+  }
+
+  mutating func visit(_ expr: inout AssignExpr) {
+    if !expr.lvalue.type!.isTrivial {
+      summary.allocates = true
+    }
+    visit(lvalue: expr.lvalue)
+    expr.rvalue.accept(&self)
+    expr.body.accept(&self)
+  }
+
+  mutating func visit(_ expr: inout CondExpr) {
+    expr.cond.accept(&self)
+    expr.succ.accept(&self)
+    expr.fail.accept(&self)
+  }
+
+  mutating func visit(_ expr: inout WhileExpr) {
+    summary.mayNotReturn = true
+    expr.cond.accept(&self)
+    expr.body.accept(&self)
+    expr.tail.accept(&self)
+  }
+
+  mutating func visit(_ expr: inout CastExpr) {
+    if !expr.type!.isTrivial || !expr.value.type!.isTrivial {
+      // Casts from and to existentials box and unbox their payload.
+      summary.allocates = true
+    }
+    expr.value.accept(&self)
+  }
+
+  mutating func visit(_ expr: inout ErrorExpr) {}
+
+  mutating func visit(_ expr: inout NamePath) {
+    visit(rvalue: expr)
+  }
+
+  mutating func visit(_ expr: inout PropPath) {
+    visit(rvalue: expr)
+  }
+
+  mutating func visit(_ expr: inout ElemPath) {
+    visit(rvalue: expr)
+  }
+
+  /// Visits an operand that is compared without being copied.
+  private mutating func visit(operand: inout Expr) {
+    if let path = operand as? Path {
+      visit(base: path)
+    } else {
+      operand.accept(&self)
+    }
+  }
+
+  /// Visits a path that is loaded or copied.
+  private mutating func visit(rvalue path: Path) {
+    if !path.type!.isTrivial {
+      summary.allocates = true
+    }
+    visit(base: path)
+  }
+
+  /// Visits a path that is written or passed `inout`.
+  private mutating func visit(lvalue path: Path) {
+    if containsElemPath(path) {
+      // Writing an element may require the array's storage to be uniquified.
+      summary.allocates = true
+    }
+    if let root = path.root as? NamePath, let i = params[root.name] {
+      summary.writtenParams.insert(i)
+    }
+    visit(base: path)
+  }
+
+  /// Visits the components of a path, which are read without being copied.
+  private mutating func visit(base: Expr) {
+    switch base {
+    case is NamePath:
+      break
+
+    case let path as PropPath:
+      visit(base: path.base)
+
+    case let path as ElemPath:
+      summary.readsIndirectMemory = true
+      visit(base: path.base)
+      var index = path.index
+      index.accept(&self)
+
+    default:
+      var expr = base
+      expr.accept(&self)
+    }
+  }
+
+  /// Returns whether the given path contains an element access.
+  private func containsElemPath(_ expr: Expr) -> Bool {
+    switch expr {
+    case is ElemPath:
+      return true
+    case let path as PropPath:
+      return containsElemPath(path.base)
+    default:
+      return false
+    }
+  }
+
+}
@@ -102,6 +102,37 @@ struct Runtime {
     return fn
   }
 
+  /// The runtime's `array_retain_n(array, n)` function.
+  var arrayRetainN: Function {
+    if let fn = emitter.module.function(named: "mvs_array_retain_n") {
+      return fn
+    }
+
+    let ty = FunctionType([emitter.anyArrayType.ptr, IntType.int64], VoidType())
+    let fn = emitter.builder.addFunction("mvs_array_retain_n", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    fn.addAttribute(.readonly , to: .argument(0))
+    return fn
+  }
+
+  /// The runtime's `array_reinit(array, elem_type, count, stride)` function.
+  var arrayReinit: Function {
+    if let fn = emitter.module.function(named: "mvs_array_reinit") {
+      return fn
+    }
+
+    let ty = FunctionType(
+      [emitter.anyArrayType.ptr, emitter.metatypeType.ptr, IntType.int64, IntType.int64],
+      VoidType())
+    let fn = emitter.builder.addFunction("mvs_array_reinit", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    fn.addAttribute(.nocapture, to: .argument(1))
+    fn.addAttribute(.readonly , to: .argument(1))
+    return fn
+  }
+
   /// The runtime's `array_uniq(array_dst, elem_type)` function.
   var arrayUniq: Function {
     if let fn = emitter.module.function(named: "mvs_array_uniq") {
@@ -118,6 +149,345 @@ struct Runtime {
     return fn
   }
 
+  /// The runtime's `array_append(array, elem_type, elem)` function.
+  var arrayAppend: Function {
+    if let fn = emitter.module.function(named: "mvs_array_append") {
+      return fn
+    }
+
+    let ty = FunctionType(
+      [emitter.anyArrayType.ptr, emitter.metatypeType.ptr, voidPtr], IntType.int64)
+    let fn = emitter.builder.addFunction("mvs_array_append", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    for i in 0 ..< 3 {
+      fn.addAttribute(.nocapture, to: .argument(i))
+    }
+    fn.addAttribute(.readonly , to: .argument(1))
+    fn.addAttribute(.readonly , to: .argument(2))
+    return fn
+  }
+
+  /// The runtime's `array_pop_last(array, elem_type, dst)` function.
+  var arrayPopLast: Function {
+    if let fn = emitter.module.function(named: "mvs_array_pop_last") {
+      return fn
+    }
+
+    let ty = FunctionType(
+      [emitter.anyArrayType.ptr, emitter.metatypeType.ptr, voidPtr], VoidType())
+    let fn = emitter.builder.addFunction("mvs_array_pop_last", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    for i in 0 ..< 3 {
+      fn.addAttribute(.nocapture, to: .argument(i))
+    }
+    fn.addAttribute(.readonly , to: .argument(1))
+    return fn
+  }
+
+  /// The runtime's `array_push_front(array, elem_type, elem)` function.
+  var arrayPushFront: Function {
+    if let fn = emitter.module.function(named: "mvs_array_push_front") {
+      return fn
+    }
+
+    let ty = FunctionType(
+      [emitter.anyArrayType.ptr, emitter.metatypeType.ptr, voidPtr], IntType.int64)
+    let fn = emitter.builder.addFunction("mvs_array_push_front", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    for i in 0 ..< 3 {
+      fn.addAttribute(.nocapture, to: .argument(i))
+    }
+    fn.addAttribute(.readonly , to: .argument(1))
+    fn.addAttribute(.readonly , to: .argument(2))
+    return fn
+  }
+
+  /// The runtime's `array_pop_front(array, elem_type, dst)` function.
+  var arrayPopFront: Function {
+    if let fn = emitter.module.function(named: "mvs_array_pop_front") {
+      return fn
+    }
+
+    let ty = FunctionType(
+      [emitter.anyArrayType.ptr, emitter.metatypeType.ptr, voidPtr], VoidType())
+    let fn = emitter.builder.addFunction("mvs_array_pop_front", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    for i in 0 ..< 3 {
+      fn.addAttribute(.nocapture, to: .argument(i))
+    }
+    fn.addAttribute(.readonly , to: .argument(1))
+    return fn
+  }
+
+  /// The type of the comparison functions passed to the runtime's heap operations.
+  var lessFuncType: FunctionType {
+    return FunctionType([voidPtr, voidPtr, voidPtr], IntType.int64)
+  }
+
+  /// The runtime's `heap_push(array, elem_type, elem, less, context)` function.
+  var heapPush: Function {
+    if let fn = emitter.module.function(named: "mvs_heap_push") {
+      return fn
+    }
+
+    let ty = FunctionType(
+      [emitter.anyArrayType.ptr, emitter.metatypeType.ptr, voidPtr, lessFuncType.ptr, voidPtr],
+      IntType.int64)
+    let fn = emitter.builder.addFunction("mvs_heap_push", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    fn.addAttribute(.nocapture, to: .argument(1))
+    fn.addAttribute(.readonly , to: .argument(1))
+    fn.addAttribute(.nocapture, to: .argument(2))
+    fn.addAttribute(.readonly , to: .argument(2))
+    return fn
+  }
+
+  /// The runtime's `heap_pop(array, elem_type, dst, less, context)` function.
+  var heapPop: Function {
+    if let fn = emitter.module.function(named: "mvs_heap_pop") {
+      return fn
+    }
+
+    let ty = FunctionType(
+      [emitter.anyArrayType.ptr, emitter.metatypeType.ptr, voidPtr, lessFuncType.ptr, voidPtr],
+      VoidType())
+    let fn = emitter.builder.addFunction("mvs_heap_pop", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    fn.addAttribute(.nocapture, to: .argument(1))
+    fn.addAttribute(.readonly , to: .argument(1))
+    fn.addAttribute(.nocapture, to: .argument(2))
+    return fn
+  }
+
+  /// The runtime's `array_copy_range(dst, elem_type, at, src, start, end)` function.
+  var arrayCopyRange: Function {
+    if let fn = emitter.module.function(named: "mvs_array_copy_range") {
+      return fn
+    }
+
+    let ty = FunctionType(
+      [
+        emitter.anyArrayType.ptr, emitter.metatypeType.ptr, IntType.int64,
+        emitter.anyArrayType.ptr, IntType.int64, IntType.int64,
+      ],
+      IntType.int64)
+    let fn = emitter.builder.addFunction("mvs_array_copy_range", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    fn.addAttribute(.nocapture, to: .argument(1))
+    fn.addAttribute(.readonly , to: .argument(1))
+    fn.addAttribute(.nocapture, to: .argument(3))
+    return fn
+  }
+
+  /// The runtime's `array_fill(array, elem_type, start, end, elem)` function.
+  var arrayFill: Function {
+    if let fn = emitter.module.function(named: "mvs_array_fill") {
+      return fn
+    }
+
+    let ty = FunctionType(
+      [emitter.anyArrayType.ptr, emitter.metatypeType.ptr, IntType.int64, IntType.int64, voidPtr],
+      IntType.int64)
+    let fn = emitter.builder.addFunction("mvs_array_fill", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    fn.addAttribute(.nocapture, to: .argument(1))
+    fn.addAttribute(.readonly , to: .argument(1))
+    fn.addAttribute(.nocapture, to: .argument(4))
+    fn.addAttribute(.readonly , to: .argument(4))
+    return fn
+  }
+
+  /// The runtime's `array_reverse(array, elem_type, start, end)` function.
+  var arrayReverse: Function {
+    if let fn = emitter.module.function(named: "mvs_array_reverse") {
+      return fn
+    }
+
+    let ty = FunctionType(
+      [emitter.anyArrayType.ptr, emitter.metatypeType.ptr, IntType.int64, IntType.int64],
+      IntType.int64)
+    let fn = emitter.builder.addFunction("mvs_array_reverse", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    fn.addAttribute(.nocapture, to: .argument(1))
+    fn.addAttribute(.readonly , to: .argument(1))
+    return fn
+  }
+
+  /// The runtime's `array_concat(dst, elem_type, lhs, rhs)` function.
+  var arrayConcat: Function {
+    if let fn = emitter.module.function(named: "mvs_array_concat") {
+      return fn
+    }
+
+    let ty = FunctionType(
+      [
+        emitter.anyArrayType.ptr, emitter.metatypeType.ptr,
+        emitter.anyArrayType.ptr, emitter.anyArrayType.ptr,
+      ],
+      VoidType())
+    let fn = emitter.builder.addFunction("mvs_array_concat", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    for i in 0 ..< 4 {
+      fn.addAttribute(.nocapture, to: .argument(i))
+    }
+    fn.addAttribute(.readonly , to: .argument(1))
+    return fn
+  }
+
+  /// The runtime's `array_repeating(array, elem_type, elem, count)` function.
+  var arrayRepeating: Function {
+    if let fn = emitter.module.function(named: "mvs_array_repeating") {
+      return fn
+    }
+
+    let ty = FunctionType(
+      [emitter.anyArrayType.ptr, emitter.metatypeType.ptr, voidPtr, IntType.int64],
+      VoidType())
+    let fn = emitter.builder.addFunction("mvs_array_repeating", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    for i in 0 ..< 3 {
+      fn.addAttribute(.nocapture, to: .argument(i))
+    }
+    fn.addAttribute(.readonly , to: .argument(1))
+    fn.addAttribute(.readonly , to: .argument(2))
+    return fn
+  }
+
+  /// The runtime's `array_spill(array, elem_type)` function.
+  var arraySpill: Function {
+    if let fn = emitter.module.function(named: "mvs_array_spill") {
+      return fn
+    }
+
+    let ty = FunctionType([emitter.anyArrayType.ptr, emitter.metatypeType.ptr], IntType.int64)
+    let fn = emitter.builder.addFunction("mvs_array_spill", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    fn.addAttribute(.nocapture, to: .argument(1))
+    fn.addAttribute(.readonly , to: .argument(1))
+    return fn
+  }
+
+  /// The runtime's `array_advise(array, pattern)` function.
+  var arrayAdvise: Function {
+    if let fn = emitter.module.function(named: "mvs_array_advise") {
+      return fn
+    }
+
+    let ty = FunctionType([emitter.anyArrayType.ptr, IntType.int64], IntType.int64)
+    let fn = emitter.builder.addFunction("mvs_array_advise", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    return fn
+  }
+
+  /// The runtime's `packed_init(dst, src)` function.
+  var packedInit: Function {
+    return packedConversionFunction(named: "mvs_packed_init")
+  }
+
+  /// The runtime's `packed_unpack(dst, src)` function.
+  var packedUnpack: Function {
+    return packedConversionFunction(named: "mvs_packed_unpack")
+  }
+
+  /// The runtime's `packed_count(array)` function.
+  ///
+  /// The function aborts if the array is malformed, so it is not `readonly`, lest unused calls be
+  /// removed.
+  var packedCount: Function {
+    if let fn = emitter.module.function(named: "mvs_packed_count") {
+      return fn
+    }
+
+    let ty = FunctionType([emitter.anyArrayType.ptr], IntType.int64)
+    let fn = emitter.builder.addFunction("mvs_packed_count", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    fn.addAttribute(.readonly , to: .argument(0))
+    return fn
+  }
+
+  /// The runtime's `packed_get(array, index)` function.
+  ///
+  /// The function aborts if the array is malformed or if the index is out of range, so it is not
+  /// `readonly`, lest unused calls be removed.
+  var packedGet: Function {
+    if let fn = emitter.module.function(named: "mvs_packed_get") {
+      return fn
+    }
+
+    let ty = FunctionType([emitter.anyArrayType.ptr, IntType.int64], IntType.int64)
+    let fn = emitter.builder.addFunction("mvs_packed_get", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    fn.addAttribute(.readonly , to: .argument(0))
+    return fn
+  }
+
+  /// The runtime's `packed_set(array, index, value)` function.
+  var packedSet: Function {
+    if let fn = emitter.module.function(named: "mvs_packed_set") {
+      return fn
+    }
+
+    let ty = FunctionType(
+      [emitter.anyArrayType.ptr, IntType.int64, IntType.int64], IntType.int64)
+    let fn = emitter.builder.addFunction("mvs_packed_set", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    return fn
+  }
+
+  /// Returns a runtime function that reads the array at its second argument and writes a new
+  /// array to its first one.
+  private func packedConversionFunction(named name: String) -> Function {
+    if let fn = emitter.module.function(named: name) {
+      return fn
+    }
+
+    let arrayPtr = emitter.anyArrayType.ptr
+    let fn = emitter.builder.addFunction(name, type: FunctionType([arrayPtr, arrayPtr], VoidType()))
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    fn.addAttribute(.nocapture, to: .argument(1))
+    fn.addAttribute(.readonly , to: .argument(1))
+    return fn
+  }
+
+  /// The type of the functions passed to the runtime's executor, which apply a closure to the
+  /// value at their second argument and write the result to their first one.
+  var applyFuncType: FunctionType {
+    return FunctionType([voidPtr, voidPtr, voidPtr], VoidType())
+  }
+
+  /// The runtime's `scatter(dst, result_type, src, arg_type, apply, closure)` function.
+  var scatter: Function {
+    if let fn = emitter.module.function(named: "mvs_scatter") {
+      return fn
+    }
+
+    let ty = FunctionType(
+      [
+        emitter.anyArrayType.ptr, emitter.metatypeType.ptr,
+        emitter.anyArrayType.ptr, emitter.metatypeType.ptr,
+        applyFuncType.ptr, voidPtr,
+      ],
+      VoidType())
+    let fn = emitter.builder.addFunction("mvs_scatter", type: ty)
+    for i in 0 ..< 4 {
+      fn.addAttribute(.nocapture, to: .argument(i))
+    }
+    fn.addAttribute(.readonly , to: .argument(1))
+    fn.addAttribute(.readonly , to: .argument(3))
+    return fn
+  }
+
   /// The runtime's `array_equal(lhs, rhs, elem_type)` function.
   var arrayEqual: Function {
     if let fn = emitter.module.function(named: "mvs_array_equal") {
@@ -182,6 +552,145 @@ struct Runtime {
     return fn
   }
 
+  /// The runtime's `string_init(string, bytes, count)` function.
+  var stringInit: Function {
+    if let fn = emitter.module.function(named: "mvs_string_init") {
+      return fn
+    }
+
+    let ty = FunctionType([emitter.stringType.ptr, voidPtr, IntType.int64], VoidType())
+    let fn = emitter.builder.addFunction("mvs_string_init", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    fn.addAttribute(.nocapture, to: .argument(1))
+    fn.addAttribute(.readonly , to: .argument(1))
+    return fn
+  }
+
+  /// The runtime's `string_drop(string)` function.
+  var stringDrop: Function {
+    if let fn = emitter.module.function(named: "mvs_string_drop") {
+      return fn
+    }
+
+    let ty = FunctionType([emitter.stringType.ptr], VoidType())
+    let fn = emitter.builder.addFunction("mvs_string_drop", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    return fn
+  }
+
+  /// The runtime's `string_copy(dst, src)` function.
+  var stringCopy: Function {
+    if let fn = emitter.module.function(named: "mvs_string_copy") {
+      return fn
+    }
+
+    let stringPtr = emitter.stringType.ptr
+    let ty = FunctionType([stringPtr, stringPtr], VoidType())
+    let fn = emitter.builder.addFunction("mvs_string_copy", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    fn.addAttribute(.nocapture, to: .argument(1))
+    fn.addAttribute(.readonly , to: .argument(1))
+    return fn
+  }
+
+  /// The runtime's `string_equal(lhs, rhs)` function.
+  var stringEqual: Function {
+    return readonlyStringFunction(named: "mvs_string_equal", argumentCount: 2)
+  }
+
+  /// The runtime's `string_count(string)` function.
+  var stringCount: Function {
+    return readonlyStringFunction(named: "mvs_string_count", argumentCount: 1)
+  }
+
+  /// The runtime's `string_hash(string)` function.
+  var stringHash: Function {
+    return readonlyStringFunction(named: "mvs_string_hash", argumentCount: 1)
+  }
+
+  /// The runtime's `string_find(string, needle)` function.
+  var stringFind: Function {
+    return readonlyStringFunction(named: "mvs_string_find", argumentCount: 2)
+  }
+
+  /// The runtime's `string_byte(string, index)` function.
+  var stringByte: Function {
+    if let fn = emitter.module.function(named: "mvs_string_byte") {
+      return fn
+    }
+
+    let ty = FunctionType([emitter.stringType.ptr, IntType.int64], IntType.int64)
+    let fn = emitter.builder.addFunction("mvs_string_byte", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.readonly , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    return fn
+  }
+
+  /// The runtime's `string_slice(dst, src, start, end)` function.
+  var stringSlice: Function {
+    if let fn = emitter.module.function(named: "mvs_string_slice") {
+      return fn
+    }
+
+    let stringPtr = emitter.stringType.ptr
+    let ty = FunctionType([stringPtr, stringPtr, IntType.int64, IntType.int64], VoidType())
+    let fn = emitter.builder.addFunction("mvs_string_slice", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.nocapture, to: .argument(0))
+    fn.addAttribute(.nocapture, to: .argument(1))
+    fn.addAttribute(.readonly , to: .argument(1))
+    return fn
+  }
+
+  /// The runtime's `string_concat(dst, lhs, rhs)` function.
+  var stringConcat: Function {
+    if let fn = emitter.module.function(named: "mvs_string_concat") {
+      return fn
+    }
+
+    let stringPtr = emitter.stringType.ptr
+    let ty = FunctionType([stringPtr, stringPtr, stringPtr], VoidType())
+    let fn = emitter.builder.addFunction("mvs_string_concat", type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    for i in 0 ..< 3 {
+      fn.addAttribute(.nocapture, to: .argument(i))
+    }
+    fn.addAttribute(.readonly , to: .argument(1))
+    fn.addAttribute(.readonly , to: .argument(2))
+    return fn
+  }
+
+  /// The runtime's `print_string` function.
+  var printString: Function {
+    if let fn = emitter.module.function(named: "mvs_print_string") {
+      return fn
+    }
+
+    let ty = FunctionType([emitter.stringType.ptr], VoidType())
+    return emitter.builder.addFunction("mvs_print_string", type: ty)
+  }
+
+  /// Returns a runtime function that reads the strings passed as arguments and returns an integer.
+  private func readonlyStringFunction(named name: String, argumentCount: Int) -> Function {
+    if let fn = emitter.module.function(named: name) {
+      return fn
+    }
+
+    let ty = FunctionType(
+      Array(repeating: emitter.stringType.ptr, count: argumentCount), IntType.int64)
+    let fn = emitter.builder.addFunction(name, type: ty)
+    fn.addAttribute(.nounwind , to: .function)
+    fn.addAttribute(.readonly , to: .function)
+    for i in 0 ..< argumentCount {
+      fn.addAttribute(.nocapture, to: .argument(i))
+    }
+    return fn
+  }
+
   /// The runtime's `sqrt` function.
   var sqrt: Function {
     if let fn = emitter.module.function(named: "mvs_sqrt") {
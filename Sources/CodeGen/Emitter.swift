@@ -15,6 +15,17 @@ public struct Emitter: ExprVisitor, PathVisitor {
   /// an rvalue.
   public typealias PathValueOrigin = (value: IRValue, type: Type)
 
+  /// A value known at compile-time, used to specialize functions at call sites.
+  struct ConstantArg {
+
+    /// The LLVM constant.
+    let value: IRValue
+
+    /// A textual description of the value, used to identify specialized clones.
+    let description: String
+
+  }
+
   /// The machine target for the generated IR.
   public let target: TargetMachine
 
@@ -27,6 +38,12 @@ public struct Emitter: ExprVisitor, PathVisitor {
   /// The maximum size allowed for stack-allocated arrays.
   public let maxStackArraySize: Int
 
+  /// The maximum number of instructions that call-site specialization may add to the module.
+  public let specializationBudget: Int
+
+  /// The statistics collected while generating code.
+  public let statistics = EmitterStatistics()
+
   /// The builder that is used to generate LLVM IR instructions.
   var builder: IRBuilder!
 
@@ -42,6 +59,51 @@ public struct Emitter: ExprVisitor, PathVisitor {
   /// The local bindings.
   var bindings: [String: IRValue] = [:]
 
+  /// The values of the local bindings that are known to be compile-time constants.
+  var constants: [String: ConstantArg] = [:]
+
+  /// The stack slots whose scope has ended and that can be reused, indexed by function name.
+  var allocaPool: [String: [(type: IRType, alloca: IRValue)]] = [:]
+
+  /// The source ranges of the bindings that can move the value of a parameter owned by the
+  /// in-place function being emitted, rather than copying it.
+  var movableBindings: Set<SourceRange> = []
+
+  /// The parameter owned by the in-place function being emitted, the LLVM function of which it is
+  /// a variant, and the source ranges of the expressions in tail position that can build their
+  /// value in the parameter's storage.
+  var reusableTails: (param: String, position: Int, function: String, ranges: Set<SourceRange>)?
+
+  /// The number of loops enclosing the code being emitted in the current function, including the
+  /// loop formed by the function itself if it is recursive.
+  var loopDepth = 0
+
+  /// The literals of global functions, together with the bindings visible from their definition,
+  /// indexed by the name of their LLVM function.
+  ///
+  /// These are used to emit clones of global functions specialized for constant arguments.
+  var functionTemplates: [String: (literal: FuncExpr, bindings: [String: IRValue])] = [:]
+
+  /// The number of instructions emitted for the body of each global function, excluding the
+  /// clones specialized while emitting it, indexed by the name of its LLVM function.
+  ///
+  /// A function has no cost until its body has been completely emitted. Clones are charged the
+  /// cost of the function from which they are specialized.
+  var templateCosts: [String: Int] = [:]
+
+  /// The cost of the clones being emitted, which is charged to the budget before their nested
+  /// clones are.
+  var pendingSpecializationCost = 0
+
+  /// The effect summaries of global functions, indexed by the name of their LLVM function.
+  var effects: [String: EffectSummary] = [:]
+
+  /// The summaries of the functions defined in other modules, indexed by symbol.
+  public var importedSummaries: [String: FunctionSummary] = [:]
+
+  /// The summaries of the functions exported by the last emitted module, indexed by symbol.
+  public private(set) var exportedSummaries: [String: FunctionSummary] = [:]
+
   /// The metatypes of user-defined structures.
   var metatypes: [String: Global] = [:]
 
@@ -61,7 +123,8 @@ public struct Emitter: ExprVisitor, PathVisitor {
   ///
   /// A metatype is a data structure that contains information about the runtime representation of
   /// of a type. In particular, it provides a type-erased interface to initialize, deallocate and
-  /// copy instances of the type.
+  /// copy instances of the type, and describes their layout so that the runtime can serialize
+  /// them.
   var metatypeType: StructType {
     if let type = module.type(named: "_Metatype") {
       return type as! StructType
@@ -79,6 +142,25 @@ public struct Emitter: ExprVisitor, PathVisitor {
         anyCopyFuncType.ptr,
         // The type-erased equality function for instances of the type.
         anyEqualityFuncType.ptr,
+        // The kind of the type's representation (see `MetatypeKind`).
+        IntType.int64,
+        // The element metatype of an array type, or the field table of a non-trivial struct.
+        voidPtr,
+      ])
+  }
+
+  /// The (lowered) type of an entry in the field table of a struct's metatype.
+  var fieldLayoutType: StructType {
+    if let type = module.type(named: "_Field") {
+      return type as! StructType
+    }
+    return builder.createStruct(
+      name : "_Field",
+      types: [
+        // The offset of the field, in bytes.
+        IntType.int64,
+        // The metatype of the field, or `null` to mark the end of the table.
+        metatypeType.ptr,
       ])
   }
 
@@ -111,11 +193,8 @@ public struct Emitter: ExprVisitor, PathVisitor {
     }
 
     let type = builder.createStruct(name : "_AnyClosure")
-    type.setBody([
-      // The function pointer.
-      voidPtr,
-      // The environment pointer.
-      voidPtr,
+    let vtable = builder.createStruct(name : "_ClosureVTable")
+    vtable.setBody([
       // The copy function.
       FunctionType([type.ptr, type.ptr], VoidType()).ptr,
       // The drop function.
@@ -123,10 +202,27 @@ public struct Emitter: ExprVisitor, PathVisitor {
       // The equality function.
       FunctionType([type.ptr, type.ptr], IntType.int64).ptr,
     ])
+    type.setBody([
+      // The function pointer.
+      voidPtr,
+      // The environment pointer.
+      voidPtr,
+      // The value witness table.
+      vtable.ptr,
+    ])
 
     return type
   }
 
+  /// The (lowered) type of a closure's value witness table.
+  ///
+  /// The table is a constant global, shared by all closures whose environments have the same
+  /// layout, that contains the functions to copy, drop and compare instances of these closures.
+  var closureVTableType: StructType {
+    _ = anyClosureType
+    return module.type(named: "_ClosureVTable") as! StructType
+  }
+
   /// The (lowered) type of a type-erased array.
   var anyArrayType: StructType {
     if let type = module.type(named: "_AnyArray") {
@@ -135,6 +231,17 @@ public struct Emitter: ExprVisitor, PathVisitor {
     return builder.createStruct(name : "_AnyArray", types: [voidPtr])
   }
 
+  /// The (lowered) type of a string.
+  ///
+  /// Strings of at most 15 bytes are stored inline, with their count in the last byte; longer
+  /// strings hold a pointer to reference-counted storage and their count.
+  var stringType: StructType {
+    if let type = module.type(named: "_String") {
+      return type as! StructType
+    }
+    return builder.createStruct(name: "_String", types: [IntType.int64, IntType.int64])
+  }
+
   /// LLVM's `memset` intrinsic (i.e., `llvm.memset.p0i8.i64`).
   var memset: Intrinsic {
     return module.intrinsic(
@@ -149,6 +256,41 @@ public struct Emitter: ExprVisitor, PathVisitor {
       parameters: [voidPtr, voidPtr, IntType.int64])!
   }
 
+  /// LLVM's `lifetime.start` intrinsic (i.e., `llvm.lifetime.start.p0i8`).
+  var lifetimeStart: Intrinsic {
+    return module.intrinsic(Intrinsic.ID.llvm_lifetime_start, parameters: [voidPtr])!
+  }
+
+  /// LLVM's `lifetime.end` intrinsic (i.e., `llvm.lifetime.end.p0i8`).
+  var lifetimeEnd: Intrinsic {
+    return module.intrinsic(Intrinsic.ID.llvm_lifetime_end, parameters: [voidPtr])!
+  }
+
+  /// LLVM's `ctpop` intrinsic (i.e., `llvm.ctpop.i64`).
+  var ctpop: Intrinsic {
+    return module.intrinsic(Intrinsic.ID.llvm_ctpop, parameters: [IntType.int64])!
+  }
+
+  /// LLVM's `ctlz` intrinsic (i.e., `llvm.ctlz.i64`).
+  var ctlz: Intrinsic {
+    return module.intrinsic(Intrinsic.ID.llvm_ctlz, parameters: [IntType.int64])!
+  }
+
+  /// LLVM's `cttz` intrinsic (i.e., `llvm.cttz.i64`).
+  var cttz: Intrinsic {
+    return module.intrinsic(Intrinsic.ID.llvm_cttz, parameters: [IntType.int64])!
+  }
+
+  /// LLVM's `fshl` intrinsic (i.e., `llvm.fshl.i64`).
+  var fshl: Intrinsic {
+    return module.intrinsic(Intrinsic.ID.llvm_fshl, parameters: [IntType.int64])!
+  }
+
+  /// LLVM's `fshr` intrinsic (i.e., `llvm.fshr.i64`).
+  var fshr: Intrinsic {
+    return module.intrinsic(Intrinsic.ID.llvm_fshr, parameters: [IntType.int64])!
+  }
+
   /// LLVM's `memmove` intrinsic (i.e., `llvm.memmove.p0i8.p0i8.i64`).
   var memmove: Intrinsic {
     return module.intrinsic(
@@ -164,16 +306,20 @@ public struct Emitter: ExprVisitor, PathVisitor {
   ///   - shouldEmitPrint: A Boolean value that indicates whether the emitter should generate a
   ///     print of the program’s value.
   ///   - maxStackArraySize: The maximum size for stack-allocated arrays.
+  ///   - specializationBudget: The maximum number of instructions that call-site specialization
+  ///     may add to the module.
   public init(
-    target            : TargetMachine? = nil,
-    mode              : EmitterMode = .debug,
-    shouldEmitPrint   : Bool = false,
-    maxStackArraySize : Int = 256
+    target              : TargetMachine? = nil,
+    mode                : EmitterMode = .debug,
+    shouldEmitPrint     : Bool = false,
+    maxStackArraySize   : Int = 256,
+    specializationBudget: Int = 2048
   ) throws {
     self.target = try target ?? TargetMachine()
     self.mode = mode
     self.shouldEmitPrint = shouldEmitPrint
     self.maxStackArraySize = maxStackArraySize
+    self.specializationBudget = specializationBudget
   }
 
   /// Emit the LLVM IR of the given program.
@@ -182,46 +328,7 @@ public struct Emitter: ExprVisitor, PathVisitor {
   ///   - program: The program for which LLVM IR is generated.
   ///   - name: The name of the module (default: `main`).
   public mutating func emit(program: inout Program, name: String = "main") throws -> Module {
-    builder = IRBuilder(module: Module(name: name))
-    bindings = [:]
-    metatypes = [:]
-    module.targetTriple = target.triple
-
-    // Emit all type declarations.
-    for decl in program.types {
-      guard case .struct(_, let props) = decl.type else { continue }
-
-      // Create the type.
-      let irType = builder.createStruct(
-        name : decl.name,
-        types: props.map({ lower($0.type) }))
-
-      // Emit the type's metatype.
-      assert(metatypes[decl.name] == nil)
-      metatypes[decl.name] = emit(metatypeFor: decl, irType: irType)
-    }
-
-    // Expose built-in functions.
-    var uptime = builder.addFunction("_uptime", type: buildFunctionType(from: [], to: .float))
-    uptime.linkage = .private
-    uptime.addAttribute(.alwaysinline, to: .function)
-    builder.positionAtEnd(of: uptime.appendBasicBlock(named: "entry"))
-    builder.buildRet(builder.buildCall(runtime.uptimeNanoseconds, args: []))
-    bindings["uptime"] = uptime
-
-    var sqrt = builder.addFunction("_sqrt", type: buildFunctionType(from: [.float], to: .float))
-    sqrt.linkage = .private
-    sqrt.addAttribute(.alwaysinline, to: .function)
-    builder.positionAtEnd(of: sqrt.appendBasicBlock(named: "entry"))
-    builder.buildRet(builder.buildCall(runtime.sqrt, args: [sqrt.parameters[0]]))
-    bindings["sqrt"] = sqrt
-
-    var imod = builder.addFunction("_imod", type: buildFunctionType(from: [.int, .int], to: .int))
-    imod.linkage = .private
-    imod.addAttribute(.alwaysinline, to: .function)
-    builder.positionAtEnd(of: imod.appendBasicBlock(named: "entry"))
-    builder.buildRet(builder.buildRem(imod.parameters[0], imod.parameters[1]))
-    bindings["imod"] = imod
+    emitPrologue(of: program, name: name)
 
     // Emit the program.
     let main  = builder.addFunction("main", type: FunctionType([], IntType.int32))
@@ -287,6 +394,38 @@ public struct Emitter: ExprVisitor, PathVisitor {
 
     builder.buildRet(IntType.int32.constant(0))
 
+    try finalize()
+    return module
+  }
+
+  /// Emit the LLVM IR of the given module.
+  ///
+  /// The functions whose binding has a `symbol` are exported under that name, and their summaries
+  /// are stored in `exportedSummaries`. The module has no entry point.
+  ///
+  /// - Parameters:
+  ///   - module: The module for which LLVM IR is generated. Its entry must be a chain of function
+  ///     bindings, as produced by `MVSParser.parse(module:knownStructs:diagConsumer:)`.
+  ///   - name: The name of the module.
+  public mutating func emit(module library: inout Program, name: String) throws -> Module {
+    emitPrologue(of: library, name: name)
+
+    // The functions are emitted while visiting the module's entry, from a private function that
+    // has no other use.
+    var initializer = builder.addFunction("_\(name).init", type: FunctionType([], VoidType()))
+    initializer.linkage = .private
+    builder.positionAtEnd(of: initializer.appendBasicBlock(named: "entry"))
+
+    let value = library.entry.accept(&self)
+    emit(drop: value, type: library.entry.type!)
+    builder.buildRetVoid()
+
+    try finalize()
+    return module
+  }
+
+  /// Verifies the module being emitted and optimizes it, depending on the emitter's mode.
+  private func finalize() throws {
     do {
       try module.verify()
     } catch {
@@ -304,14 +443,497 @@ public struct Emitter: ExprVisitor, PathVisitor {
     case .debug:
       break
     }
+  }
 
-    return module
+  /// Emits the declarations of a program or module: its types, the built-in functions, and the
+  /// functions it imports from other modules.
+  ///
+  /// - Parameters:
+  ///   - program: The program or module being emitted.
+  ///   - name: The name of the LLVM module.
+  private mutating func emitPrologue(of program: Program, name: String) {
+    builder = IRBuilder(module: Module(name: name))
+    bindings = [:]
+    constants = [:]
+    functionTemplates = [:]
+    allocaPool = [:]
+    effects = [:]
+    metatypes = [:]
+    exportedSummaries = [:]
+    module.targetTriple = target.triple
+
+    // Emit all type declarations.
+    for decl in program.types {
+      guard case .struct(_, let props) = decl.type else { continue }
+
+      // Create the type.
+      let irType = builder.createStruct(
+        name : decl.name,
+        types: props.map({ lower($0.type) }))
+
+      // Emit the type's metatype.
+      assert(metatypes[decl.name] == nil)
+      metatypes[decl.name] = emit(metatypeFor: decl, irType: irType)
+    }
+
+    // Describe the fields of each type, which may refer to types declared after it.
+    for decl in program.types {
+      guard let irType = module.type(named: decl.name) as? StructType else { continue }
+      emit(fieldTableFor: decl, irType: irType)
+    }
+
+    // Expose built-in functions.
+    var uptime = builder.addFunction("_uptime", type: buildFunctionType(from: [], to: .float))
+    uptime.linkage = .private
+    uptime.addAttribute(.alwaysinline, to: .function)
+    builder.positionAtEnd(of: uptime.appendBasicBlock(named: "entry"))
+    builder.buildRet(builder.buildCall(runtime.uptimeNanoseconds, args: []))
+    bindings["uptime"] = uptime
+
+    var sqrt = builder.addFunction("_sqrt", type: buildFunctionType(from: [.float], to: .float))
+    sqrt.linkage = .private
+    sqrt.addAttribute(.alwaysinline, to: .function)
+    builder.positionAtEnd(of: sqrt.appendBasicBlock(named: "entry"))
+    builder.buildRet(builder.buildCall(runtime.sqrt, args: [sqrt.parameters[0]]))
+    bindings["sqrt"] = sqrt
+    effects[sqrt.name] = EffectSummary()
+
+    var imod = builder.addFunction("_imod", type: buildFunctionType(from: [.int, .int], to: .int))
+    imod.linkage = .private
+    imod.addAttribute(.alwaysinline, to: .function)
+    builder.positionAtEnd(of: imod.appendBasicBlock(named: "entry"))
+    builder.buildRet(builder.buildRem(imod.parameters[0], imod.parameters[1]))
+    bindings["imod"] = imod
+    effects[imod.name] = EffectSummary()
+
+    emitBitBuiltins()
+    emitStringBuiltins()
+    emitPackedArrayBuiltins()
+
+    // Declare the functions defined in other modules.
+    for decl in program.funcs {
+      emit(importedFunction: decl)
+    }
+  }
+
+  /// Emits the built-in functions operating on the bits of integers.
+  ///
+  /// Each function is lowered to an LLVM intrinsic, which compiles to a single instruction on
+  /// targets that support it. `clz` and `ctz` return 64 when their argument is zero, and rotations
+  /// are performed modulo 64.
+  private mutating func emitBitBuiltins() {
+    let builtins: [(name: String, arity: Int, intrinsic: Intrinsic)] = [
+      ("popcount", 1, ctpop),
+      ("clz"     , 1, ctlz),
+      ("ctz"     , 1, cttz),
+      ("rotl"    , 2, fshl),
+      ("rotr"    , 2, fshr),
+    ]
+
+    for builtin in builtins {
+      let params = Array(repeating: Type.int, count: builtin.arity)
+      var fn = builder.addFunction(
+        "_" + builtin.name, type: buildFunctionType(from: params, to: .int))
+      fn.linkage = .private
+      fn.addAttribute(.alwaysinline, to: .function)
+      builder.positionAtEnd(of: fn.appendBasicBlock(named: "entry"))
+
+      let args: [IRValue]
+      switch builtin.name {
+      case "clz", "ctz":
+        // The result is defined for a zero argument.
+        args = [fn.parameters[0], IntType.int1.constant(0)]
+      case "rotl", "rotr":
+        // A rotation is a funnel shift of a value with itself.
+        args = [fn.parameters[0], fn.parameters[0], fn.parameters[1]]
+      default:
+        args = [fn.parameters[0]]
+      }
+      builder.buildRet(builder.buildCall(builtin.intrinsic, args: args))
+
+      bindings[builtin.name] = fn
+      effects[fn.name] = EffectSummary()
+    }
+  }
+
+  /// The names of the built-in functions whose type depends on that of their arguments.
+  ///
+  /// These functions are instantiated on demand by `emit(genericBuiltin:type:)`.
+  static let genericBuiltins: Set<String> = [
+    "append", "poplast", "pushfront", "popfront", "heappush", "heappop", "copyrange", "fill",
+    "reverse", "concat", "count", "repeating", "scatter", "spill", "advise",
+  ]
+
+  /// Returns whether the given name denotes a generic built-in function in the current scope.
+  private func isGenericBuiltin(_ name: String) -> Bool {
+    return (bindings[name] == nil) && Emitter.genericBuiltins.contains(name)
+  }
+
+  /// Returns the instance of a generic built-in function for the given type, emitting it if
+  /// necessary.
+  ///
+  /// Most generic built-in functions operate on an array passed `inout` as their first argument.
+  /// `pushfront` and `popfront` move the header of the array's storage rather than its elements,
+  /// so that the array can be used as a double-ended queue. `heappush` and `heappop` maintain a binary min-heap, ordered by the closure passed as their
+  /// last argument. Bulk operations on ranges are implemented by the runtime, which uniquifies the
+  /// array once and moves trivial elements with `memmove` or `memset`. `count` reads the header of
+  /// an array's storage inline, and `repeating` creates an array with a single allocation.
+  /// `scatter` applies a closure to each element of an array in worker processes. `spill` moves
+  /// the storage of an array to a scratch file, and `advise` sets the access pattern of such
+  /// storage.
+  ///
+  /// - Parameters:
+  ///   - name: The name of the built-in function.
+  ///   - type: The type of the instance.
+  private mutating func emit(genericBuiltin name: String, type: Type) -> Function {
+    guard case .func(let params, let output) = type else { unreachable() }
+    let elemType: Type
+    switch params[0] {
+    case let e where name == "repeating":
+      elemType = e
+    case .inout(base: .array(let e)), .array(let e):
+      elemType = e
+    case .func(params: let fnParams, output: _) where name == "scatter":
+      elemType = fnParams[0]
+    default:
+      unreachable()
+    }
+
+    let fnName = "_\(name)\(type.mangled)"
+    if let fn = module.function(named: fnName) {
+      return fn
+    }
+
+    // Save the builder's current insertion block to restore at the end.
+    let oldInsertBlock = builder.insertBlock
+    defer { oldInsertBlock.map(builder.positionAtEnd(of:)) }
+
+    var fn = builder.addFunction(fnName, type: buildFunctionType(from: params, to: output))
+    fn.linkage = .private
+    fn.addAttribute(.alwaysinline, to: .function)
+    builder.positionAtEnd(of: fn.appendBasicBlock(named: "entry"))
+
+    let args = output.isAddressOnly ? Array(fn.parameters.dropFirst()) : fn.parameters
+    let meta = metatype(of: elemType)
+
+    switch name {
+    case "append", "pushfront", "heappush":
+      // The runtime expects the inserted element by address.
+      var elem = args[1]
+      if !elemType.isAddressOnly {
+        elem = addEntryAlloca(type: lower(elemType))
+        builder.buildStore(args[1], to: elem)
+      }
+      elem = builder.buildBitCast(elem, type: voidPtr)
+
+      let count: IRValue
+      if name == "append" {
+        count = builder.buildCall(runtime.arrayAppend, args: [args[0], meta, elem])
+      } else if name == "pushfront" {
+        count = builder.buildCall(runtime.arrayPushFront, args: [args[0], meta, elem])
+      } else {
+        let less = emit(lessThunkFor: elemType)
+        let context = builder.buildBitCast(args[2], type: voidPtr)
+        count = builder.buildCall(runtime.heapPush, args: [args[0], meta, elem, less, context])
+      }
+      builder.buildRet(count)
+
+    case "poplast", "popfront", "heappop":
+      // The removed element is moved to the function's result.
+      let dst = output.isAddressOnly
+        ? fn.parameters[0]
+        : addEntryAlloca(type: lower(elemType))
+      let buf = builder.buildBitCast(dst, type: voidPtr)
+
+      if name == "poplast" {
+        _ = builder.buildCall(runtime.arrayPopLast, args: [args[0], meta, buf])
+      } else if name == "popfront" {
+        _ = builder.buildCall(runtime.arrayPopFront, args: [args[0], meta, buf])
+      } else {
+        let less = emit(lessThunkFor: elemType)
+        let context = builder.buildBitCast(args[1], type: voidPtr)
+        _ = builder.buildCall(runtime.heapPop, args: [args[0], meta, buf, less, context])
+      }
+
+      if output.isAddressOnly {
+        builder.buildRetVoid()
+      } else {
+        builder.buildRet(builder.buildLoad(dst, type: lower(elemType)))
+      }
+
+    case "copyrange":
+      let count = builder.buildCall(
+        runtime.arrayCopyRange, args: [args[0], meta, args[1], args[2], args[3], args[4]])
+      builder.buildRet(count)
+
+    case "fill":
+      // The runtime expects the element by address.
+      var elem = args[3]
+      if !elemType.isAddressOnly {
+        elem = addEntryAlloca(type: lower(elemType))
+        builder.buildStore(args[3], to: elem)
+      }
+      elem = builder.buildBitCast(elem, type: voidPtr)
+      let count = builder.buildCall(
+        runtime.arrayFill, args: [args[0], meta, args[1], args[2], elem])
+      builder.buildRet(count)
+
+    case "reverse":
+      let count = builder.buildCall(runtime.arrayReverse, args: [args[0], meta, args[1], args[2]])
+      builder.buildRet(count)
+
+    case "concat":
+      // The new array is written to the function's output parameter.
+      _ = builder.buildCall(runtime.arrayConcat, args: [fn.parameters[0], meta, args[0], args[1]])
+      builder.buildRetVoid()
+
+    case "count":
+      // Empty arrays have no storage. The count of the others is stored in the header preceding
+      // their payload, as its second to last 64-bit word.
+      var payload = builder.buildStructGEP(args[0], type: anyArrayType, index: 0)
+      payload = builder.buildLoad(payload, type: voidPtr)
+      let emptyBlock = fn.appendBasicBlock(named: "empty")
+      let headerBlock = fn.appendBasicBlock(named: "header")
+      builder.buildCondBr(
+        condition: builder.buildIsNull(payload), then: emptyBlock, else: headerBlock)
+
+      builder.positionAtEnd(of: emptyBlock)
+      builder.buildRet(i64(0))
+
+      builder.positionAtEnd(of: headerBlock)
+      let words = builder.buildBitCast(payload, type: IntType.int64.ptr)
+      let count = builder.buildInBoundsGEP(words, type: IntType.int64, indices: [i64(-2)])
+      builder.buildRet(builder.buildLoad(count, type: IntType.int64))
+
+    case "repeating":
+      // The runtime expects the element by address, and writes the new array to the function's
+      // output parameter.
+      var elem = args[0]
+      if !elemType.isAddressOnly {
+        elem = addEntryAlloca(type: lower(elemType))
+        builder.buildStore(args[0], to: elem)
+      }
+      elem = builder.buildBitCast(elem, type: voidPtr)
+      _ = builder.buildCall(
+        runtime.arrayRepeating, args: [fn.parameters[0], meta, elem, args[1]])
+      builder.buildRetVoid()
+
+    case "spill":
+      builder.buildRet(builder.buildCall(runtime.arraySpill, args: [args[0], meta]))
+
+    case "advise":
+      builder.buildRet(builder.buildCall(runtime.arrayAdvise, args: [args[0], args[1]]))
+
+    case "scatter":
+      // The runtime serializes the arguments and results with their metatypes, and applies the
+      // closure through a thunk that takes both by address.
+      guard case .array(let resultType) = output else { unreachable() }
+      let apply = emit(applyThunkFor: elemType, output: resultType)
+      let closure = builder.buildBitCast(args[0], type: voidPtr)
+      _ = builder.buildCall(
+        runtime.scatter,
+        args: [fn.parameters[0], metatype(of: resultType), args[1], meta, apply, closure])
+      builder.buildRetVoid()
+
+    default:
+      unreachable()
+    }
+
+    return fn
+  }
+
+  /// Returns a function that applies a comparison closure on two elements of the given type,
+  /// passed by address, with the signature expected by the runtime's heap operations.
+  ///
+  /// The closure is passed as the function's context.
+  private mutating func emit(lessThunkFor elemType: Type) -> Function {
+    let name = "_less\(elemType.mangled)"
+    if let fn = module.function(named: name) {
+      return fn
+    }
+
+    // Save the builder's current insertion block to restore at the end.
+    let oldInsertBlock = builder.insertBlock
+    defer { oldInsertBlock.map(builder.positionAtEnd(of:)) }
+
+    var fn = builder.addFunction(name, type: runtime.lessFuncType)
+    fn.linkage = .private
+    builder.positionAtEnd(of: fn.appendBasicBlock(named: "entry"))
+
+    // Load the operands, unless they must be passed by address.
+    let elemIRType = lower(elemType)
+    var operands: [IRValue] = []
+    for i in 0 ..< 2 {
+      let operand = builder.buildBitCast(fn.parameters[i], type: elemIRType.ptr)
+      operands.append(
+        elemType.isAddressOnly ? operand : builder.buildLoad(operand, type: elemIRType))
+    }
+
+    // Apply the closure.
+    let closure = builder.buildBitCast(fn.parameters[2], type: anyClosureType.ptr)
+    let fnType = buildFunctionType(from: [elemType, elemType], to: .int)
+    var callee = builder.buildStructGEP(closure, type: anyClosureType, index: 0)
+    callee = builder.buildLoad(callee, type: voidPtr)
+    callee = builder.buildBitCast(callee, type: fnType.ptr)
+    var env = builder.buildStructGEP(closure, type: anyClosureType, index: 1)
+    env = builder.buildLoad(env, type: voidPtr)
+    builder.buildRet(builder.buildCall(callee, args: operands + [env]))
+
+    return fn
+  }
+
+  /// Returns a function that applies a unary closure to an argument of the given type, with the
+  /// signature expected by the runtime's executor.
+  ///
+  /// The argument is passed by address, the result is written to uninitialized storage, and the
+  /// closure is passed as the function's context.
+  private mutating func emit(applyThunkFor paramType: Type, output: Type) -> Function {
+    let name = "_apply\(Type.func(params: [paramType], output: output).mangled)"
+    if let fn = module.function(named: name) {
+      return fn
+    }
+
+    // Save the builder's current insertion block to restore at the end.
+    let oldInsertBlock = builder.insertBlock
+    defer { oldInsertBlock.map(builder.positionAtEnd(of:)) }
+
+    var fn = builder.addFunction(name, type: runtime.applyFuncType)
+    fn.linkage = .private
+    builder.positionAtEnd(of: fn.appendBasicBlock(named: "entry"))
+
+    // Load the argument, unless it must be passed by address.
+    let paramIRType = lower(paramType)
+    var operand = builder.buildBitCast(fn.parameters[1], type: paramIRType.ptr)
+    if !paramType.isAddressOnly {
+      operand = builder.buildLoad(operand, type: paramIRType)
+    }
+
+    // Apply the closure.
+    let closure = builder.buildBitCast(fn.parameters[2], type: anyClosureType.ptr)
+    let fnType = buildFunctionType(from: [paramType], to: output)
+    var callee = builder.buildStructGEP(closure, type: anyClosureType, index: 0)
+    callee = builder.buildLoad(callee, type: voidPtr)
+    callee = builder.buildBitCast(callee, type: fnType.ptr)
+    var env = builder.buildStructGEP(closure, type: anyClosureType, index: 1)
+    env = builder.buildLoad(env, type: voidPtr)
+
+    let outputIRType = lower(output)
+    let dst = builder.buildBitCast(fn.parameters[0], type: outputIRType.ptr)
+    if output.isAddressOnly {
+      _ = builder.buildCall(callee, args: [dst, operand, env])
+    } else {
+      builder.buildStore(builder.buildCall(callee, args: [operand, env]), to: dst)
+    }
+    builder.buildRetVoid()
+
+    return fn
+  }
+
+  /// Emits the built-in functions operating on strings.
+  ///
+  /// Each function forwards its arguments to the runtime. Strings are passed by address, and the
+  /// string returned by `strslice` and `strcat` is written to the output parameter.
+  private mutating func emitStringBuiltins() {
+    emit(forwardingBuiltins: [
+      ("strlen"  , [.string]             , .int   , runtime.stringCount),
+      ("strbyte" , [.string, .int]       , .int   , runtime.stringByte),
+      ("strfind" , [.string, .string]    , .int   , runtime.stringFind),
+      ("strhash" , [.string]             , .int   , runtime.stringHash),
+      ("strslice", [.string, .int, .int] , .string, runtime.stringSlice),
+      ("strcat"  , [.string, .string]    , .string, runtime.stringConcat),
+    ])
+  }
+
+  /// Emits the built-in functions operating on packed integer arrays.
+  ///
+  /// A packed array is an ordinary `[Int]` whose elements hold the compressed representation of
+  /// another array, built by `pack` and decoded by `unpack`. Its elements are accessed in place
+  /// with `packedget` and `packedset`, which decode and re-encode a single block. All of them
+  /// abort on malformed input.
+  private mutating func emitPackedArrayBuiltins() {
+    let ints = Type.array(elem: .int)
+    emit(mayNotReturn: true, forwardingBuiltins: [
+      ("pack"       , [ints]                           , ints, runtime.packedInit),
+      ("unpack"     , [ints]                           , ints, runtime.packedUnpack),
+      ("packedcount", [ints]                           , .int, runtime.packedCount),
+      ("packedget"  , [ints, .int]                     , .int, runtime.packedGet),
+      ("packedset"  , [.inout(base: ints), .int, .int] , .int, runtime.packedSet),
+    ])
+  }
+
+  /// Emits built-in functions that forward all their arguments but the environment to a runtime
+  /// function.
+  ///
+  /// - Parameters:
+  ///   - mayNotReturn: Whether the runtime functions may abort rather than return.
+  ///   - builtins: The built-in functions to emit.
+  private mutating func emit(
+    mayNotReturn: Bool = false,
+    forwardingBuiltins builtins: [(name: String, params: [Type], output: Type, callee: Function)]
+  ) {
+    for builtin in builtins {
+      var fn = builder.addFunction(
+        "_" + builtin.name, type: buildFunctionType(from: builtin.params, to: builtin.output))
+      fn.linkage = .private
+      fn.addAttribute(.alwaysinline, to: .function)
+      builder.positionAtEnd(of: fn.appendBasicBlock(named: "entry"))
+
+      // Forward all parameters but the environment.
+      let args = Array(fn.parameters.dropLast())
+      if builtin.output.isAddressOnly {
+        _ = builder.buildCall(builtin.callee, args: args)
+        builder.buildRetVoid()
+      } else {
+        builder.buildRet(builder.buildCall(builtin.callee, args: args))
+      }
+
+      // Functions returning new values or mutating their arguments may allocate; the others only
+      // read the payloads of their arguments.
+      var summary = EffectSummary()
+      summary.mayNotReturn = mayNotReturn
+      if builtin.output.isAddressOnly {
+        summary.allocates = true
+      } else {
+        summary.readsIndirectMemory = true
+      }
+      for (i, param) in builtin.params.enumerated() where param.isInoutType {
+        summary.allocates = true
+        summary.writtenParams.insert(i)
+      }
+
+      bindings[builtin.name] = fn
+      effects[fn.name] = summary
+    }
   }
 
   // ----------------------------------------------------------------------------------------------
   // MARK: Metatypes
   // ----------------------------------------------------------------------------------------------
 
+  /// The kinds of type representations described by metatypes, which tell the runtime how to
+  /// serialize instances of a type. These must match `mvs_TypeKind` in the runtime.
+  private enum MetatypeKind: Int {
+
+    /// A type whose instances can be copied bitwise.
+    case trivial = 0
+
+    /// An array type, whose metatype refers to that of its elements.
+    case array
+
+    /// The `String` type.
+    case string
+
+    /// The `Any` type.
+    case existential
+
+    /// A function type.
+    case closure
+
+    /// A non-trivial struct type, whose metatype refers to a table describing its fields.
+    case `struct`
+
+  }
+
   /// The metatype of the built-in `Int` type.
   private var intMetatype: Global {
     // Check if we already build this metatype.
@@ -346,6 +968,8 @@ public struct Emitter: ExprVisitor, PathVisitor {
           anyDropFuncType.ptr.null(),
           anyCopyFuncType.ptr.null(),
           equalFn,
+          i64(MetatypeKind.trivial.rawValue),
+          voidPtr.null(),
         ]))
     metatype.linkage = .private
     return metatype
@@ -363,28 +987,98 @@ public struct Emitter: ExprVisitor, PathVisitor {
     defer { oldInsertBlock.map(builder.positionAtEnd(of:)) }
 
     // Create the type's equality function.
-    var equalFn = builder.addFunction("_Float.te_equal", type: anyEqualityFuncType)
+    var equalFn = builder.addFunction("_Float.te_equal", type: anyEqualityFuncType)
+    equalFn.linkage = .private
+    equalFn.addAttribute(.alwaysinline, to: .function)
+    equalFn.addAttribute(.argmemonly  , to: .function)
+    equalFn.addAttribute(.norecurse   , to: .function)
+
+    builder.positionAtEnd(of: equalFn.appendBasicBlock(named: "entry"))
+    var lhs = builder.buildBitCast(equalFn.parameters[0], type: FloatType.double.ptr)
+    lhs = builder.buildLoad(lhs, type: FloatType.double)
+    var rhs = builder.buildBitCast(equalFn.parameters[1], type: FloatType.double.ptr)
+    rhs = builder.buildLoad(rhs, type: FloatType.double)
+    builder.buildRet(zext(builder.buildFCmp(lhs, rhs, .orderedEqual)))
+
+    var metatype = builder.addGlobal(
+      "_Float.Type",
+      initializer: metatypeType.constant(
+        values: [
+          stride(of: IntType.int64),
+          anyInitFuncType.ptr.null(),
+          anyDropFuncType.ptr.null(),
+          anyCopyFuncType.ptr.null(),
+          equalFn,
+          i64(MetatypeKind.trivial.rawValue),
+          voidPtr.null(),
+        ]))
+    metatype.linkage = .private
+    return metatype
+  }
+
+  /// The metatype of the built-in `String` type.
+  private var stringMetatype: Global {
+    // Check if we already build this metatype.
+    if let global = module.global(named: "_String.Type") {
+      return global
+    }
+
+    // Save the builder's current insertion block to restore at the end.
+    let oldInsertBlock = builder.insertBlock
+    defer { oldInsertBlock.map(builder.positionAtEnd(of:)) }
+
+    // Create the type's zero-initializer.
+    var initFn = builder.addFunction("_String.te_init", type: anyInitFuncType)
+    initFn.linkage = .private
+    initFn.addAttribute(.alwaysinline , to: .function)
+    do {
+      builder.positionAtEnd(of: initFn.appendBasicBlock(named: "entry"))
+      let receiver = builder.buildBitCast(initFn.parameters[0], type: stringType.ptr)
+      builder.buildStore(stringType.null(), to: receiver)
+      builder.buildRetVoid()
+    }
+
+    // Create the type's destructor.
+    var dropFn = builder.addFunction("_String.te_drop", type: anyDropFuncType)
+    dropFn.linkage = .private
+    dropFn.addAttribute(.alwaysinline , to: .function)
+    do {
+      builder.positionAtEnd(of: dropFn.appendBasicBlock(named: "entry"))
+      let receiver = builder.buildBitCast(dropFn.parameters[0], type: stringType.ptr)
+      _ = builder.buildCall(runtime.stringDrop, args: [receiver])
+      builder.buildRetVoid()
+    }
+
+    // Create the type's copy function.
+    var copyFn = builder.addFunction("_String.te_copy", type: anyCopyFuncType)
+    copyFn.linkage = .private
+    copyFn.addAttribute(.alwaysinline , to: .function)
+    do {
+      builder.positionAtEnd(of: copyFn.appendBasicBlock(named: "entry"))
+      let lhs = builder.buildBitCast(copyFn.parameters[0], type: stringType.ptr)
+      let rhs = builder.buildBitCast(copyFn.parameters[1], type: stringType.ptr)
+      _ = builder.buildCall(runtime.stringCopy, args: [lhs, rhs])
+      builder.buildRetVoid()
+    }
+
+    // Create the type's equality function.
+    var equalFn = builder.addFunction("_String.te_equal", type: anyEqualityFuncType)
     equalFn.linkage = .private
-    equalFn.addAttribute(.alwaysinline, to: .function)
-    equalFn.addAttribute(.argmemonly  , to: .function)
-    equalFn.addAttribute(.norecurse   , to: .function)
-
-    builder.positionAtEnd(of: equalFn.appendBasicBlock(named: "entry"))
-    var lhs = builder.buildBitCast(equalFn.parameters[0], type: FloatType.double.ptr)
-    lhs = builder.buildLoad(lhs, type: FloatType.double)
-    var rhs = builder.buildBitCast(equalFn.parameters[1], type: FloatType.double.ptr)
-    rhs = builder.buildLoad(rhs, type: FloatType.double)
-    builder.buildRet(zext(builder.buildFCmp(lhs, rhs, .orderedEqual)))
+    equalFn.addAttribute(.alwaysinline , to: .function)
+    do {
+      builder.positionAtEnd(of: equalFn.appendBasicBlock(named: "entry"))
+      let lhs = builder.buildBitCast(equalFn.parameters[0], type: stringType.ptr)
+      let rhs = builder.buildBitCast(equalFn.parameters[1], type: stringType.ptr)
+      builder.buildRet(builder.buildCall(runtime.stringEqual, args: [lhs, rhs]))
+    }
 
+    // Create the metatype.
     var metatype = builder.addGlobal(
-      "_Float.Type",
+      "_String.Type",
       initializer: metatypeType.constant(
         values: [
-          stride(of: IntType.int64),
-          anyInitFuncType.ptr.null(),
-          anyDropFuncType.ptr.null(),
-          anyCopyFuncType.ptr.null(),
-          equalFn,
+          stride(of: stringType), initFn, dropFn, copyFn, equalFn,
+          i64(MetatypeKind.string.rawValue), voidPtr.null(),
         ]))
     metatype.linkage = .private
     return metatype
@@ -453,7 +1147,10 @@ public struct Emitter: ExprVisitor, PathVisitor {
     var metatype = builder.addGlobal(
       "_Existential.Type",
       initializer: metatypeType.constant(
-        values: [stride(of: anyClosureType), initFn, dropFn, copyFn, equalFn]))
+        values: [
+          stride(of: existentialType), initFn, dropFn, copyFn, equalFn,
+          i64(MetatypeKind.existential.rawValue), voidPtr.null(),
+        ]))
     metatype.linkage = .private
     return metatype
   }
@@ -488,10 +1185,7 @@ public struct Emitter: ExprVisitor, PathVisitor {
     dropFn.addAttribute(.alwaysinline , to: .function)
     do {
       builder.positionAtEnd(of: dropFn.appendBasicBlock(named: "entry"))
-      let receiver = builder.buildBitCast(dropFn.parameters[0], type: anyClosureType.ptr)
-      var fn = builder.buildStructGEP(receiver, type: anyClosureType, index: 3)
-      fn = builder.buildLoad(fn, type: FunctionType([anyClosureType.ptr], VoidType()).ptr)
-      _ = builder.buildCall(fn, args: [receiver])
+      emit(dropClosure: dropFn.parameters[0])
       builder.buildRetVoid()
     }
 
@@ -503,9 +1197,7 @@ public struct Emitter: ExprVisitor, PathVisitor {
       builder.positionAtEnd(of: copyFn.appendBasicBlock(named: "entry"))
       let dst = builder.buildBitCast(copyFn.parameters[0], type: anyClosureType.ptr)
       let src = builder.buildBitCast(copyFn.parameters[1], type: anyClosureType.ptr)
-      var fn = builder.buildStructGEP(dst, type: anyClosureType, index: 2)
-      fn = builder.buildLoad(
-        fn, type: FunctionType([anyClosureType.ptr, anyClosureType.ptr], VoidType()).ptr)
+      let fn = buildLoadClosureThunk(src, index: 0)
       _ = builder.buildCall(fn, args: [dst, src])
       builder.buildRetVoid()
     }
@@ -513,14 +1205,12 @@ public struct Emitter: ExprVisitor, PathVisitor {
     // Create the type's equality function.
     var equalFn = builder.addFunction("_AnyClosure.te_equal", type: anyEqualityFuncType)
     equalFn.linkage = .private
-    copyFn.addAttribute(.alwaysinline , to: .function)
+    equalFn.addAttribute(.alwaysinline , to: .function)
     do {
       builder.positionAtEnd(of: equalFn.appendBasicBlock(named: "entry"))
       let lhs = builder.buildBitCast(equalFn.parameters[0], type: anyClosureType.ptr)
       let rhs = builder.buildBitCast(equalFn.parameters[1], type: anyClosureType.ptr)
-      var fn = builder.buildStructGEP(lhs, type: anyClosureType, index: 4)
-      fn = builder.buildLoad(
-        fn, type: FunctionType([anyClosureType.ptr, anyClosureType.ptr], IntType.int64).ptr)
+      let fn = buildLoadClosureThunk(lhs, index: 2)
       builder.buildRet(builder.buildCall(fn, args: [lhs, rhs]))
     }
 
@@ -528,7 +1218,10 @@ public struct Emitter: ExprVisitor, PathVisitor {
     var metatype = builder.addGlobal(
       "_AnyClosure.Type",
       initializer: metatypeType.constant(
-        values: [stride(of: anyClosureType), initFn, dropFn, copyFn, equalFn]))
+        values: [
+          stride(of: anyClosureType), initFn, dropFn, copyFn, equalFn,
+          i64(MetatypeKind.closure.rawValue), voidPtr.null(),
+        ]))
     metatype.linkage = .private
     return metatype
   }
@@ -561,19 +1254,26 @@ public struct Emitter: ExprVisitor, PathVisitor {
       builder.buildRetVoid()
     }
 
-    // Create the type's copy function.
-    var copyFn = builder.addFunction("\(decl.name).te_copy", type: anyCopyFuncType)
-    copyFn.linkage = .private
-    copyFn.addAttribute(.alwaysinline , to: .function)
+    // Create the type's copy function (unless it is trivial).
+    var copyFn: Function?
 
-    builder.positionAtEnd(of: copyFn.appendBasicBlock(named: "entry"))
-    _ = builder.buildCall(
-      emit(copyFuncFor: decl, irType: irType),
-      args: [
-        builder.buildBitCast(copyFn.parameters[0], type: irType.ptr),
-        builder.buildBitCast(copyFn.parameters[1], type: irType.ptr)
-      ])
-    builder.buildRetVoid()
+    if !decl.type!.isTrivial {
+      copyFn = builder.addFunction("\(decl.name).te_copy", type: anyCopyFuncType)
+      copyFn!.linkage = .private
+      copyFn!.addAttribute(.alwaysinline , to: .function)
+
+      builder.positionAtEnd(of: copyFn!.appendBasicBlock(named: "entry"))
+      _ = builder.buildCall(
+        emit(copyFuncFor: decl, irType: irType),
+        args: [
+          builder.buildBitCast(copyFn!.parameters[0], type: irType.ptr),
+          builder.buildBitCast(copyFn!.parameters[1], type: irType.ptr)
+        ])
+      builder.buildRetVoid()
+
+      // Trivial structs are compared inline, without any thunk.
+      _ = emit(equalityFuncFor: decl, irType: irType)
+    }
 
     // Create the type's equality function.
     var equalFn = builder.addFunction("\(decl.name).te_equal", type: anyEqualityFuncType)
@@ -581,13 +1281,25 @@ public struct Emitter: ExprVisitor, PathVisitor {
     equalFn.addAttribute(.alwaysinline , to: .function)
 
     builder.positionAtEnd(of: equalFn.appendBasicBlock(named: "entry"))
-    builder.buildRet(
-      builder.buildCall(
-        emit(equalityFuncFor: decl, irType: irType),
-        args: [
-          builder.buildBitCast(equalFn.parameters[0], type: irType.ptr),
-          builder.buildBitCast(equalFn.parameters[1], type: irType.ptr)
-        ]))
+    let eq = emitAreEqual(
+      lhs : builder.buildBitCast(equalFn.parameters[0], type: irType.ptr),
+      rhs : builder.buildBitCast(equalFn.parameters[1], type: irType.ptr),
+      type: decl.type!)
+    builder.buildRet(zext(eq))
+
+    // Declare the type's field table, which is defined by `emit(fieldTableFor:irType:)` once the
+    // metatypes of all struct types have been created.
+    var kind = MetatypeKind.trivial
+    var fields = voidPtr.null()
+    if !decl.type!.isTrivial {
+      guard case .struct(_, let props) = decl.type! else { unreachable() }
+      kind = .struct
+      fields = builder.buildBitCast(
+        builder.addGlobal(
+          "\(decl.name).Fields",
+          type: ArrayType(elementType: fieldLayoutType, count: props.count + 1)),
+        type: voidPtr)
+    }
 
     // Create the metatype.
     var metatype = builder.addGlobal(
@@ -597,13 +1309,34 @@ public struct Emitter: ExprVisitor, PathVisitor {
           stride(of: irType),
           initFn ?? anyInitFuncType.ptr.null(),
           dropFn ?? anyDropFuncType.ptr.null(),
-          copyFn,
+          copyFn ?? anyCopyFuncType.ptr.null(),
           equalFn,
+          i64(kind.rawValue),
+          fields,
         ]))
     metatype.linkage = .private
     return metatype
   }
 
+  /// Defines the field table of a non-trivial struct's metatype, which describes the offset and
+  /// the metatype of each of its fields.
+  private func emit(fieldTableFor decl: StructDecl, irType: StructType) {
+    guard case .struct(_, let props) = decl.type!, !decl.type!.isTrivial,
+          var table = module.global(named: "\(decl.name).Fields")
+    else { return }
+
+    var entries: [IRValue] = []
+    for (i, prop) in props.enumerated() {
+      let offset = Int(target.dataLayout.offsetOfElement(i, type: irType))
+      entries.append(fieldLayoutType.constant(values: [i64(offset), metatype(of: prop.type)]))
+    }
+    entries.append(fieldLayoutType.constant(values: [i64(0), metatypeType.ptr.null()]))
+
+    table.initializer = ArrayType.constant(entries, type: fieldLayoutType)
+    table.linkage = .private
+    table.isGlobalConstant = true
+  }
+
   private func emit(metatypeForArrayOf elemType: Type) -> Global {
     // Mangle the type of the array to create a name prefix.
     let prefix = "_" + Type.array(elem: elemType).mangled
@@ -670,7 +1403,10 @@ public struct Emitter: ExprVisitor, PathVisitor {
     var metatype = builder.addGlobal(
       "\(prefix).Type",
       initializer: metatypeType.constant(
-        values: [stride(of: anyArrayType), initFn, dropFn, copyFn, equalFn]))
+        values: [
+          stride(of: anyArrayType), initFn, dropFn, copyFn, equalFn,
+          i64(MetatypeKind.array.rawValue), builder.buildBitCast(baseMetatype, type: voidPtr),
+        ]))
     metatype.linkage = .private
     return metatype
   }
@@ -680,33 +1416,25 @@ public struct Emitter: ExprVisitor, PathVisitor {
     let oldInsertBlock = builder.insertBlock
     defer { oldInsertBlock.map(builder.positionAtEnd(of:)) }
 
+    // Trivial structs are copied inline (see `emit(copy:type:to:)`).
+    assert(!decl.type!.isTrivial)
+    guard case .struct(name: _, let props) = decl.type else { unreachable() }
+
     let irTypePtr = irType.ptr
     var fn = builder.addFunction(
       decl.name + ".copy", type: FunctionType([irTypePtr, irTypePtr], VoidType()))
     fn.linkage = .private
     builder.positionAtEnd(of: fn.appendBasicBlock(named: "entry"))
 
-    if decl.type!.isTrivial {
-      // If the struct is trivial, then memcpy is enough.
-      fn.addAttribute(.alwaysinline , to: .function)
-      fn.addAttribute(.argmemonly   , to: .function)
-
-      let dst = builder.buildBitCast(fn.parameters[0], type: voidPtr)
-      let src = builder.buildBitCast(fn.parameters[1], type: voidPtr)
-      _ = builder.buildCall(memcpy, args: [dst, src, stride(of: irType), IntType.int1.constant(0)])
-    } else if case .struct(name: _, let props) = decl.type {
-      // If the struct is not trivial, then we need to copy each property individually.
-      for (i, prop) in props.enumerated() {
-        let dst = builder.buildStructGEP(fn.parameters[0], type: irType, index: i)
-        let src = builder.buildStructGEP(fn.parameters[1], type: irType, index: i)
-        let val = prop.type.isAddressOnly
-          ? src
-          : builder.buildLoad(src, type: lower(prop.type))
-
-        emit(copy: val, type: prop.type, to: dst)
-      }
-    } else {
-      unreachable()
+    // Copy each property individually.
+    for (i, prop) in props.enumerated() {
+      let dst = builder.buildStructGEP(fn.parameters[0], type: irType, index: i)
+      let src = builder.buildStructGEP(fn.parameters[1], type: irType, index: i)
+      let val = prop.type.isAddressOnly
+        ? src
+        : builder.buildLoad(src, type: lower(prop.type))
+
+      emit(copy: val, type: prop.type, to: dst)
     }
 
     builder.buildRetVoid()
@@ -714,6 +1442,8 @@ public struct Emitter: ExprVisitor, PathVisitor {
   }
 
   private func emit(equalityFuncFor decl: StructDecl, irType: StructType) -> Function {
+    // Trivial structs are compared inline (see `emitAreEqual(lhs:rhs:type:)`).
+    assert(!decl.type!.isTrivial)
     guard case .struct(name: _, let props) = decl.type else { unreachable() }
 
     // Save the builder's current insertion block to restore at the end.
@@ -750,15 +1480,59 @@ public struct Emitter: ExprVisitor, PathVisitor {
     return fn
   }
 
+  /// Returns the value witness table of closures whose environments have the given captures,
+  /// emitting it if necessary.
+  ///
+  /// - Parameters:
+  ///   - owner: The name of the lifted function for which the table is requested.
+  ///   - captures: The closure's captures, sorted by name.
+  ///   - envType: The closure's environment type, if any.
+  private func emit(
+    vtableForClosure owner: String,
+    captures: [(String, Type)],
+    envType: StructType?
+  ) -> Global {
+    let copyFn = emit(copyFuncForClosure: owner, captures: captures, envType: envType)
+    let dropFn = emit(dropFuncForClosure: owner, captures: captures, envType: envType)
+    let equalFn = emit(equalityFuncForClosure: owner, captures: captures, envType: envType)
+
+    let name = "\(closureEnvPrefix(captures: captures)).vtable"
+    if let global = module.global(named: name) {
+      return global
+    }
+
+    var vtable = builder.addGlobal(
+      name, initializer: closureVTableType.constant(values: [copyFn, dropFn, equalFn]))
+    vtable.linkage = .private
+    vtable.isGlobalConstant = true
+    return vtable
+  }
+
+  /// Loads the function at the given index in the value witness table of a closure.
+  ///
+  /// - Parameters:
+  ///   - closure: A pointer to a closure.
+  ///   - index: The index of the function in the closure's value witness table.
+  private func buildLoadClosureThunk(_ closure: IRValue, index: Int) -> IRValue {
+    let vtable = builder.buildLoad(
+      builder.buildStructGEP(closure, type: anyClosureType, index: 2),
+      type: closureVTableType.ptr)
+    return builder.buildLoad(
+      builder.buildStructGEP(vtable, type: closureVTableType, index: index),
+      type: closureVTableType.elementTypes[index])
+  }
+
   private func emit(
-    dropFuncForClosure prefix: String,
+    dropFuncForClosure owner: String,
     captures: [(String, Type)],
     envType: StructType?
   ) -> Function {
-    let name = "\(prefix).drop"
+    let name = "\(closureEnvPrefix(captures: captures)).drop"
     if let fn = module.function(named: name) {
+      statistics.recordClosureThunkUse(fn, by: owner)
       return fn
     }
+    defer { statistics.recordClosureThunkUse(module.function(named: name)!, by: owner) }
 
     // Save the builder's current insertion block to restore them later.
     let oldInsertBlock = builder.insertBlock!
@@ -797,14 +1571,16 @@ public struct Emitter: ExprVisitor, PathVisitor {
   }
 
   private func emit(
-    copyFuncForClosure prefix: String,
+    copyFuncForClosure owner: String,
     captures: [(String, Type)],
     envType: StructType?
   ) -> Function {
-    let name = "\(prefix).copy"
+    let name = "\(closureEnvPrefix(captures: captures)).copy"
     if let fn = module.function(named: name) {
+      statistics.recordClosureThunkUse(fn, by: owner)
       return fn
     }
+    defer { statistics.recordClosureThunkUse(module.function(named: name)!, by: owner) }
 
     // Save the builder's current insertion block to restore them later.
     let oldInsertBlock = builder.insertBlock!
@@ -866,14 +1642,16 @@ public struct Emitter: ExprVisitor, PathVisitor {
   }
 
   private func emit(
-    equalityFuncForClosure prefix: String,
+    equalityFuncForClosure owner: String,
     captures: [(String, Type)],
     envType: StructType?
   ) -> Function {
-    let name = "\(prefix).equal"
+    let name = "\(closureEnvPrefix(captures: captures)).equal"
     if let fn = module.function(named: name) {
+      statistics.recordClosureThunkUse(fn, by: owner)
       return fn
     }
+    defer { statistics.recordClosureThunkUse(module.function(named: name)!, by: owner) }
 
     // Save the builder's current insertion block to restore them at the end.
     let oldInsertBlock = builder.insertBlock!
@@ -942,37 +1720,63 @@ public struct Emitter: ExprVisitor, PathVisitor {
   ///   - name: The name of the binding to which the function will be assigned. This is `nil`
   ///     unless the literal is part of a `FuncBindingExpr`.
   ///   - inlinable: A Boolean value that indicates whether the function can be inlined.
+  ///   - symbol: The name under which the function is exported, if any.
   ///
   /// - Returns: a pair `(function, captures)` where `function` is the LLVM function that was
   ///   created and `captures` is a dictionary with the function's local captures.
   private mutating func createFunction(
     literal   : inout FuncExpr,
     name      : String?,
-    inlinable : Bool = true
+    inlinable : Bool = true,
+    symbol    : String? = nil
   ) -> (function: Function, captures: [String: Type]) {
     guard case .func(let params, let output) = literal.type else { unreachable() }
 
     // Collect the symbols being captured by the function, excluding global functions and recursive
     // references to the function's declaration.
     let captures = literal.collectCaptures(excluding: { (n) -> Bool in
-      (bindings[n] is Function) || (n == name)
+      (bindings[n] is Function) || isGenericBuiltin(n) || (n == name)
     })
 
     // Create a function name.
     let funcName = (name ?? "fun") + String(describing: nextFuncID)
     nextFuncID += 1
 
-    // Create the LLVM function.
+    // Create the LLVM function. Exported functions are named after their symbol.
     let type = buildFunctionType(from: params, to: output)
-    var function = builder.addFunction("_" + funcName, type: type)
-    function.linkage = .private
+    var function = builder.addFunction(symbol ?? "_" + funcName, type: type)
+    if symbol == nil {
+      function.linkage = .private
+    }
     if !inlinable {
       function.addAttribute(.noinline, to: .function)
     }
+    emitParamAttributes(of: function, params: params, output: output)
 
     return (function, captures)
   }
 
+  /// Declares a function defined in another module, and binds it to its name.
+  ///
+  /// The declaration gets the attributes that follow from the summary exported by the module, so
+  /// that calls to the function can be optimized as if it were defined locally.
+  private mutating func emit(importedFunction decl: FuncDecl) {
+    guard case .func(let params, let output) = decl.type,
+          let symbol = decl.symbol
+    else { unreachable() }
+
+    let function = builder.addFunction(
+      symbol, type: buildFunctionType(from: params, to: output))
+    emitParamAttributes(of: function, params: params, output: output)
+
+    if let summary = importedSummaries[symbol] {
+      effects[symbol] = summary.effects
+      _ = emit(effectAttributes: summary.effects, of: function, params: params, output: output)
+    }
+
+    bindings[decl.name] = function
+  }
+
   private mutating func emitLocalFunction(
     literal       : inout FuncExpr,
     function      : Function,
@@ -985,10 +1789,194 @@ public struct Emitter: ExprVisitor, PathVisitor {
 
     // Keep globally defined functions, as they do not appear in the captures.
     let oldBindings = bindings
+    let oldConstants = constants
+    let oldMovableBindings = movableBindings
+    let oldReusableTails = reusableTails
+    let oldLoopDepth = loopDepth
+    bindings = bindings.filter({ $0.value is Function })
+    constants = [:]
+    movableBindings = []
+    reusableTails = nil
+    loopDepth = 0
+
+    // Register the parameters.
+    guard case .func(params: _, let output) = literal.type else { unreachable() }
+    let offset = output.isAddressOnly ? 1 : 0
+    for (i, param) in literal.params.enumerated() {
+      if param.type!.isAddressOnly {
+        bindings[param.name] = function.parameters[i + offset]
+      } else {
+        let alloca = addEntryAlloca(type: lower(param.type!))
+        builder.buildStore(function.parameters[i + offset], to: alloca)
+        bindings[param.name] = alloca
+      }
+    }
+
+    // Register the local captures.
+    if let envType = envType {
+      let e = builder.buildBitCast(function.parameters.last!, type: envType.ptr)
+      for (i, capture) in sortedCaptures.enumerated() {
+        bindings[capture.key] = builder.buildStructGEP(e, type: envType, index: i)
+      }
+    }
+
+    // Emit the body of the function.
+    if output.isAddressOnly {
+      emit(move: &literal.body, to: function.parameters[0])
+      builder.buildRetVoid()
+    } else {
+      builder.buildRet(literal.body.accept(&self))
+    }
+
+    // Restore the emitter's state.
+    builder.positionAtEnd(of: oldInsertBlock)
+    bindings = oldBindings
+    constants = oldConstants
+    movableBindings = oldMovableBindings
+    reusableTails = oldReusableTails
+    loopDepth = oldLoopDepth
+  }
+
+  /// Emits the body of a function that has no local captures.
+  ///
+  /// - Parameters:
+  ///   - literal: The function's literal.
+  ///   - function: The LLVM function whose body should be emitted.
+  ///   - constantArgs: The values of the parameters that are known to be constant, indexed by
+  ///     their position. The corresponding LLVM parameters are ignored.
+  ///   - extraParams: The names and types of additional parameters, passed after the function's
+  ///     formal parameters.
+  private mutating func emitGlobalFunction(
+    literal       : inout FuncExpr,
+    function      : Function,
+    constantArgs  : [Int: ConstantArg] = [:],
+    extraParams   : [(name: String, type: Type)] = []
+  ) {
+    // Configure the emitter's state.
+    let oldInsertBlock = builder.insertBlock!
+    builder.positionAtEnd(of: function.appendBasicBlock(named: "entry"))
+
+    // Keep globally defined functions, as they do not appear in the captures.
+    let oldBindings = bindings
+    let oldConstants = constants
+    let oldMovableBindings = movableBindings
+    let oldReusableTails = reusableTails
+    let oldLoopDepth = loopDepth
     bindings = bindings.filter({ $0.value is Function })
+    constants = [:]
+    movableBindings = []
+    reusableTails = nil
+    loopDepth = 0
+
+    // Summarize the function's effects before its body is emitted, so that specialized clones
+    // emitted for recursive calls can refer to it.
+    emitEffectAttributes(
+      literal: literal, function: function, extraParams: extraParams.map({ $0.type }))
+
+    // The body of a recursive function is a loop's body, which is emitted in a loop context.
+    if effects[function.name]!.isRecursive {
+      loopDepth = 1
+    }
 
     // Register the parameters.
     guard case .func(params: _, let output) = literal.type else { unreachable() }
+    let offset = output.isAddressOnly ? 1 : 0
+    for (i, param) in literal.params.enumerated() {
+      if let arg = constantArgs[i] {
+        let alloca = addEntryAlloca(type: lower(param.type!))
+        builder.buildStore(arg.value, to: alloca)
+        bindings[param.name] = alloca
+        constants[param.name] = arg
+      } else if param.type!.isAddressOnly {
+        bindings[param.name] = function.parameters[i + offset]
+      } else {
+        let alloca = addEntryAlloca(type: lower(param.type!))
+        builder.buildStore(function.parameters[i + offset], to: alloca)
+        bindings[param.name] = alloca
+      }
+    }
+
+    for (i, param) in extraParams.enumerated() {
+      let irParam = function.parameters[i + offset + literal.params.count]
+      if param.type.isAddressOnly {
+        bindings[param.name] = irParam
+      } else {
+        let alloca = addEntryAlloca(type: lower(param.type))
+        builder.buildStore(irParam, to: alloca)
+        bindings[param.name] = alloca
+      }
+    }
+
+    // Emit the body of the function.
+    if output.isAddressOnly {
+      emit(move: &literal.body, to: function.parameters[0])
+      builder.buildRetVoid()
+    } else {
+      builder.buildRet(literal.body.accept(&self))
+    }
+
+    // Restore the emitter's state.
+    builder.positionAtEnd(of: oldInsertBlock)
+    bindings = oldBindings
+    constants = oldConstants
+    movableBindings = oldMovableBindings
+    reusableTails = oldReusableTails
+    loopDepth = oldLoopDepth
+  }
+
+  /// Emits a recursive function that has no local captures, hoisting the computations that are
+  /// invariant across recursive calls.
+  ///
+  /// The function's body is emitted in a separate LLVM function, which accepts the hoisted values
+  /// as additional parameters. `function` computes these values once and calls it.
+  ///
+  /// - Parameters:
+  ///   - literal: The function's literal.
+  ///   - function: The LLVM function whose body should be emitted.
+  ///   - name: The name of the binding to which the function is assigned.
+  ///
+  /// - Returns: `false` if nothing could be hoisted, in which case nothing has been emitted.
+  private mutating func emitHoistingInvariants(
+    literal       : inout FuncExpr,
+    function      : Function,
+    name          : String
+  ) -> Bool {
+    let isSqrtBuiltin = (bindings["sqrt"] as? Function)?.name == "_sqrt"
+    var hoister = InvariantHoister(name: name, isSqrt: { n in isSqrtBuiltin && (n == "sqrt") })
+    guard let (body, hoisted) = hoister.hoist(from: literal) else { return false }
+    guard case .func(let params, let output) = literal.type else { unreachable() }
+
+    // Emit the function's body, in which the function's name refers to the inner function.
+    let innerType = buildFunctionType(from: params + hoisted.map({ $0.value.type! }), to: output)
+    var inner = builder.addFunction(function.name + ".inv", type: innerType)
+    inner.linkage = .private
+    emitParamAttributes(of: inner, params: params, output: output)
+
+    var innerLiteral = literal
+    innerLiteral.body = body
+    bindings[name] = inner
+    emitGlobalFunction(
+      literal: &innerLiteral,
+      function: inner,
+      extraParams: hoisted.map({ h in (name: h.name, type: h.value.type!) }))
+    bindings[name] = function
+    emitEffectAttributes(literal: literal, function: function)
+
+    // Emit the function that computes the hoisted values and calls the inner function.
+    let oldInsertBlock = builder.insertBlock!
+    builder.positionAtEnd(of: function.appendBasicBlock(named: "entry"))
+
+    let oldBindings = bindings
+    let oldConstants = constants
+    let oldMovableBindings = movableBindings
+    let oldReusableTails = reusableTails
+    let oldLoopDepth = loopDepth
+    bindings = bindings.filter({ $0.value is Function })
+    constants = [:]
+    movableBindings = []
+    reusableTails = nil
+    loopDepth = 0
+
     let offset = output.isAddressOnly ? 1 : 0
     for (i, param) in literal.params.enumerated() {
       if param.type!.isAddressOnly {
@@ -1000,63 +1988,466 @@ public struct Emitter: ExprVisitor, PathVisitor {
       }
     }
 
-    // Register the local captures.
-    if let envType = envType {
-      let e = builder.buildBitCast(function.parameters.last!, type: envType.ptr)
-      for (i, capture) in sortedCaptures.enumerated() {
-        bindings[capture.key] = builder.buildStructGEP(e, type: envType, index: i)
-      }
+    var args = Array(function.parameters.dropLast())
+    var tmps: [(IRValue, Type)] = []
+    for h in hoisted {
+      var value = h.value
+      let tmp = value.accept(&self)
+      args.append(tmp)
+      tmps.append((tmp, value.type!))
+    }
+    args.append(voidPtr.null())
+
+    let result = builder.buildCall(inner, args: args)
+    for (value, type) in tmps {
+      emit(drop: value, type: type)
+    }
+
+    if output.isAddressOnly {
+      builder.buildRetVoid()
+    } else {
+      builder.buildRet(result)
+    }
+
+    // Restore the emitter's state.
+    builder.positionAtEnd(of: oldInsertBlock)
+    bindings = oldBindings
+    constants = oldConstants
+    movableBindings = oldMovableBindings
+    reusableTails = oldReusableTails
+    loopDepth = oldLoopDepth
+
+    statistics.recordHoistedInvariants(in: name, count: hoisted.count)
+    return true
+  }
+
+  /// Attaches the aliasing attributes that follow from the law of exclusivity to the parameters of
+  /// a function.
+  ///
+  /// The type checker rejects calls whose `inout` arguments may overlap, while other arguments are
+  /// either copies or aliases of immutable bindings. Hence, the location of an `inout` argument is
+  /// not accessible through any other pointer during the call. Likewise, the storage of a result
+  /// returned indirectly is always fresh.
+  ///
+  /// - Parameters:
+  ///   - function: The LLVM function to annotate.
+  ///   - params: The MVS semantic type of each formal parameter.
+  ///   - output: The MVS semantic type of the return value.
+  private func emitParamAttributes(of function: Function, params: [Type], output: Type) {
+    var function = function
+    let offset = output.isAddressOnly ? 1 : 0
+    if output.isAddressOnly {
+      function.addAttribute(.noalias  , to: .argument(0))
+      function.addAttribute(.nocapture, to: .argument(0))
+    }
+
+    for (i, param) in params.enumerated() where param.isInoutType {
+      function.addAttribute(.noalias  , to: .argument(i + offset))
+      function.addAttribute(.nocapture, to: .argument(i + offset))
+    }
+  }
+
+  /// Computes the effect summary of a global function and attaches the corresponding attributes
+  /// to its LLVM declaration.
+  ///
+  /// Functions that neither allocate nor call opaque functions only touch the memory of their
+  /// arguments, which lets LLVM eliminate, hoist and merge redundant calls.
+  ///
+  /// - Parameters:
+  ///   - literal: The function's literal.
+  ///   - function: The LLVM function to annotate.
+  ///   - extraParams: The types of the parameters that `function` accepts after the function's
+  ///     formal parameters (e.g., the values hoisted out of a recursive function). Address-only
+  ///     values are passed by pointer, so the function reads memory that its caller writes.
+  private mutating func emitEffectAttributes(
+    literal: FuncExpr, function: Function, extraParams: [Type] = []
+  ) {
+    guard case .func(let formalParams, let output) = literal.type else { unreachable() }
+    let params = formalParams + extraParams
+
+    // Collect the summaries of the global functions in scope.
+    var name: String? = nil
+    var summaries: [String: EffectSummary] = [:]
+    for case (let n, let f as Function) in bindings {
+      if f.name == function.name {
+        name = n
+      } else if let summary = effects[f.name] {
+        summaries[n] = summary
+      }
+    }
+
+    let summary = EffectAnalyzer.summarize(literal, name: name, summaries: summaries)
+    effects[function.name] = summary
+
+    let attributes = emit(effectAttributes: summary, of: function, params: params, output: output)
+    statistics.recordEffectAttributes(of: function.name, attributes: attributes)
+  }
+
+  /// Attaches the attributes that follow from the given effect summary to the declaration of a
+  /// function, and returns their names.
+  private func emit(
+    effectAttributes summary: EffectSummary,
+    of function: Function,
+    params: [Type],
+    output: Type
+  ) -> [String] {
+    var function = function
+
+    // MVS has no exceptions.
+    var attributes = ["nounwind"]
+    function.addAttribute(.nounwind, to: .function)
+
+    if !summary.allocates && !summary.callsOpaqueFunctions {
+      let writes = output.isAddressOnly || !summary.writtenParams.isEmpty
+      let hasPointerArgs = output.isAddressOnly || params.contains(where: { $0.isAddressOnly })
+
+      if !writes && !hasPointerArgs && !summary.readsIndirectMemory {
+        function.addAttribute(.readnone, to: .function)
+        attributes.append("readnone")
+      } else {
+        if !summary.readsIndirectMemory {
+          function.addAttribute(.argmemonly, to: .function)
+          attributes.append("argmemonly")
+        }
+        if !writes {
+          function.addAttribute(.readonly, to: .function)
+          attributes.append("readonly")
+        }
+      }
+
+      function.addFunctionAttribute(named: "nosync")
+      attributes.append("nosync")
+      if !summary.mayNotReturn {
+        function.addFunctionAttribute(named: "willreturn")
+        attributes.append("willreturn")
+      }
+    }
+
+    return attributes
+  }
+
+  /// Registers the literal of a global function so that it can be specialized at call sites.
+  private mutating func registerTemplate(literal: FuncExpr, function: Function) {
+    functionTemplates[function.name] = (
+      literal : literal,
+      bindings: bindings.filter({ $0.value is Function }))
+  }
+
+  /// Returns the size of the module and the growth due to specialization, from which the cost of
+  /// a template is computed once its body has been emitted.
+  private func costMark() -> (size: Int, growth: Int) {
+    if case .debug = mode { return (0, 0) }
+    return (module.instructionCount, statistics.specializationGrowth)
+  }
+
+  /// Records the cost of a template whose body has been emitted since the given mark, including
+  /// the functions emitted for its hoisted invariants and its local functions.
+  private mutating func recordTemplateCost(
+    of function: Function, since mark: (size: Int, growth: Int)
+  ) {
+    if case .debug = mode { return }
+    let nestedGrowth = statistics.specializationGrowth - mark.growth
+    templateCosts[function.name] = module.instructionCount - mark.size - nestedGrowth
+  }
+
+  /// Returns a clone of the given global function specialized for the constant arguments of a
+  /// call, emitting it if necessary.
+  ///
+  /// Parameters bound to constants are known in the clone's body, so that LLVM can fold them,
+  /// and they are forwarded to the calls that pass them unchanged. In particular, a recursive
+  /// function that forwards its bounds gets known trip counts. Clones are only emitted in
+  /// optimized modes, and as long as the module's growth stays within `specializationBudget`.
+  ///
+  /// - Parameters:
+  ///   - function: The function being called.
+  ///   - args: The arguments of the call.
+  ///
+  /// - Returns: The specialized clone of `function`, or `nil` if the call can't be specialized.
+  private mutating func specialize(_ function: Function, forArgs args: [Expr]) -> Function? {
+    if case .debug = mode { return nil }
+    guard let template = functionTemplates[function.name] else { return nil }
+
+    // Collect the constant arguments.
+    var constantArgs: [Int: ConstantArg] = [:]
+    for i in 0 ..< args.count {
+      constantArgs[i] = constantValue(of: args[i])
+    }
+    guard !constantArgs.isEmpty else { return nil }
+
+    // Reuse the existing clone, if any.
+    let positions = constantArgs.keys.sorted()
+    let name = function.name + ".spec" + positions
+      .map({ i in ".\(i)=\(constantArgs[i]!.description)" })
+      .joined()
+    if let clone = module.function(named: name) {
+      return clone
+    }
+
+    // Make sure the clone fits in the code growth budget, together with the clones whose body is
+    // being emitted. The cost of the original function is unknown until its body is finished, in
+    // which case the call isn't specialized.
+    let reasons = positions.map({ i in
+      "\(template.literal.params[i].name) = \(constantArgs[i]!.description)"
+    })
+    guard let estimatedCost = templateCosts[function.name],
+          statistics.specializationGrowth + pendingSpecializationCost + estimatedCost
+            <= specializationBudget
+    else {
+      statistics.recordRejectedSpecialization(of: function.name, reasons: reasons)
+      return nil
+    }
+
+    // Emit the clone, in the context of the original function's definition. The clone is added
+    // to the module before its body is emitted, so that recursive calls can refer to it.
+    let sizeBefore = module.instructionCount
+    let growthBefore = statistics.specializationGrowth
+    var clone = builder.addFunction(name, type: function.type as! FunctionType)
+    clone.linkage = .private
+    if case .func(let params, let output) = template.literal.type {
+      emitParamAttributes(of: clone, params: params, output: output)
+    }
+
+    var literal = template.literal
+    let oldBindings = bindings
+    bindings = template.bindings
+    pendingSpecializationCost += estimatedCost
+    emitGlobalFunction(literal: &literal, function: clone, constantArgs: constantArgs)
+    pendingSpecializationCost -= estimatedCost
+    bindings = oldBindings
+
+    // Nested clones have already been accounted for.
+    let nestedGrowth = statistics.specializationGrowth - growthBefore
+    statistics.recordSpecialization(
+      of: function.name,
+      as: name,
+      reasons: reasons,
+      growth: module.instructionCount - sizeBefore - nestedGrowth)
+    return clone
+  }
+
+  /// Returns the value of the given expression if it is known to be a compile-time constant.
+  private func constantValue(of expr: Expr) -> ConstantArg? {
+    switch expr {
+    case let e as IntExpr:
+      return ConstantArg(value: i64(e.value), description: String(describing: e.value))
+    case let e as FloatExpr:
+      return ConstantArg(
+        value: FloatType.double.constant(e.value), description: String(describing: e.value))
+    case let e as NamePath:
+      return constants[e.name]
+    default:
+      return nil
+    }
+  }
+
+  /// Returns the in-place variant of a global function and the position of the parameter it
+  /// updates, if the given assignment has the form `x = f(..., x, ...)` and can be emitted as an
+  /// in-place update of `x`.
+  ///
+  /// The assignment must assign the result of a statically dispatched call to a path built from
+  /// names and properties only, that is passed by value to a parameter of the same type as the
+  /// call's result, and that is not mentioned by the other arguments.
+  private mutating func inPlaceVariant(for expr: AssignExpr) -> (Function, Int)? {
+    guard let call = expr.rvalue as? CallExpr,
+          let callee = call.callee as? NamePath,
+          let function = bindings[callee.name] as? Function,
+          case .func(let params, let output) = callee.type,
+          output.isAddressOnly && output.isZeroDroppable,
+          let root = expr.lvalue.root as? NamePath,
+          root.name != "_",
+          isNameOrPropPath(expr.lvalue)
+    else { return nil }
+
+    guard let i = call.args.firstIndex(where: { arg in
+      guard let path = arg as? Path, isNameOrPropPath(path) else { return false }
+      return path.denotesSameLocation(as: expr.lvalue)
+    }) else { return nil }
+    guard params[i] == output else { return nil }
+
+    for j in 0 ..< call.args.count where j != i {
+      if call.args[j].uses(root.name) { return nil }
+    }
+
+    // Reuse the existing variant, if any.
+    let name = "\(function.name).inplace\(i)"
+    if let variant = module.function(named: name) {
+      return (variant, i)
     }
 
-    // Emit the body of the function.
-    if output.isAddressOnly {
-      emit(move: &literal.body, to: function.parameters[0])
-      builder.buildRetVoid()
-    } else {
-      builder.buildRet(literal.body.accept(&self))
+    // Functions defined in other modules export the variants listed in their summary.
+    if let summary = importedSummaries[function.name] {
+      guard summary.inPlaceParams.contains(i) else { return nil }
+      let type = buildFunctionType(from: params, to: .int)
+      let variant = builder.addFunction(
+        name, type: FunctionType(type.parameterTypes, VoidType()))
+      return (variant, i)
     }
 
-    // Restore the emitter's state.
-    builder.positionAtEnd(of: oldInsertBlock)
+    guard functionTemplates[function.name] != nil else { return nil }
+    return (emitInPlaceVariant(of: function, param: i), i)
+  }
+
+  /// Emits the in-place variant of a global function for the parameter at the given position.
+  ///
+  /// The variant takes the same parameters as the function, except that it has no return value.
+  /// Instead, the updated parameter is passed as the location to update.
+  private mutating func emitInPlaceVariant(of function: Function, param i: Int) -> Function {
+    let template = functionTemplates[function.name]!
+    guard case .func(let params, _) = template.literal.type else { unreachable() }
+
+    let type = buildFunctionType(from: params, to: .int)
+    var variant = builder.addFunction(
+      "\(function.name).inplace\(i)", type: FunctionType(type.parameterTypes, VoidType()))
+    variant.linkage = .private
+
+    var literal = template.literal
+    let oldBindings = bindings
+    bindings = template.bindings
+    emitInPlaceFunction(literal: &literal, function: variant, original: function, param: i)
     bindings = oldBindings
+
+    return variant
   }
 
-  private mutating func emitGlobalFunction(
+  /// Emits the in-place variants of a function exported by the module being emitted, and records
+  /// the summary of the function.
+  ///
+  /// A variant is emitted for each parameter whose type is that of the function's result, so that
+  /// modules importing the function can update their arguments in place.
+  private mutating func emitExport(of function: Function, literal: FuncExpr) {
+    guard case .func(let params, let output) = literal.type else { unreachable() }
+    let instructionCount = function.instructionCount
+
+    var inPlaceParams: [Int] = []
+    if output.isAddressOnly && output.isZeroDroppable {
+      for i in 0 ..< params.count where params[i] == output {
+        var variant = emitInPlaceVariant(of: function, param: i)
+        variant.linkage = .external
+        inPlaceParams.append(i)
+      }
+    }
+
+    exportedSummaries[function.name] = FunctionSummary(
+      effects: effects[function.name]!,
+      inPlaceParams: inPlaceParams,
+      instructionCount: instructionCount)
+  }
+
+  /// Emits the body of an in-place variant of a global function.
+  ///
+  /// The variant owns the value of the updated parameter, which it can move to the bindings that
+  /// are the last use of that parameter, and it writes its result in the parameter's location.
+  /// Array literals and recursive calls in tail position build their value in that location
+  /// directly, so that the parameter's storage is reused rather than dropped.
+  ///
+  /// - Parameters:
+  ///   - literal: The function's literal.
+  ///   - function: The LLVM function whose body should be emitted.
+  ///   - original: The LLVM function of which `function` is a variant.
+  ///   - param: The position of the updated parameter.
+  private mutating func emitInPlaceFunction(
     literal       : inout FuncExpr,
-    function      : Function
+    function      : Function,
+    original      : Function,
+    param         : Int
   ) {
     // Configure the emitter's state.
     let oldInsertBlock = builder.insertBlock!
     builder.positionAtEnd(of: function.appendBasicBlock(named: "entry"))
 
-    // Keep globally defined functions, as they do not appear in the captures.
     let oldBindings = bindings
+    let oldConstants = constants
+    let oldMovableBindings = movableBindings
+    let oldReusableTails = reusableTails
+    let oldLoopDepth = loopDepth
     bindings = bindings.filter({ $0.value is Function })
+    constants = [:]
+    let name = literal.params[param].name
+    movableBindings = lastUseBindings(of: name, in: literal.body)
+    reusableTails = (
+      param: name,
+      position: param,
+      function: original.name,
+      ranges: tailsReusingStorage(
+        of: name, at: param, in: literal.body, skipping: movableBindings))
+    loopDepth = effects[original.name]?.isRecursive == true ? 1 : 0
 
     // Register the parameters.
-    guard case .func(params: _, let output) = literal.type else { unreachable() }
-    let offset = output.isAddressOnly ? 1 : 0
-    for (i, param) in literal.params.enumerated() {
-      if param.type!.isAddressOnly {
-        bindings[param.name] = function.parameters[i + offset]
+    for (i, decl) in literal.params.enumerated() {
+      if decl.type!.isAddressOnly {
+        bindings[decl.name] = function.parameters[i]
       } else {
-        let alloca = addEntryAlloca(type: lower(param.type!))
-        builder.buildStore(function.parameters[i + offset], to: alloca)
-        bindings[param.name] = alloca
+        let alloca = addEntryAlloca(type: lower(decl.type!))
+        builder.buildStore(function.parameters[i], to: alloca)
+        bindings[decl.name] = alloca
       }
     }
 
-    // Emit the body of the function.
-    if output.isAddressOnly {
-      emit(move: &literal.body, to: function.parameters[0])
-      builder.buildRetVoid()
-    } else {
-      builder.buildRet(literal.body.accept(&self))
-    }
+    // Emit the new value before dropping the old one, as the former may be computed from the
+    // latter if it hasn't been moved. Tails built in the parameter's storage move its value out,
+    // so that dropping the parameter is a no-op.
+    let type = literal.params[param].type!
+    let result = addEntryAlloca(type: lower(type))
+    emit(move: &literal.body, to: result)
+    emit(drop: function.parameters[param], type: type)
+    emit(move: result, type: type, to: function.parameters[param])
+    builder.buildRetVoid()
 
     // Restore the emitter's state.
     builder.positionAtEnd(of: oldInsertBlock)
     bindings = oldBindings
+    constants = oldConstants
+    movableBindings = oldMovableBindings
+    reusableTails = oldReusableTails
+    loopDepth = oldLoopDepth
+  }
+
+  /// Returns whether the given path is only composed of names and property accesses.
+  private func isNameOrPropPath(_ path: Expr) -> Bool {
+    switch path {
+    case is NamePath:
+      return true
+    case let p as PropPath:
+      return isNameOrPropPath(p.base)
+    default:
+      return false
+    }
+  }
+
+  /// Returns, for each expression in `exprs` that denotes the same array binding as an earlier one,
+  /// the position of the first such expression.
+  ///
+  /// Copies of these expressions denote the same storage as long as none of the expressions can
+  /// mutate the binding, which is guaranteed if they are all literals or paths composed of names
+  /// and property accesses.
+  ///
+  /// - Parameters:
+  ///   - exprs: A list of expressions evaluated in order.
+  ///   - skipped: The position of an expression that should be ignored, if any.
+  private func repeatedArrayBindings(
+    in exprs: [Expr],
+    skipping skipped: Int? = nil
+  ) -> [Int: Int] {
+    let isPure = exprs.allSatisfy({ e in
+      (e is IntExpr) || (e is FloatExpr) || (e is StringExpr) || isNameOrPropPath(e)
+    })
+    guard isPure else { return [:] }
+
+    var firsts: [String: Int] = [:]
+    var repeated: [Int: Int] = [:]
+    for (i, expr) in exprs.enumerated() where i != skipped {
+      guard let path = expr as? NamePath,
+            case .array = path.type!,
+            !(bindings[path.name] is Function)
+      else { continue }
+
+      if let j = firsts[path.name] {
+        repeated[i] = j
+      } else {
+        firsts[path.name] = i
+      }
+    }
+    return repeated
   }
 
   // ----------------------------------------------------------------------------------------------
@@ -1068,6 +2459,7 @@ public struct Emitter: ExprVisitor, PathVisitor {
     let irType: IRType
     switch type {
     case .struct: irType = lower(type)
+    case .string: irType = stringType
     case .array : irType = anyArrayType
     case .func  : irType = anyClosureType
     default     : return
@@ -1090,6 +2482,9 @@ public struct Emitter: ExprVisitor, PathVisitor {
         emit(drop: field, type: prop.type)
       }
 
+    case .string:
+      _ = builder.buildCall(runtime.stringDrop, args: [val])
+
     case .array(let elemType):
       _ = builder.buildCall(runtime.arrayDrop, args: [val, metatype(of: elemType)])
 
@@ -1106,14 +2501,18 @@ public struct Emitter: ExprVisitor, PathVisitor {
 
   func emit(dropClosure val: IRValue) {
     let closure = builder.buildBitCast(val, type: anyClosureType.ptr)
-    var dropFn = builder.buildStructGEP(closure, type: anyClosureType, index: 3)
-    dropFn = builder.buildLoad(
-      dropFn, type: FunctionType([anyClosureType.ptr], VoidType()).ptr)
+    let vtable = builder.buildLoad(
+      builder.buildStructGEP(closure, type: anyClosureType, index: 2),
+      type: closureVTableType.ptr)
 
+    // Zero-initialized closures have no value witness table.
     let elseIB = builder.currentFunction!.appendBasicBlock(named: "else")
     let thenIB = builder.currentFunction!.appendBasicBlock(named: "then")
-    builder.buildCondBr(condition: builder.buildIsNull(dropFn), then: thenIB, else: elseIB)
+    builder.buildCondBr(condition: builder.buildIsNull(vtable), then: thenIB, else: elseIB)
     builder.positionAtEnd(of: elseIB)
+    let dropFn = builder.buildLoad(
+      builder.buildStructGEP(vtable, type: closureVTableType, index: 1),
+      type: closureVTableType.elementTypes[1])
     _ = builder.buildCall(dropFn, args: [closure])
     builder.buildBr(thenIB)
     builder.positionAtEnd(of: thenIB)
@@ -1133,16 +2532,16 @@ public struct Emitter: ExprVisitor, PathVisitor {
         _ = builder.buildCall(fn, args: [loc, val])
       }
 
+    case .string:
+      _ = builder.buildCall(runtime.stringCopy, args: [loc, val])
+
     case .array:
       _ = builder.buildCall(runtime.arrayCopy, args: [loc, val])
 
     case .func:
       let closure = builder.buildBitCast(val, type: anyClosureType.ptr)
-      var copyFn = builder.buildStructGEP(closure, type: anyClosureType, index: 2)
-      copyFn = builder.buildLoad(
-        copyFn, type: FunctionType([anyClosureType.ptr, anyClosureType.ptr], VoidType()).ptr)
-
-      _ = builder.buildCall(copyFn, args: [loc, val])
+      let copyFn = buildLoadClosureThunk(closure, index: 0)
+      _ = builder.buildCall(copyFn, args: [loc, closure])
 
     case .any:
       _ = builder.buildCall(runtime.existCopy, args: [loc, val])
@@ -1187,6 +2586,9 @@ public struct Emitter: ExprVisitor, PathVisitor {
     case .float:
       _ = builder.buildCall(runtime.printF64, args: [value])
 
+    case .string:
+      _ = builder.buildCall(runtime.printString, args: [value])
+
     default:
       break
     }
@@ -1202,10 +2604,19 @@ public struct Emitter: ExprVisitor, PathVisitor {
       return builder.buildFCmp(lhs, rhs, .orderedEqual)
 
     case .struct(let name, props: _):
+      if type.isTrivial {
+        return emitAreEqual(trivialStructs: lhs, rhs, type: type)
+      }
+
+      // If the struct is not trivial, fall back to its equality function.
       let fn = module.function(named: name + ".equal")!
       let eq = builder.buildCall(fn, args: [lhs, rhs])
       return builder.buildTrunc(eq, type: IntType.int1)
 
+    case .string:
+      let eq = builder.buildCall(runtime.stringEqual, args: [lhs, rhs])
+      return builder.buildTrunc(eq, type: IntType.int1)
+
     case .array(let elemType):
       let eq = builder.buildCall(runtime.arrayEqual, args: [lhs, rhs, metatype(of: elemType)])
       return builder.buildTrunc(eq, type: IntType.int1)
@@ -1213,9 +2624,7 @@ public struct Emitter: ExprVisitor, PathVisitor {
     case .func:
       let lhs = builder.buildBitCast(lhs, type: anyClosureType.ptr)
       let rhs = builder.buildBitCast(rhs, type: anyClosureType.ptr)
-      let fun = builder.buildLoad(
-        builder.buildStructGEP(lhs, type: anyClosureType, index: 4),
-        type: FunctionType([anyClosureType.ptr, anyClosureType.ptr], IntType.int64).ptr)
+      let fun = buildLoadClosureThunk(lhs, index: 2)
 
       let eq = builder.buildCall(fun, args: [lhs, rhs])
       return builder.buildTrunc(eq, type: IntType.int1)
@@ -1229,6 +2638,43 @@ public struct Emitter: ExprVisitor, PathVisitor {
     }
   }
 
+  /// Emits an inline equality check between two instances of a trivial struct.
+  ///
+  /// If the struct is bitwise comparable, its instances are compared as a single wide integer,
+  /// which LLVM lowers to a sequence of vector comparisons. Otherwise, properties are compared one
+  /// by one without branching, so that floating-point properties obey IEEE equality.
+  private func emitAreEqual(trivialStructs lhs: IRValue, _ rhs: IRValue, type: Type) -> IRValue {
+    guard case .struct(name: _, let props) = type else { unreachable() }
+    let irType = lower(type)
+
+    if type.isBitwiseComparable {
+      // Empty structs are always equal.
+      let width = Int(target.dataLayout.allocationSize(of: irType)) * 8
+      guard width > 0 else { return IntType.int1.constant(1) }
+
+      let wideType = IntType(width: width, in: llvm)
+      let alignment = target.dataLayout.abiAlignment(of: irType)
+      let a = builder.buildLoad(
+        builder.buildBitCast(lhs, type: wideType.ptr), type: wideType, alignment: alignment)
+      let b = builder.buildLoad(
+        builder.buildBitCast(rhs, type: wideType.ptr), type: wideType, alignment: alignment)
+      return builder.buildICmp(a, b, .equal)
+    }
+
+    var result: IRValue = IntType.int1.constant(1)
+    for (i, prop) in props.enumerated() {
+      var a = builder.buildStructGEP(lhs, type: irType, index: i)
+      var b = builder.buildStructGEP(rhs, type: irType, index: i)
+      if !prop.type.isAddressOnly {
+        a = builder.buildLoad(a, type: lower(prop.type))
+        b = builder.buildLoad(b, type: lower(prop.type))
+      }
+      result = builder.buildAnd(result, emitAreEqual(lhs: a, rhs: b, type: prop.type))
+    }
+
+    return result
+  }
+
   /// Emits the application of the specified operator on the given operands.
   func emitApplyOper(
     kind: OperExpr.Kind,
@@ -1296,6 +2742,23 @@ public struct Emitter: ExprVisitor, PathVisitor {
       case .int, .float : return builder.buildDiv(lhs, rhs)
       default           : unreachable()
       }
+
+    case .and:
+      return builder.buildAnd(lhs, rhs)
+
+    case .or:
+      return builder.buildOr(lhs, rhs)
+
+    case .xor:
+      return builder.buildXor(lhs, rhs)
+
+    case .shl:
+      // Shift amounts are taken modulo 64, so that oversized shifts are not poison.
+      return builder.buildShl(lhs, builder.buildAnd(rhs, i64(63)))
+
+    case .shr:
+      // Right shifts are arithmetic, as integers are signed.
+      return builder.buildShr(lhs, builder.buildAnd(rhs, i64(63)), isArithmetic: true)
     }
   }
 
@@ -1311,7 +2774,46 @@ public struct Emitter: ExprVisitor, PathVisitor {
     return FloatType.double.constant(expr.value)
   }
 
+  public mutating func visit(_ expr: inout StringExpr) -> IRValue {
+    let alloca = addEntryAlloca(type: stringType)
+    let bytes = Array(expr.value.utf8)
+
+    if bytes.count <= 15 {
+      // Small strings are stored inline, so their representation is a constant. Bytes are packed
+      // in little-endian order, with the count tagged in the last byte.
+      var words: [UInt64] = [0, 0]
+      for (i, byte) in bytes.enumerated() {
+        words[i / 8] |= UInt64(byte) << UInt64(8 * (i % 8))
+      }
+      if !bytes.isEmpty {
+        words[1] |= (0x80 | UInt64(bytes.count)) << 56
+      }
+      builder.buildStore(stringType.constant(values: [i64(words[0]), i64(words[1])]), to: alloca)
+    } else {
+      // Large strings are copied out of a constant global.
+      var global = builder.addGlobalString(name: "_str", value: expr.value)
+      global.linkage = .private
+      global.isGlobalConstant = true
+      _ = builder.buildCall(
+        runtime.stringInit,
+        args: [alloca, builder.buildBitCast(global, type: voidPtr), i64(bytes.count)])
+    }
+
+    return alloca
+  }
+
   public mutating func visit(_ expr: inout ArrayExpr) -> IRValue {
+    // Build literals in tail position of an in-place function in the storage of the parameter
+    // that the function updates.
+    if let reuse = reusableTails, reuse.ranges.contains(expr.range) {
+      let loc = bindings[reuse.param]!
+      emit(reinit: loc, with: &expr, buffered: expr.elems.contains(where: { e in
+        e.uses(reuse.param)
+      }))
+      statistics.recordReusedTail()
+      return emit(moveOutOf: loc, type: expr.type!)
+    }
+
     guard case .array(let elemType) = expr.type else { unreachable() }
     let elemIRType = lower(elemType)
 
@@ -1322,18 +2824,94 @@ public struct Emitter: ExprVisitor, PathVisitor {
       args: [alloca, metatype(of: elemType), i64(expr.elems.count), stride(of: elemIRType)])
 
     // Initialize each element.
-    let payload = buildPayload(of: alloca, elemType: elemIRType)
-    for i in 0 ..< expr.elems.count {
+    emit(elementsOf: &expr, to: alloca)
+    return alloca
+  }
+
+  /// Reinitializes an array with the elements of a literal of the same type.
+  ///
+  /// The runtime reuses the array's storage if it is uniquely referenced and large enough, and
+  /// otherwise drops it and allocates new storage.
+  ///
+  /// - Parameters:
+  ///   - array: A pointer to an initialized array.
+  ///   - expr: An array literal.
+  ///   - buffered: Whether the literal's elements may read the array, in which case they are
+  ///     emitted into a temporary buffer before its current elements are dropped.
+  private mutating func emit(reinit array: IRValue, with expr: inout ArrayExpr, buffered: Bool) {
+    guard case .array(let elemType) = expr.type else { unreachable() }
+    let elemIRType = lower(elemType)
+    let count = expr.elems.count
+    let reinitArgs = [array, metatype(of: elemType), i64(count), stride(of: elemIRType)]
+
+    guard buffered && (count > 0) else {
+      _ = builder.buildCall(runtime.arrayReinit, args: reinitArgs)
+      emit(elementsOf: &expr, to: array)
+      return
+    }
+
+    let size = allocationSize(of: elemIRType) * count
+    let buffer = addEntryAlloca(type: elemIRType, count: count, name: "elems")
+    emitLifetimeStart(of: buffer, size: size)
+    emit(elements: &expr.elems, type: elemType, toPayload: buffer)
+
+    _ = builder.buildCall(runtime.arrayReinit, args: reinitArgs)
+    let dst = builder.buildBitCast(buildPayload(of: array, elemType: elemIRType), type: voidPtr)
+    let src = builder.buildBitCast(buffer, type: voidPtr)
+    _ = builder.buildCall(memmove, args: [dst, src, i64(size), IntType.int1.constant(0)])
+    emitLifetimeEnd(of: buffer, size: size)
+  }
+
+  /// Emits the elements of an array literal into the payload of an array whose elements have
+  /// been zero-initialized.
+  ///
+  /// - Parameters:
+  ///   - expr: An array literal.
+  ///   - array: A pointer to an array of the same size as `expr`.
+  private mutating func emit(elementsOf expr: inout ArrayExpr, to array: IRValue) {
+    guard case .array(let elemType) = expr.type else { unreachable() }
+    let elemIRType = lower(elemType)
+
+    let payload = buildPayload(of: array, elemType: elemIRType)
+    emit(elements: &expr.elems, type: elemType, toPayload: payload)
+  }
+
+  /// Emits the given expressions into the uninitialized elements of an array payload.
+  ///
+  /// Elements that denote the same array binding as an earlier one are copied bitwise from that
+  /// element, whose storage is then retained once for all of them.
+  ///
+  /// - Parameters:
+  ///   - elems: The expressions of the elements.
+  ///   - elemType: The type of the elements.
+  ///   - payload: A pointer to the first element of the payload.
+  private mutating func emit(
+    elements elems: inout [Expr], type elemType: Type, toPayload payload: IRValue
+  ) {
+    let elemIRType = lower(elemType)
+    let repeated = repeatedArrayBindings(in: elems)
+    var retains: [Int: Int] = [:]
+
+    var geps: [IRValue] = []
+    for i in 0 ..< elems.count {
       let gep = builder.buildInBoundsGEP(payload, type: elemIRType, indices: [i64(i)])
-      if isMovable(expr.elems[i]) {
-        emit(move: &expr.elems[i], to: gep)
+      geps.append(gep)
+
+      if let j = repeated[i] {
+        emit(move: geps[j], type: elemType, to: gep)
+        retains[j, default: 0] += 1
+      } else if isMovable(elems[i]) {
+        emit(move: &elems[i], to: gep)
       } else {
         emit(init: gep, type: elemType)
-        emit(copy: &expr.elems[i], to: gep)
+        emit(copy: &elems[i], to: gep)
       }
     }
 
-    return alloca
+    for (j, n) in retains.sorted(by: { a, b in a.key < b.key }) {
+      _ = builder.buildCall(runtime.arrayRetainN, args: [geps[j], i64(n)])
+    }
+    statistics.recordCoalescedRetains(repeated.count)
   }
 
   public mutating func visit(_ expr: inout StructExpr) -> IRValue {
@@ -1345,9 +2923,16 @@ public struct Emitter: ExprVisitor, PathVisitor {
     let alloca = addEntryAlloca(type: structType)
     emit(init: alloca, type: expr.type!)
 
-    // Initialize each property.
+    // Initialize each property. Properties that denote the same array binding as an earlier one
+    // are copied bitwise from it, and its storage is retained once for all of them.
+    let repeated = repeatedArrayBindings(in: expr.args)
+    var retains: [Int: Int] = [:]
+    var aliases: Set<Int> = []
+    var fields: [IRValue] = []
+
     for i in 0 ..< expr.args.count {
       let field = builder.buildStructGEP(alloca, type: structType, index: i)
+      fields.append(field)
 
       // Just like for binding initialization, if the property is constant and its the argument is
       // expressed by a constant lvalue, we can create an alias and avoid copying.
@@ -1360,11 +2945,15 @@ public struct Emitter: ExprVisitor, PathVisitor {
         // Emit the lvalue corresponding to the path.
         let (loc, origin) = path.accept(pathVisitor: &self)
         emit(move: loc, type: expr.args[i].type!, to: field)
+        aliases.insert(i)
 
         // Drop the path origin if necessary.
         if let (value, type) = origin {
           emit(drop: value, type: type)
         }
+      } else if let j = repeated[i], !aliases.contains(j) {
+        emit(move: fields[j], type: expr.args[i].type!, to: field)
+        retains[j, default: 0] += 1
       } else if isMovable(expr.args[i]) {
         emit(move: &expr.args[i], to: field)
       } else {
@@ -1373,6 +2962,11 @@ public struct Emitter: ExprVisitor, PathVisitor {
       }
     }
 
+    for (j, n) in retains.sorted(by: { a, b in a.key < b.key }) {
+      _ = builder.buildCall(runtime.arrayRetainN, args: [fields[j], i64(n)])
+    }
+    statistics.recordCoalescedRetains(retains.values.reduce(0, +))
+
     return alloca
   }
 
@@ -1391,8 +2985,11 @@ public struct Emitter: ExprVisitor, PathVisitor {
       env = voidPtr.null()
     } else {
       // Allocate the environment.
-      envType = builder.createStruct(
-        name : "\(function.name).env",
+      // Environments with the same layout share the same type, so that their copy, drop and
+      // equality thunks can be shared as well.
+      let envName = "\(closureEnvPrefix(captures: sortedCaptures)).env"
+      envType = (module.type(named: envName) as? StructType) ?? builder.createStruct(
+        name : envName,
         types: sortedCaptures.map({ _, type in lower(type) }))
       env = builder.buildCall(runtime.malloc, args: [stride(of: envType!)])
 
@@ -1425,6 +3022,17 @@ public struct Emitter: ExprVisitor, PathVisitor {
   }
 
   public mutating func visit(_ expr: inout CallExpr) -> IRValue {
+    // Emit recursive calls in tail position of an in-place function as in-place updates of the
+    // parameter that the function updates.
+    if let reuse = reusableTails,
+       reuse.ranges.contains(expr.range),
+       let path = expr.callee as? NamePath,
+       (bindings[path.name] as? Function)?.name == reuse.function,
+       let variant = module.function(named: "\(reuse.function).inplace\(reuse.position)")
+    {
+      return emit(tailCall: &expr, variant: variant, param: reuse.param, position: reuse.position)
+    }
+
     guard case .func(let params, let output) = expr.callee.type else { unreachable() }
 
     var fun: IRValue
@@ -1434,10 +3042,16 @@ public struct Emitter: ExprVisitor, PathVisitor {
     if let path = expr.callee as? NamePath,
        let f = bindings[path.name] as? Function
     {
-      // The function can be dispatched statically.
-      fun = f
+      // The function can be dispatched statically, possibly to a specialized clone.
+      fun = specialize(f, forArgs: expr.args) ?? f
+      env = voidPtr.null()
+    } else if let path = expr.callee as? NamePath, isGenericBuiltin(path.name) {
+      // Generic built-in functions are instantiated for the type of their arguments.
+      fun = emit(genericBuiltin: path.name, type: path.type!)
       env = voidPtr.null()
     } else {
+      statistics.recordRemark(.closureCallNotDevirtualized(range: expr.callee.range))
+
       // Emit the callee.
       let callee = builder.buildBitCast(expr.callee.accept(&self), type: anyClosureType.ptr)
 
@@ -1453,13 +3067,113 @@ public struct Emitter: ExprVisitor, PathVisitor {
     }
 
     // Emit the arguments.
-    var args: [IRValue] = []
+    let (emittedArgs, tmps) = emit(args: &expr.args)
+    let args = emittedArgs + [env]
+
+    // Emit the call.
+    let result: IRValue
+    if output.isAddressOnly {
+      result = addEntryAlloca(type: lower(output))
+      _ = builder.buildCall(fun, args: [result] + args)
+    } else {
+      result = builder.buildCall(fun, args: args)
+    }
+
+    for (value, type) in tmps {
+      emit(drop: value, type: type)
+    }
+
+    return result
+  }
+
+  /// Emits a recursive call in tail position of an in-place function as an update of the
+  /// parameter that the function updates, and returns a pointer to the parameter's new value,
+  /// moved out of its location.
+  ///
+  /// The argument passed to the parameter is assigned to it first. An array literal reinitializes
+  /// the parameter's storage, so that it is reused if it is uniquely referenced.
+  ///
+  /// - Parameters:
+  ///   - expr: A call to the function of which the in-place function is a variant.
+  ///   - variant: The in-place function.
+  ///   - param: The name of the parameter that `variant` updates.
+  ///   - i: The position of that parameter.
+  private mutating func emit(
+    tailCall expr: inout CallExpr, variant: Function, param: String, position i: Int
+  ) -> IRValue {
+    let loc = bindings[param]!
+    let type = expr.type!
+
+    // Assign the argument to the parameter, unless it is the parameter itself.
+    if var array = expr.args[i] as? ArrayExpr {
+      emit(reinit: loc, with: &array, buffered: array.elems.contains(where: { e in
+        e.uses(param)
+      }))
+      expr.args[i] = array
+    } else if (expr.args[i] as? NamePath)?.name != param {
+      let value = expr.args[i].accept(&self)
+      emit(drop: loc, type: type)
+      emit(move: value, type: type, to: loc)
+    }
+
+    // Update the parameter in place.
+    let (emittedArgs, tmps) = emit(args: &expr.args, skipping: i)
+    var args = emittedArgs
+    args.insert(loc, at: i)
+    args.append(voidPtr.null())
+    _ = builder.buildCall(variant, args: args)
+
+    for (value, type) in tmps {
+      emit(drop: value, type: type)
+    }
+
+    statistics.recordReusedTail()
+    return emit(moveOutOf: loc, type: type)
+  }
+
+  /// Moves the value of a parameter owned by the in-place function being emitted out of its
+  /// location, leaving a zero-initialized value that the function can drop safely.
+  ///
+  /// - Returns: A pointer to the moved value.
+  private func emit(moveOutOf loc: IRValue, type: Type) -> IRValue {
+    let alloca = addEntryAlloca(type: lower(type))
+    emit(move: loc, type: type, to: alloca)
+    emit(init: loc, type: type)
+    return alloca
+  }
+
+  /// Emits the arguments of a call.
+  ///
+  /// Arguments are borrowed by the callee, so the arguments that denote the same array binding as
+  /// an earlier one are passed the address of that argument's value, rather than copies of their
+  /// own.
+  ///
+  /// - Parameters:
+  ///   - args: The arguments to emit.
+  ///   - skipped: The position of an argument that should not be emitted, if any.
+  ///
+  /// - Returns: A pair `(args, tmps)` where `args` are the emitted arguments and `tmps` are the
+  ///   temporary values that must be dropped after the call.
+  private mutating func emit(
+    args: inout [Expr],
+    skipping skipped: Int? = nil
+  ) -> (args: [IRValue], tmps: [(IRValue, Type)]) {
+    var values: [IRValue] = []
     var tmps: [(IRValue, Type)] = []
+    let repeated = repeatedArrayBindings(in: args, skipping: skipped)
+    var positions: [Int: Int] = [:]
+
+    for i in 0 ..< args.count where i != skipped {
+      positions[i] = values.count
+      if let j = repeated[i] {
+        values.append(values[positions[j]!])
+        statistics.recordCoalescedRetains(1)
+        continue
+      }
 
-    for i in 0 ..< expr.args.count {
       // Just like for binding initialization, if the argument is expressed by a constant lvalue,
       // we can create an alias and avoid copying.
-      if var path = expr.args[i] as? NamePath,
+      if var path = args[i] as? NamePath,
          path.mutability! == .let,
          path.type!.isAddressOnly,
          !path.type!.isInoutType,
@@ -1467,31 +3181,16 @@ public struct Emitter: ExprVisitor, PathVisitor {
       {
         // Emit the lvalue corresponding to the path.
         let (loc, origin) = path.accept(pathVisitor: &self)
-        args.append(loc)
+        values.append(loc)
         origin.map({ tmps.append($0) })
       } else {
-        let tmp = expr.args[i].accept(&self)
-        args.append(tmp)
-        tmps.append((tmp, expr.args[i].type!))
+        let tmp = args[i].accept(&self)
+        values.append(tmp)
+        tmps.append((tmp, args[i].type!))
       }
     }
 
-    args.append(env)
-
-    // Emit the call.
-    let result: IRValue
-    if output.isAddressOnly {
-      result = addEntryAlloca(type: lower(output))
-      _ = builder.buildCall(fun, args: [result] + args)
-    } else {
-      result = builder.buildCall(fun, args: args)
-    }
-
-    for (value, type) in tmps {
-      emit(drop: value, type: type)
-    }
-
-    return result
+    return (values, tmps)
   }
 
   public mutating func visit(_ expr: inout InfixExpr) -> IRValue {
@@ -1515,11 +3214,8 @@ public struct Emitter: ExprVisitor, PathVisitor {
         voidPtr.null(),
         to: builder.buildStructGEP(closure, type: anyClosureType, index: 1))
       builder.buildStore(
-        module.function(named: "\(prefix).copy")!,
+        emit(vtableForClosure: prefix, captures: [], envType: nil),
         to: builder.buildStructGEP(closure, type: anyClosureType, index: 2))
-      builder.buildStore(
-        module.function(named: "\(prefix).drop")!,
-        to: builder.buildStructGEP(closure, type: anyClosureType, index: 3))
 
       return closure
     }
@@ -1535,11 +3231,8 @@ public struct Emitter: ExprVisitor, PathVisitor {
       voidPtr.null(),
       to: builder.buildStructGEP(closure, type: anyClosureType, index: 1))
     builder.buildStore(
-      emit(copyFuncForClosure: prefix, captures: [], envType: nil),
+      emit(vtableForClosure: prefix, captures: [], envType: nil),
       to: builder.buildStructGEP(closure, type: anyClosureType, index: 2))
-    builder.buildStore(
-      emit(dropFuncForClosure: prefix, captures: [], envType: nil),
-      to: builder.buildStructGEP(closure, type: anyClosureType, index: 3))
 
     // Emit the function.
     let oldInsertBlock = builder.insertBlock!
@@ -1566,7 +3259,11 @@ public struct Emitter: ExprVisitor, PathVisitor {
     func cont(_ value: IRValue, shouldDrop: Bool) -> IRValue {
       // Update the bindings.
       let oldBindings = bindings
+      let oldConstants = constants
       bindings[expr.decl.name] = value
+      constants[expr.decl.name] = expr.decl.mutability == .let
+        ? constantValue(of: expr.initializer)
+        : nil
 
       // Emit the body of the expression.
       let body = expr.body.accept(&self)
@@ -1578,6 +3275,7 @@ public struct Emitter: ExprVisitor, PathVisitor {
 
       // Restore the bindings.
       bindings = oldBindings
+      constants = oldConstants
       return body
     }
 
@@ -1586,10 +3284,15 @@ public struct Emitter: ExprVisitor, PathVisitor {
       defer { expr.initializer = literal }
 
       // If the function has no local captures, then it can be emitted as a global symbol.
-      let captures = literal.collectCaptures(excluding: { bindings[$0] is Function })
+      let captures = literal.collectCaptures(excluding: { n in
+        (bindings[n] is Function) || isGenericBuiltin(n)
+      })
       if captures.isEmpty {
         let (function, _) = createFunction(literal: &literal, name: expr.decl.name)
+        registerTemplate(literal: literal, function: function)
+        let mark = costMark()
         emitGlobalFunction(literal: &literal, function: function)
+        recordTemplateCost(of: function, since: mark)
         return cont(function, shouldDrop: false)
       }
     }
@@ -1621,11 +3324,14 @@ public struct Emitter: ExprVisitor, PathVisitor {
 
     // If the binding is initialized by an array literal, try to allocate it on the stack.
     if var array = expr.initializer as? ArrayExpr {
-      // If the array is empty, then we can just zero-initialize its structure.
+      // If the array is empty, then we can just zero-initialize its structure. Mutable arrays
+      // must still be dropped, as they may acquire storage (e.g., with `append`).
       if array.elems.isEmpty {
-        alloca = addEntryAlloca(type: anyArrayType, name: expr.decl.name)
+        alloca = addScopedAlloca(type: anyArrayType, name: expr.decl.name)
         builder.buildStore(anyArrayType.null(), to: alloca)
-        return cont(alloca, shouldDrop: false)
+        let result = cont(alloca, shouldDrop: expr.decl.mutability == .var)
+        endScope(ofAlloca: alloca, type: anyArrayType)
+        return result
       }
 
       // Check that the array never escapes and is small enough to be allocated on the stack.
@@ -1636,19 +3342,11 @@ public struct Emitter: ExprVisitor, PathVisitor {
       var analyzer   = ArrayEscapeAnalzyer(name: expr.decl.name)
 
       if arraySize <= maxStackArraySize && !expr.body.accept(&analyzer) {
-        alloca = addEntryAlloca(type: anyArrayType, name: expr.decl.name)
+        alloca = addScopedAlloca(type: anyArrayType, name: expr.decl.name)
         let payload = addEntryAlloca(
-          type: elemIRType, count: i64(array.elems.count), name: expr.decl.name + ".payload")
-
-        for i in 0 ..< array.elems.count {
-          let gep = builder.buildInBoundsGEP(payload, type: elemIRType, indices: [i64(i)])
-          if isMovable(array.elems[i]) {
-            emit(move: &array.elems[i], to: gep)
-          } else {
-            emit(init: gep, type: elemType)
-            emit(copy: &array.elems[i], to: gep)
-          }
-        }
+          type: elemIRType, count: array.elems.count, name: expr.decl.name + ".payload")
+        emitLifetimeStart(of: payload, size: arraySize)
+        emit(elements: &array.elems, type: elemType, toPayload: payload)
 
         builder.buildStore(
           builder.buildBitCast(payload, type: voidPtr),
@@ -1664,40 +3362,81 @@ public struct Emitter: ExprVisitor, PathVisitor {
           }
         }
 
+        emitLifetimeEnd(of: payload, size: arraySize)
+        endScope(ofAlloca: alloca, type: anyArrayType)
         return result
       }
+
+      let reason: String
+      if arraySize > maxStackArraySize {
+        reason = "its \(arraySize) bytes exceed the maximum of \(maxStackArraySize)"
+      } else if analyzer.isCapturedByClosure {
+        reason = "escapes via closure"
+      } else {
+        reason = "escapes its scope"
+      }
+      statistics.recordRemark(
+        .arrayNotStackPromoted(name: expr.decl.name, reason: reason, range: expr.decl.range))
     }
 
-    if isMovable(expr.initializer) {
+    // Storage allocated for the binding itself lives until the end of its scope.
+    var scopedType: IRType? = nil
+
+    // If the binding is the last use of a parameter owned by the in-place function being
+    // emitted, move the parameter's value rather than copying it, and leave a zero-initialized
+    // value that the function can drop safely.
+    if let path = expr.initializer as? NamePath, movableBindings.contains(expr.range) {
+      let loc = bindings[path.name]!
+      scopedType = lower(expr.decl.type!)
+      alloca = addScopedAlloca(type: scopedType!, name: expr.decl.name)
+      emit(move: loc, type: expr.decl.type!, to: alloca)
+      emit(init: loc, type: expr.decl.type!)
+    } else if isMovable(expr.initializer) {
       // Move the initializer's value.
       alloca = expr.initializer.accept(&self)
     } else {
       // Allocate storage for the binding.
-      alloca = addEntryAlloca(type: lower(expr.decl.type!), name: expr.decl.name)
+      scopedType = lower(expr.decl.type!)
+      alloca = addScopedAlloca(type: scopedType!, name: expr.decl.name)
       emit(init: alloca, type: expr.decl.type!)
 
       // Emit the binding's value.
       emit(copy: &expr.initializer, to: alloca)
     }
 
-    return cont(alloca, shouldDrop: true)
+    let result = cont(alloca, shouldDrop: true)
+    if let type = scopedType {
+      endScope(ofAlloca: alloca, type: type)
+    }
+    return result
   }
 
   public mutating func visit(_ expr: inout FuncBindingExpr) -> IRValue {
     // Create the LLVM function.
-    let (function, captures) = createFunction(literal: &expr.literal, name: expr.name)
+    let (function, captures) = createFunction(
+      literal: &expr.literal, name: expr.name, symbol: expr.symbol)
     let sortedCaptures = captures.sorted(by: { a, b in a.key < b.key })
 
     // If the function has no local captures, then it can be emitted as a global symbol.
     if sortedCaptures.isEmpty {
+      let oldConstant = constants.removeValue(forKey: expr.name)
       bindings[expr.name] = function
-      emitGlobalFunction(literal: &expr.literal, function: function)
+      registerTemplate(literal: expr.literal, function: function)
+      let mark = costMark()
+      if !emitHoistingInvariants(literal: &expr.literal, function: function, name: expr.name) {
+        emitGlobalFunction(literal: &expr.literal, function: function)
+      }
+      recordTemplateCost(of: function, since: mark)
+      if expr.symbol != nil {
+        emitExport(of: function, literal: expr.literal)
+      }
 
       // Emit the body of the expression.
       let body = expr.body.accept(&self)
 
       // Restore the bindings.
       bindings[expr.name] = nil
+      constants[expr.name] = oldConstant
       return body
     }
 
@@ -1711,7 +3450,37 @@ public struct Emitter: ExprVisitor, PathVisitor {
       return expr.body.accept(&self)
     }
 
-    if let path = expr.lvalue as? NamePath, path.name == "_" {
+    if var array = expr.rvalue as? ArrayExpr,
+       let root = expr.lvalue.root as? NamePath,
+       root.name != "_"
+    {
+      // Reinitialize the lvalue's storage with the literal, rather than allocating new storage
+      // for the literal and then dropping the lvalue's current value.
+      let (loc, origin) = uniquify(path: &expr.lvalue)
+      assert(origin == nil, "left operand is not a lvalue")
+
+      emit(reinit: loc, with: &array, buffered: array.elems.contains(where: { e in
+        e.uses(root.name)
+      }))
+      expr.rvalue = array
+      statistics.recordFusedArrayAssignment()
+    } else if let (variant, i) = inPlaceVariant(for: expr) {
+      // Update the lvalue in place, rather than copying the result of the call.
+      let (loc, origin) = uniquify(path: &expr.lvalue)
+      assert(origin == nil, "left operand is not a lvalue")
+
+      var call = expr.rvalue as! CallExpr
+      let (emittedArgs, tmps) = emit(args: &call.args, skipping: i)
+      var args = emittedArgs
+      args.insert(loc, at: i)
+      args.append(voidPtr.null())
+      _ = builder.buildCall(variant, args: args)
+
+      for (value, type) in tmps {
+        emit(drop: value, type: type)
+      }
+      expr.rvalue = call
+    } else if let path = expr.lvalue as? NamePath, path.name == "_" {
       // Don't emit an assignment if the lvalue is `_`.
       emit(drop: expr.rvalue.accept(&self), type: expr.rvalue.type!)
     } else {
@@ -1786,6 +3555,7 @@ public struct Emitter: ExprVisitor, PathVisitor {
     let tailBlock = fun.appendBasicBlock(named: "tail")
 
     // Emit the head of the loop condition.
+    loopDepth += 1
     builder.buildBr(headBlock)
     builder.positionAtEnd(of: headBlock)
     let cond = builder.buildTrunc(expr.cond.accept(&self), type: IntType.int1)
@@ -1795,6 +3565,7 @@ public struct Emitter: ExprVisitor, PathVisitor {
     builder.positionAtEnd(of: bodyBlock)
     emit(drop: expr.body.accept(&self), type: expr.body.type!)
     builder.buildBr(headBlock)
+    loopDepth -= 1
 
     // Emit the tail of the loop.
     builder.positionAtEnd(of: tailBlock)
@@ -1826,6 +3597,9 @@ public struct Emitter: ExprVisitor, PathVisitor {
           type: witnessIRType.ptr)
         emit(copy: &expr.value, to: loc)
       } else {
+        statistics.recordRemark(
+          .existentialBoxedOutOfLine(
+            type: expr.value.type!, size: Int(witnessSize), range: expr.range))
         var storage: IRValue = builder.buildCall(runtime.malloc, args: [i64(witnessSize)])
         storage = builder.buildBitCast(storage, type: witnessIRType.ptr)
         emit(copy: &expr.value, to: storage)
@@ -1894,6 +3668,7 @@ public struct Emitter: ExprVisitor, PathVisitor {
     }
 
     if expr.type!.isAddressOnly {
+      recordCopyRemark(for: expr)
       let alloca = addEntryAlloca(type: lower(expr.type!))
       emit(init: alloca, type: expr.type!)
       emit(copy: loc, type: expr.type!, to: alloca)
@@ -1914,6 +3689,7 @@ public struct Emitter: ExprVisitor, PathVisitor {
     // Emit the element's value.
     let result: IRValue
     if expr.type!.isAddressOnly {
+      recordCopyRemark(for: expr)
       let alloca = addEntryAlloca(type: lower(expr.type!))
       emit(init: alloca, type: expr.type!)
       emit(copy: loc, type: expr.type!, to: alloca)
@@ -1962,6 +3738,7 @@ public struct Emitter: ExprVisitor, PathVisitor {
     // Emit the selected member.
     let result: IRValue
     if expr.type!.isAddressOnly {
+      recordCopyRemark(for: expr)
       let alloca = addEntryAlloca(type: lower(expr.type!),  name: expr.name)
       emit(init: alloca, type: expr.type!)
       emit(copy: loc, type: expr.type!, to: alloca)
@@ -2021,6 +3798,9 @@ public struct Emitter: ExprVisitor, PathVisitor {
     assert(pathOrigin == nil)
 
     // Uniquify the base array.
+    if loopDepth > 0 {
+      statistics.recordRemark(.uniqNotHoisted(range: path.range))
+    }
     let elemType = path.type!
     _ = builder.buildCall(runtime.arrayUniq, args: [pathBaseLoc, metatype(of: elemType)])
 
@@ -2067,6 +3847,14 @@ public struct Emitter: ExprVisitor, PathVisitor {
     return expr.type!.isAddressOnly
   }
 
+  /// Records a remark about the copy of the value denoted by the given path, unless its type is
+  /// trivial, in which case the copy is a plain `memcpy`.
+  private func recordCopyRemark(for path: Path) {
+    if !path.type!.isTrivial {
+      statistics.recordRemark(.copyNotElided(type: path.type!, range: path.range))
+    }
+  }
+
   /// Lowers the given semantic type to LLVM.
   ///
   /// - Parameter type: A MVS semantic type to lower.
@@ -2078,6 +3866,8 @@ public struct Emitter: ExprVisitor, PathVisitor {
       return FloatType.double
     case .struct(let name, _):
       return module.type(named: name)!
+    case .string:
+      return stringType
     case .array:
       return anyArrayType
     case .inout(let base):
@@ -2100,6 +3890,8 @@ public struct Emitter: ExprVisitor, PathVisitor {
       return intMetatype
     case .float:
       return floatMetatype
+    case .string:
+      return stringMetatype
     case .struct(let name, _):
       return metatypes[name]!
     case .array(let elemType):
@@ -2185,18 +3977,23 @@ public struct Emitter: ExprVisitor, PathVisitor {
       env,
       to: gep(index: 1))
     builder.buildStore(
-      emit(copyFuncForClosure: function.name, captures: captures, envType: envType),
+      emit(vtableForClosure: function.name, captures: captures, envType: envType),
       to: gep(index: 2))
-    builder.buildStore(
-      emit(dropFuncForClosure: function.name, captures: captures, envType: envType),
-      to: gep(index: 3))
-    builder.buildStore(
-      emit(equalityFuncForClosure: function.name, captures: captures, envType: envType),
-      to: gep(index: 4))
 
     return closure
   }
 
+  /// Returns the name prefix of the thunks and environment type of closures capturing symbols of
+  /// the given types.
+  ///
+  /// The prefix only depends on the semantic types of the captures, in order, so that closures
+  /// whose environments have the same layout share the same copy, drop and equality functions.
+  ///
+  /// - Parameter captures: The closure's captures, sorted by name.
+  private func closureEnvPrefix(captures: [(String, Type)]) -> String {
+    return "_Env" + captures.map({ (_, type) in "." + type.mangled }).joined()
+  }
+
   /// Returns the offset in bytes between successive objects of the specified type, including
   /// alignment padding.
   ///
@@ -2212,7 +4009,7 @@ public struct Emitter: ExprVisitor, PathVisitor {
   ///   - count: An optional number of elements to allocate.
   ///   - name: The name for the newly inserted instruction.
   private func addEntryAlloca(
-    type: IRType, count: IRValue? = nil, name: String = ""
+    type: IRType, count: Int? = nil, name: String = ""
   ) -> IRInstruction {
     // Save the current insertion pointer.
     let oldInsertBlock = builder.insertBlock
@@ -2226,13 +4023,66 @@ public struct Emitter: ExprVisitor, PathVisitor {
     }
 
     // Build the alloca.
-    let alloca = builder.buildAlloca(type: type, count: count, name: name)
+    let alloca = builder.buildAlloca(type: type, count: count.map({ i64($0) }), name: name)
+    statistics.recordFrameSlot(
+      in: builder.currentFunction!.name, bytes: allocationSize(of: type) * (count ?? 1))
 
     // Restore the insertion pointer.
     oldInsertBlock.map(builder.positionAtEnd(of:))
     return alloca
   }
 
+  /// Creates stack storage whose lifetime is delimited by a lexical scope, and marks the start
+  /// of that lifetime.
+  ///
+  /// The storage reuses an alloca of the same type whose scope has ended, if any, so that scopes
+  /// that are disjoint share the same stack slot. The end of the scope must be marked with
+  /// `endScope(ofAlloca:type:)`.
+  ///
+  /// - Parameters:
+  ///   - type: The sized type used to determine the amount of stack memory to allocate.
+  ///   - name: The name for the newly inserted instruction.
+  private mutating func addScopedAlloca(type: IRType, name: String = "") -> IRValue {
+    let fn = builder.currentFunction!.name
+    let size = allocationSize(of: type)
+
+    let alloca: IRValue
+    if let i = allocaPool[fn]?.firstIndex(where: { $0.type.asLLVM() == type.asLLVM() }) {
+      alloca = allocaPool[fn]!.remove(at: i).alloca
+      statistics.recordReusedFrameSlot(in: fn, bytes: size)
+    } else {
+      alloca = addEntryAlloca(type: type, name: name)
+    }
+
+    emitLifetimeStart(of: alloca, size: size)
+    return alloca
+  }
+
+  /// Marks the end of the lifetime of storage created by `addScopedAlloca(type:name:)`, and
+  /// makes it available for reuse.
+  private mutating func endScope(ofAlloca alloca: IRValue, type: IRType) {
+    emitLifetimeEnd(of: alloca, size: allocationSize(of: type))
+    allocaPool[builder.currentFunction!.name, default: []].append((type: type, alloca: alloca))
+  }
+
+  /// Marks the start of the lifetime of the given stack storage.
+  private func emitLifetimeStart(of alloca: IRValue, size: Int) {
+    _ = builder.buildCall(
+      lifetimeStart, args: [i64(size), builder.buildBitCast(alloca, type: voidPtr)])
+  }
+
+  /// Marks the end of the lifetime of the given stack storage.
+  private func emitLifetimeEnd(of alloca: IRValue, size: Int) {
+    _ = builder.buildCall(
+      lifetimeEnd, args: [i64(size), builder.buildBitCast(alloca, type: voidPtr)])
+  }
+
+  /// Returns the number of bytes occupied by an object of the specified type, including alignment
+  /// padding.
+  private func allocationSize(of type: IRType) -> Int {
+    return Int(target.dataLayout.allocationSize(of: type))
+  }
+
   /// Returns a constant of type `i64`.
   private func i64<Z>(_ value: Z) -> IRValue where Z: SignedInteger {
     IntType.int64.constant(value)
@@ -0,0 +1,203 @@
+import AST
+import Basic
+import LLVM
+
+/// A collection of statistics about the code generated by an emitter.
+public final class EmitterStatistics {
+
+  /// A function clone specialized for constant arguments.
+  public struct Specialization {
+
+    /// The name of the original function.
+    public let original: String
+
+    /// The name of the clone, or `nil` if the specialization was rejected.
+    public let clone: String?
+
+    /// The constant parameter bindings that motivated the specialization.
+    public let reasons: [String]
+
+    /// The number of instructions that the clone added to the module.
+    public let growth: Int
+
+  }
+
+  /// The identity of a remark.
+  private struct RemarkKey: Hashable {
+
+    let range: SourceRange
+
+    let message: String
+
+  }
+
+  /// The names of the closures using each closure thunk, indexed by thunk name.
+  private var thunkOwners: [String: Set<String>] = [:]
+
+  /// The number of closure thunks that have been emitted.
+  public var closureThunkCount: Int { thunkOwners.count }
+
+  /// The number of times a closure thunk has been shared by a closure other than the one for
+  /// which it was first emitted.
+  public private(set) var closureThunkReuseCount = 0
+
+  /// The number of instructions that would have been emitted without closure thunk sharing.
+  public private(set) var closureThunkInstructionsSaved = 0
+
+  /// The specializations that have been emitted or rejected, in the order they were considered.
+  public private(set) var specializations: [Specialization] = []
+
+  /// The number of instructions added by specialized clones.
+  public private(set) var specializationGrowth = 0
+
+  /// The number of assignments of array literals that reinitialize the storage of their lvalue
+  /// rather than allocating new storage.
+  public private(set) var fusedArrayAssignmentCount = 0
+
+  /// The number of expressions in tail position of in-place functions that build their value in
+  /// the storage of the parameter being updated, rather than dropping it.
+  public private(set) var reusedTailCount = 0
+
+  /// The number of copies of arrays whose reference count increment has been merged with that of
+  /// another copy of the same storage, or elided.
+  public private(set) var coalescedRetainCount = 0
+
+  /// The number of loop-invariant expressions hoisted out of each recursive function.
+  public private(set) var hoistedInvariants: [(function: String, count: Int)] = []
+
+  /// The number of bytes of stack slots allocated in each function's frame, indexed by function
+  /// name, in the order functions were first seen.
+  public private(set) var frameSizes: [(function: String, bytes: Int)] = []
+
+  /// The number of bytes of stack slots that each function would have allocated without slot
+  /// reuse, indexed by function name.
+  public private(set) var requestedFrameSizes: [String: Int] = [:]
+
+  /// The effect attributes attached to each global function, in the order functions were emitted.
+  public private(set) var effectAttributes: [(function: String, attributes: [String])] = []
+
+  /// The remarks about the optimization decisions of the emitter, in the order they were made.
+  public private(set) var remarks: [Diagnostic] = []
+
+  /// The source ranges and messages of the remarks, used to report each remark once even if the
+  /// code it is about is emitted several times (e.g., in specialized clones).
+  private var remarkKeys: Set<RemarkKey> = []
+
+  /// Creates an empty collection of statistics.
+  public init() {}
+
+  /// Records that the given closure thunk is used by the closure named `owner`.
+  func recordClosureThunkUse(_ thunk: Function, by owner: String) {
+    let (isNew, _) = thunkOwners[thunk.name, default: []].insert(owner)
+    if isNew && thunkOwners[thunk.name]!.count > 1 {
+      closureThunkReuseCount += 1
+      closureThunkInstructionsSaved += thunk.instructionCount
+    }
+  }
+
+  /// Records that a stack slot of `bytes` bytes has been allocated in `function`.
+  func recordFrameSlot(in function: String, bytes: Int) {
+    if let i = frameSizes.firstIndex(where: { $0.function == function }) {
+      frameSizes[i].bytes += bytes
+    } else {
+      frameSizes.append((function: function, bytes: bytes))
+    }
+    requestedFrameSizes[function, default: 0] += bytes
+  }
+
+  /// Records that a stack slot of `bytes` bytes has been reused rather than allocated in
+  /// `function`.
+  func recordReusedFrameSlot(in function: String, bytes: Int) {
+    requestedFrameSizes[function, default: 0] += bytes
+  }
+
+  /// Records that the given effect attributes have been attached to `function`.
+  func recordEffectAttributes(of function: String, attributes: [String]) {
+    effectAttributes.append((function: function, attributes: attributes))
+  }
+
+  /// Records the given remark, unless it has already been recorded.
+  func recordRemark(_ remark: Diagnostic) {
+    let key = RemarkKey(range: remark.range, message: remark.message)
+    if remarkKeys.insert(key).inserted {
+      remarks.append(remark)
+    }
+  }
+
+  /// Records that an assignment of an array literal has been fused with the drop of its lvalue.
+  func recordFusedArrayAssignment() {
+    fusedArrayAssignmentCount += 1
+  }
+
+  /// Records that an expression in tail position of an in-place function has been built in the
+  /// storage of the parameter being updated.
+  func recordReusedTail() {
+    reusedTailCount += 1
+  }
+
+  /// Records that the reference count increments of `count` copies of arrays have been merged
+  /// with that of another copy, or elided.
+  func recordCoalescedRetains(_ count: Int) {
+    coalescedRetainCount += count
+  }
+
+  /// Records that `count` loop-invariant expressions have been hoisted out of `function`.
+  func recordHoistedInvariants(in function: String, count: Int) {
+    hoistedInvariants.append((function: function, count: count))
+  }
+
+  /// Records that `original` has been specialized as `clone`.
+  func recordSpecialization(of original: String, as clone: String, reasons: [String], growth: Int) {
+    specializations.append(
+      Specialization(original: original, clone: clone, reasons: reasons, growth: growth))
+    specializationGrowth += growth
+  }
+
+  /// Records that a specialization of `original` has been rejected for lack of budget.
+  func recordRejectedSpecialization(of original: String, reasons: [String]) {
+    specializations.append(
+      Specialization(original: original, clone: nil, reasons: reasons, growth: 0))
+  }
+
+}
+
+extension EmitterStatistics: CustomStringConvertible {
+
+  public var description: String {
+    var lines = [
+      "closure thunks emitted: \(closureThunkCount)",
+      "closure thunks reused: \(closureThunkReuseCount)",
+      "closure thunk instructions saved: \(closureThunkInstructionsSaved)",
+      "specialization growth: \(specializationGrowth) instructions",
+      "fused array assignments: \(fusedArrayAssignmentCount)",
+      "storage-reusing tails: \(reusedTailCount)",
+      "coalesced array retains: \(coalescedRetainCount)",
+    ]
+
+    for (function, count) in hoistedInvariants {
+      lines.append("hoisted \(count) loop-invariant expression(s) out of \(function)")
+    }
+
+    for (function, attributes) in effectAttributes {
+      lines.append("effects of \(function): \(attributes.joined(separator: ", "))")
+    }
+
+    for (function, bytes) in frameSizes {
+      let requested = requestedFrameSizes[function] ?? bytes
+      lines.append("frame of \(function): \(bytes) bytes (\(requested) bytes without slot reuse)")
+    }
+
+    for spec in specializations {
+      let reasons = spec.reasons.joined(separator: ", ")
+      if let clone = spec.clone {
+        lines.append(
+          "specialized \(spec.original) as \(clone) for \(reasons) (+\(spec.growth) instructions)")
+      } else {
+        lines.append("did not specialize \(spec.original) for \(reasons): over budget")
+      }
+    }
+
+    return lines.joined(separator: "\n")
+  }
+
+}
@@ -0,0 +1,26 @@
+import cllvm
+import LLVM
+
+extension Function {
+
+  /// The number of instructions in the function's body.
+  var instructionCount: Int {
+    return basicBlocks.reduce(0, { count, block in
+      count + block.instructions.reduce(0, { n, _ in n + 1 })
+    })
+  }
+
+  /// Adds the enum attribute with the given name to the function.
+  ///
+  /// This method supports attributes that `AttributeKind` does not enumerate (e.g., `willreturn`).
+  /// It does nothing if the attribute is unknown to the LLVM library.
+  func addFunctionAttribute(named name: String) {
+    let kind = LLVMGetEnumAttributeKindForName(name, name.utf8.count)
+    guard kind != 0 else { return }
+
+    let context = LLVMGetTypeContext(LLVMTypeOf(asLLVM()))
+    let attribute = LLVMCreateEnumAttribute(context, kind, 0)
+    LLVMAddAttributeAtIndex(asLLVM(), LLVMAttributeIndex(UInt32.max), attribute)
+  }
+
+}
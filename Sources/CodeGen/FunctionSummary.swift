@@ -0,0 +1,19 @@
+/// A summary of the properties of a function exported by a module, that modules importing it use
+/// to optimize their calls without access to its body.
+public struct FunctionSummary: Codable {
+
+  /// The side effects of the function.
+  var effects: EffectSummary
+
+  /// The positions of the parameters that the function can update in place, when the result of a
+  /// call is assigned to the argument passed to them.
+  ///
+  /// The module exports an in-place variant of the function for each of these parameters, which
+  /// consumes the argument instead of copying it, so that assignments of the form `x = f(x)` do
+  /// not allocate a new value.
+  public var inPlaceParams: [Int]
+
+  /// The number of LLVM instructions in the function's body, before optimizations.
+  public var instructionCount: Int
+
+}
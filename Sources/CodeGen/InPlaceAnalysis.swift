@@ -0,0 +1,299 @@
+import AST
+import Basic
+
+/// An AST visitor that determines whether an expression refers to a given binding.
+struct NameUseFinder: ExprVisitor {
+
+  typealias ExprResult = Bool
+
+  /// The name of the binding to look for.
+  let name: String
+
+  mutating func visit(_ expr: inout IntExpr) -> Bool {
+    return false
+  }
+
+  mutating func visit(_ expr: inout FloatExpr) -> Bool {
+    return false
+  }
+
+  mutating func visit(_ expr: inout StringExpr) -> Bool {
+    return false
+  }
+
+  mutating func visit(_ expr: inout ArrayExpr) -> Bool {
+    for i in 0 ..< expr.elems.count {
+      if expr.elems[i].accept(&self) {
+        return true
+      }
+    }
+
+    return false
+  }
+
+  mutating func visit(_ expr: inout StructExpr) -> Bool {
+    for i in 0 ..< expr.args.count {
+      if expr.args[i].accept(&self) {
+        return true
+      }
+    }
+
+    return false
+  }
+
+  mutating func visit(_ expr: inout FuncExpr) -> Bool {
+    let captures = expr.collectCaptures()
+    return captures[name] != nil
+  }
+
+  mutating func visit(_ expr: inout CallExpr) -> Bool {
+    if expr.callee.accept(&self) {
+      return true
+    }
+
+    for i in 0 ..< expr.args.count {
+      if expr.args[i].accept(&self) {
+        return true
+      }
+    }
+
+    return false
+  }
+
+  mutating func visit(_ expr: inout InfixExpr) -> Bool {
+    return expr.lhs.accept(&self)
+        || expr.rhs.accept(&self)
+  }
+
+  mutating func visit(_ expr: inout OperExpr) -> Bool {
+    return false
+  }
+
+  mutating func visit(_ expr: inout InoutExpr) -> Bool {
+    return expr.path.accept(&self)
+  }
+
+  mutating func visit(_ expr: inout BindingExpr) -> Bool {
+    if expr.initializer.accept(&self) {
+      return true
+    }
+
+    return (expr.decl.name != name) && expr.body.accept(&self)
+  }
+
+  mutating func visit(_ expr: inout FuncBindingExpr) -> Bool {
+    return (expr.name != name)
+        && (expr.body.accept(&self) || expr.literal.accept(&self))
+  }
+
+  mutating func visit(_ expr: inout AssignExpr) -> Bool {
+    return expr.lvalue.accept(&self)
+        || expr.rvalue.accept(&self)
+        || expr.body.accept(&self)
+  }
+
+  mutating func visit(_ expr: inout CondExpr) -> Bool {
+    return expr.cond.accept(&self)
+        || expr.succ.accept(&self)
+        || expr.fail.accept(&self)
+  }
+
+  mutating func visit(_ expr: inout WhileExpr) -> Bool {
+    return expr.cond.accept(&self)
+        || expr.body.accept(&self)
+        || expr.tail.accept(&self)
+  }
+
+  mutating func visit(_ expr: inout CastExpr) -> Bool {
+    return expr.value.accept(&self)
+  }
+
+  mutating func visit(_ expr: inout ErrorExpr) -> Bool {
+    return false
+  }
+
+  mutating func visit(_ expr: inout NamePath) -> Bool {
+    return expr.name == name
+  }
+
+  mutating func visit(_ expr: inout PropPath) -> Bool {
+    return expr.base.accept(&self)
+  }
+
+  mutating func visit(_ expr: inout ElemPath) -> Bool {
+    return expr.base.accept(&self)
+        || expr.index.accept(&self)
+  }
+
+}
+
+extension Expr {
+
+  /// Returns whether this expression refers to the binding with the given name.
+  func uses(_ name: String) -> Bool {
+    var expr: Expr = self
+    var finder = NameUseFinder(name: name)
+    return expr.accept(&finder)
+  }
+
+}
+
+/// Returns the source ranges of the bindings that are initialized by the last use of the given
+/// parameter in the body of a function.
+///
+/// A binding `var x = p in e` is the last use of `p` if `e` does not refer to `p` and the binding
+/// is in tail position, i.e., no other part of the function's body is evaluated after it.
+/// Bindings in the body of a loop are never in tail position.
+///
+/// Constant bindings initialized by a path rooted at `p` (e.g., `let y = p[0] in ...`) are emitted
+/// as aliases of `p`'s storage, which is mutated in place once moved. Hence, a binding is not the
+/// last use of `p` if its body refers to such an alias.
+///
+/// - Parameters:
+///   - name: The name of a parameter.
+///   - body: The body of the function declaring the parameter.
+func lastUseBindings(of name: String, in body: Expr) -> Set<SourceRange> {
+  var result: Set<SourceRange> = []
+
+  func walk(_ expr: Expr, aliases: Set<String>) {
+    switch expr {
+    case let e as BindingExpr:
+      if let path = e.initializer as? NamePath,
+         path.name == name,
+         e.decl.type == path.type,
+         !e.body.uses(name),
+         !aliases.contains(where: { e.body.uses($0) })
+      {
+        result.insert(e.range)
+      }
+      if e.decl.name != name {
+        var newAliases = aliases
+        if e.decl.mutability == .let,
+           let path = e.initializer as? Path,
+           let root = path.root as? NamePath,
+           (root.name == name) || aliases.contains(root.name)
+        {
+          newAliases.insert(e.decl.name)
+        } else {
+          newAliases.remove(e.decl.name)
+        }
+        walk(e.body, aliases: newAliases)
+      }
+
+    case let e as FuncBindingExpr:
+      if e.name != name {
+        var newAliases = aliases
+        newAliases.remove(e.name)
+        walk(e.body, aliases: newAliases)
+      }
+
+    case let e as AssignExpr:
+      walk(e.body, aliases: aliases)
+
+    case let e as CondExpr:
+      walk(e.succ, aliases: aliases)
+      walk(e.fail, aliases: aliases)
+
+    case let e as WhileExpr:
+      walk(e.tail, aliases: aliases)
+
+    default:
+      break
+    }
+  }
+
+  walk(body, aliases: [])
+  return result
+}
+
+/// Returns the source ranges of the expressions in tail position of the body of a function that
+/// can build their value in the storage of the given parameter, once the function owns it.
+///
+/// An in-place variant drops the value of the parameter it updates after having computed its
+/// result. Instead, an array literal in tail position can reinitialize the parameter's storage,
+/// which is reused if it is uniquely referenced, and a call `f(..., e, ...)` in tail position
+/// that passes `e` to the same parameter of a recursive call can assign `e` to the parameter and
+/// then update it in place. The emitter checks that the callee of such a call is the function
+/// itself.
+///
+/// The other arguments of a call must not refer to the parameter, nor to any constant binding
+/// aliasing its storage, as they are evaluated after the parameter has been reassigned. Likewise,
+/// the elements of a literal reinitializing the parameter's storage must not refer to such an
+/// alias, as only those referring to the parameter are evaluated before its storage is reused.
+///
+/// - Parameters:
+///   - name: The name of a parameter.
+///   - position: The position of the parameter.
+///   - body: The body of the function declaring the parameter.
+///   - movable: The bindings that are the last use of the parameter, whose bodies are skipped
+///     as the parameter's value has been moved.
+func tailsReusingStorage(
+  of name: String, at position: Int, in body: Expr, skipping movable: Set<SourceRange>
+) -> Set<SourceRange> {
+  var result: Set<SourceRange> = []
+
+  func isReusable(_ array: ArrayExpr, aliases: Set<String>) -> Bool {
+    return !aliases.contains(where: { alias in array.elems.contains(where: { $0.uses(alias) }) })
+  }
+
+  func walk(_ expr: Expr, aliases: Set<String>) {
+    switch expr {
+    case let e as BindingExpr:
+      if e.decl.name != name && !movable.contains(e.range) {
+        var newAliases = aliases
+        if e.decl.mutability == .let,
+           let path = e.initializer as? Path,
+           let root = path.root as? NamePath,
+           (root.name == name) || aliases.contains(root.name)
+        {
+          newAliases.insert(e.decl.name)
+        } else {
+          newAliases.remove(e.decl.name)
+        }
+        walk(e.body, aliases: newAliases)
+      }
+
+    case let e as FuncBindingExpr:
+      if e.name != name {
+        var newAliases = aliases
+        newAliases.remove(e.name)
+        walk(e.body, aliases: newAliases)
+      }
+
+    case let e as AssignExpr:
+      walk(e.body, aliases: aliases)
+
+    case let e as CondExpr:
+      walk(e.succ, aliases: aliases)
+      walk(e.fail, aliases: aliases)
+
+    case let e as WhileExpr:
+      walk(e.tail, aliases: aliases)
+
+    case let e as ArrayExpr:
+      if isReusable(e, aliases: aliases) {
+        result.insert(e.range)
+      }
+
+    case let e as CallExpr:
+      guard e.callee is NamePath,
+            e.args.count > position,
+            !e.args.contains(where: { $0 is InoutExpr })
+      else { return }
+
+      for i in 0 ..< e.args.count where i != position {
+        if e.args[i].uses(name) || aliases.contains(where: { e.args[i].uses($0) }) { return }
+      }
+      if let array = e.args[position] as? ArrayExpr, !isReusable(array, aliases: aliases) {
+        return
+      }
+      result.insert(e.range)
+
+    default:
+      break
+    }
+  }
+
+  walk(body, aliases: [])
+  return result
+}
@@ -0,0 +1,319 @@
+import AST
+
+/// An AST transformer that hoists loop-invariant computations out of a recursive function.
+///
+/// Loops are typically written as recursive functions that forward some of their parameters
+/// unchanged to their recursive calls. Expressions that only depend on these parameters, called
+/// invariant parameters, compute the same value at each iteration. The hoister replaces them with
+/// references to new parameters, that are also forwarded to the recursive calls, so that they can
+/// be computed once by the function's callers.
+///
+/// Only expressions that can't trap nor diverge are hoisted, as they may be evaluated on paths
+/// that didn't evaluate them before (e.g., if they occur in a branch of a conditional). Hence,
+/// expressions involving calls (except to `sqrt`), array subscripts, integer divisions and casts
+/// are never hoisted.
+struct InvariantHoister: ExprVisitor {
+
+  typealias ExprResult = Void
+
+  /// A hoisted expression, together with the name of the parameter that replaces it.
+  typealias Hoisted = (name: String, value: Expr)
+
+  /// The name of the function.
+  let name: String
+
+  /// The names of the function's invariant parameters.
+  private var invariants: Set<String> = []
+
+  /// The expressions that have been hoisted.
+  private var hoisted: [Hoisted] = []
+
+  /// Indicates whether the hoister is forwarding the hoisted values to the recursive calls,
+  /// rather than hoisting expressions.
+  private var isForwarding = false
+
+  /// The maximum number of expressions to hoist.
+  let maxHoistedCount = 8
+
+  /// A predicate that indicates whether a name refers to the built-in `sqrt` function.
+  let isSqrt: (String) -> Bool
+
+  init(name: String, isSqrt: @escaping (String) -> Bool) {
+    self.name = name
+    self.isSqrt = isSqrt
+  }
+
+  /// Hoists the invariant computations out of the given function literal.
+  ///
+  /// - Returns: A pair `(body, hoisted)` where `body` is the rewritten body of the function, in
+  ///   which recursive calls pass the hoisted values as additional arguments, and `hoisted` is
+  ///   the list of hoisted expressions, or `nil` if nothing could be hoisted.
+  mutating func hoist(from literal: FuncExpr) -> (body: Expr, hoisted: [Hoisted])? {
+    // Identify the invariant parameters.
+    let params = literal.params.map({ $0.name })
+    var candidates = Set(
+      literal.params.enumerated().compactMap({ (i, param) -> Int? in
+        param.type!.isInoutType ? nil : i
+      }))
+
+    var isRecursive = false
+    guard analyze(
+      literal.body, params: params, candidates: &candidates, isRecursive: &isRecursive)
+    else { return nil }
+    guard isRecursive else { return nil }
+    invariants = Set(candidates.map({ params[$0] }))
+
+    // Hoist the invariant computations.
+    var body = literal.body
+    rewrite(&body)
+    guard !hoisted.isEmpty else { return nil }
+
+    // Forward the hoisted values to the recursive calls.
+    isForwarding = true
+    rewrite(&body)
+    return (body, hoisted)
+  }
+
+  // MARK: Analysis
+
+  /// Analyzes the body of the function, removing from `candidates` the positions of parameters
+  /// that aren't forwarded unchanged to recursive calls.
+  ///
+  /// - Returns: `false` if the function's body refers to the function other than as the callee
+  ///   of a call, or if it shadows the function, one of its parameters or `sqrt`.
+  private func analyze(
+    _ expr: Expr,
+    params: [String],
+    candidates: inout Set<Int>,
+    isRecursive: inout Bool
+  ) -> Bool {
+    func walk(_ expr: Expr) -> Bool {
+      return analyze(expr, params: params, candidates: &candidates, isRecursive: &isRecursive)
+    }
+
+    func isShadowing(_ n: String) -> Bool {
+      return (n == name) || (n == "sqrt") || params.contains(n)
+    }
+
+    switch expr {
+    case let e as CallExpr:
+      if let callee = e.callee as? NamePath, callee.name == name {
+        isRecursive = true
+        guard e.args.count == params.count else { return false }
+        candidates = candidates.filter({ i in (e.args[i] as? NamePath)?.name == params[i] })
+      } else if !walk(e.callee) {
+        return false
+      }
+      return e.args.allSatisfy(walk)
+
+    case let e as NamePath:
+      return e.name != name
+
+    case let e as FuncExpr:
+      var literal = e
+      return literal.collectCaptures()[name] == nil
+
+    case let e as FuncBindingExpr:
+      var literal = e.literal
+      return !isShadowing(e.name)
+          && (literal.collectCaptures()[name] == nil)
+          && walk(e.body)
+
+    case let e as BindingExpr:
+      return !isShadowing(e.decl.name)
+          && walk(e.initializer)
+          && walk(e.body)
+
+    case let e as ArrayExpr:
+      return e.elems.allSatisfy(walk)
+
+    case let e as StructExpr:
+      return e.args.allSatisfy(walk)
+
+    case let e as InfixExpr:
+      return walk(e.lhs) && walk(e.rhs)
+
+    case let e as InoutExpr:
+      return walk(e.path)
+
+    case let e as AssignExpr:
+      return walk(e.lvalue) && walk(e.rvalue) && walk(e.body)
+
+    case let e as CondExpr:
+      return walk(e.cond) && walk(e.succ) && walk(e.fail)
+
+    case let e as WhileExpr:
+      return walk(e.cond) && walk(e.body) && walk(e.tail)
+
+    case let e as CastExpr:
+      return walk(e.value)
+
+    case let e as PropPath:
+      return walk(e.base)
+
+    case let e as ElemPath:
+      return walk(e.base) && walk(e.index)
+
+    default:
+      return true
+    }
+  }
+
+  // MARK: Rewriting
+
+  /// Returns whether the given expression can be hoisted.
+  private func isHoistable(_ expr: Expr) -> Bool {
+    switch expr {
+    case is IntExpr, is FloatExpr:
+      return true
+
+    case let e as NamePath:
+      return invariants.contains(e.name)
+
+    case let e as PropPath:
+      return isHoistable(e.base)
+
+    case let e as ArrayExpr:
+      return e.elems.allSatisfy(isHoistable)
+
+    case let e as StructExpr:
+      return e.args.allSatisfy(isHoistable)
+
+    case let e as InfixExpr:
+      // Integer divisions trap on zero.
+      if (e.oper.kind == .div) && (e.lhs.type == .int) { return false }
+      return isHoistable(e.lhs) && isHoistable(e.rhs)
+
+    case let e as CallExpr:
+      guard let callee = e.callee as? NamePath, isSqrt(callee.name) else { return false }
+      return e.args.allSatisfy(isHoistable)
+
+    default:
+      return false
+    }
+  }
+
+  /// Returns whether hoisting the given expression saves any computation.
+  private func isWorthHoisting(_ expr: Expr) -> Bool {
+    switch expr {
+    case is IntExpr, is FloatExpr, is NamePath:
+      return false
+    case let e as PropPath:
+      return isWorthHoisting(e.base)
+    default:
+      return true
+    }
+  }
+
+  /// Hoists the given expression if possible, or rewrites its sub-expressions otherwise.
+  private mutating func rewrite(_ expr: inout Expr) {
+    if !isForwarding
+        && (hoisted.count < maxHoistedCount)
+        && isHoistable(expr)
+        && isWorthHoisting(expr)
+    {
+      let paramName = "$\(name).inv\(hoisted.count)"
+      hoisted.append((name: paramName, value: expr))
+
+      var path = NamePath(name: paramName, range: expr.range)
+      path.type = expr.type
+      path.mutability = .let
+      expr = path
+    } else {
+      expr.accept(&self)
+    }
+  }
+
+  mutating func visit(_ expr: inout IntExpr) {}
+
+  mutating func visit(_ expr: inout FloatExpr) {}
+
+  mutating func visit(_ expr: inout StringExpr) {}
+
+  mutating func visit(_ expr: inout ArrayExpr) {
+    for i in 0 ..< expr.elems.count {
+      rewrite(&expr.elems[i])
+    }
+  }
+
+  mutating func visit(_ expr: inout StructExpr) {
+    for i in 0 ..< expr.args.count {
+      rewrite(&expr.args[i])
+    }
+  }
+
+  mutating func visit(_ expr: inout FuncExpr) {
+    // Nested functions are emitted on their own.
+  }
+
+  mutating func visit(_ expr: inout CallExpr) {
+    for i in 0 ..< expr.args.count {
+      rewrite(&expr.args[i])
+    }
+
+    if let callee = expr.callee as? NamePath, callee.name == name {
+      guard isForwarding else { return }
+      for h in hoisted {
+        var path = NamePath(name: h.name, range: expr.range)
+        path.type = h.value.type
+        path.mutability = .let
+        expr.args.append(path)
+      }
+    } else {
+      rewrite(&expr.callee)
+    }
+  }
+
+  mutating func visit(_ expr: inout InfixExpr) {
+    rewrite(&expr.lhs)
+    rewrite(&expr.rhs)
+  }
+
+  mutating func visit(_ expr: inout OperExpr) {}
+
+  mutating func visit(_ expr: inout InoutExpr) {}
+
+  mutating func visit(_ expr: inout BindingExpr) {
+    rewrite(&expr.initializer)
+    rewrite(&expr.body)
+  }
+
+  mutating func visit(_ expr: inout FuncBindingExpr) {
+    rewrite(&expr.body)
+  }
+
+  mutating func visit(_ expr: inout AssignExpr) {
+    rewrite(&expr.rvalue)
+    rewrite(&expr.body)
+  }
+
+  mutating func visit(_ expr: inout CondExpr) {
+    rewrite(&expr.cond)
+    rewrite(&expr.succ)
+    rewrite(&expr.fail)
+  }
+
+  mutating func visit(_ expr: inout WhileExpr) {
+    rewrite(&expr.cond)
+    rewrite(&expr.body)
+    rewrite(&expr.tail)
+  }
+
+  mutating func visit(_ expr: inout CastExpr) {
+    rewrite(&expr.value)
+  }
+
+  mutating func visit(_ expr: inout ErrorExpr) {}
+
+  mutating func visit(_ expr: inout NamePath) {}
+
+  mutating func visit(_ expr: inout PropPath) {
+    rewrite(&expr.base)
+  }
+
+  mutating func visit(_ expr: inout ElemPath) {
+    rewrite(&expr.base)
+    rewrite(&expr.index)
+  }
+
+}
@@ -0,0 +1,10 @@
+import LLVM
+
+extension Module {
+
+  /// The number of instructions in the module's functions.
+  var instructionCount: Int {
+    return functions.reduce(0, { count, fn in count + fn.instructionCount })
+  }
+
+}
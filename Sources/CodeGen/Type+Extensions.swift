@@ -19,7 +19,38 @@ extension Type {
       return true
     case .struct(name: _, let props):
       return props.allSatisfy({ $0.type.isTrivial })
-    case .array, .func, .any:
+    case .string, .array, .func, .any:
+      return false
+    }
+  }
+
+  /// Returns whether the zero-initialized representation of this type can be dropped.
+  ///
+  /// Zero-initialized arrays and closures have no storage nor environment to release, whereas
+  /// existential containers require a value witness.
+  var isZeroDroppable: Bool {
+    switch self {
+    case .int, .float, .string, .array, .func:
+      return true
+    case .struct(name: _, let props):
+      return props.allSatisfy({ $0.type.isZeroDroppable })
+    case .any, .inout, .error:
+      return false
+    }
+  }
+
+  /// Returns whether instances of this type can be compared for equality with a mere bitwise
+  /// comparison of their representation.
+  ///
+  /// Floating-point values are excluded, as `NaN` is not equal to itself and `-0.0` is equal to
+  /// `+0.0` even though their representations differ.
+  var isBitwiseComparable: Bool {
+    switch self {
+    case .int:
+      return true
+    case .struct(name: _, let props):
+      return props.allSatisfy({ $0.type.isBitwiseComparable })
+    default:
       return false
     }
   }
@@ -29,6 +60,7 @@ extension Type {
     switch self {
     case .int   : return "I"
     case .float : return "F"
+    case .string: return "S"
     case .any   : return "A"
     case .error : return "E"
 
@@ -4,6 +4,7 @@ import LLVM
 
 import AST
 import CodeGen
+import Modules
 import Parse
 import Sema
 
@@ -21,6 +22,23 @@ struct MVS: ParsableCommand {
   @Option(help: "Set the maximum size for stack-allocated arrays.")
   var maxStackArraySize: Int = 256
 
+  @Option(help: "Set the maximum number of instructions added by call-site specialization.")
+  var specializationBudget: Int = 2048
+
+  @Option(help: "Set the maximum size of the functions that modules export for inlining.")
+  var inlineThreshold: Int = 64
+
+  @Option(
+    name: [.customShort("I")],
+    help: "Add a directory to the search paths of imported modules.",
+    transform: URL.init(fileURLWithPath:))
+  var importPaths: [URL] = []
+
+  @Flag(
+    name: .customLong("module"),
+    help: "Compile the input as a module, producing an object file and an interface.")
+  var compileModule: Bool = false
+
   @Flag(help: "Dump the LLVM representation of the program.")
   var emitLLVM: Bool = false
 
@@ -30,21 +48,13 @@ struct MVS: ParsableCommand {
   @Flag(help: "Disable the printing of the program's value.")
   var noPrint: Bool = false
 
-  func run() throws {
-    let input = try String(contentsOf: inputFile)
+  @Flag(help: "Print code generation statistics.")
+  var stats: Bool = false
 
-    // Create a diagnostic consumer.
-    let console = Console(source: input)
+  @Flag(help: "Report the optimization decisions of the code generator, mapped to the source.")
+  var remarks: Bool = false
 
-    // Parse the program.
-    var parser = MVSParser()
-    guard var program = parser.parse(source: input, diagConsumer: console) else { return }
-
-    // Type check the program.
-    var checker = TypeChecker(diagConsumer: console)
-    guard checker.visit(&program) else { return }
-
-    // Emit the program's IR.
+  func run() throws {
     let mode: EmitterMode
     if let n = benchmark {
       precondition(n > 0, "number of runs should be greater than 0")
@@ -55,14 +65,64 @@ struct MVS: ParsableCommand {
       mode = .debug
     }
 
+    // Create a loader for the modules imported by the input, which are searched in the directory
+    // of the input first.
     let target = try TargetMachine()
+    var loader = ModuleLoader(
+      searchPaths: [inputFile.deletingLastPathComponent()] + importPaths,
+      options: CompilerOptions(
+        mode                : mode,
+        maxStackArraySize   : maxStackArraySize,
+        specializationBudget: specializationBudget,
+        inlineThreshold     : inlineThreshold),
+      target: target)
+
+    // Modules are compiled next to their source, unless they are up to date.
+    if compileModule {
+      _ = try loader.load(inputFile.deletingPathExtension().lastPathComponent)
+      return
+    }
+
+    let input = try String(contentsOf: inputFile)
+
+    // Create a diagnostic consumer.
+    let console = Console(source: input)
+
+    // Load the imported modules, recompiling those that are out of date.
+    var parser = MVSParser()
+    let imports = parser.parseImports(source: input, diagConsumer: console)
+    let imported = try loader.load(imports: imports.map({ $0.name }))
+
+    // Parse the program.
+    guard var program = parser.parse(
+      source: input, knownStructs: imported.structNames, diagConsumer: console)
+    else { return }
+    guard imported.add(to: &program, diagConsumer: console) else { return }
+
+    // Type check the program.
+    var checker = TypeChecker(diagConsumer: console)
+    guard checker.visit(&program) else { return }
+
+    // Emit the program's IR.
     var emitter = try Emitter(
-      target            : target,
-      mode              : mode,
-      shouldEmitPrint   : !noPrint,
-      maxStackArraySize : maxStackArraySize)
+      target              : target,
+      mode                : mode,
+      shouldEmitPrint     : !noPrint,
+      maxStackArraySize   : maxStackArraySize,
+      specializationBudget: specializationBudget)
+    emitter.importedSummaries = imported.summaries
     let module = try emitter.emit(program: &program)
 
+    if stats {
+      console.error(emitter.statistics.description + "\n")
+    }
+
+    if remarks {
+      for remark in emitter.statistics.remarks {
+        console.consume(remark)
+      }
+    }
+
     if emitLLVM {
       module.dump()
     } else {
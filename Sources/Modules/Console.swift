@@ -3,12 +3,16 @@ import Foundation
 import AST
 import Basic
 
-struct Console: DiagnosticConsumer {
+public struct Console: DiagnosticConsumer {
 
   /// The source input of the lexer.
-  let source: String
+  public let source: String
 
-  func consume(_ diagnostic: Diagnostic) {
+  public init(source: String) {
+    self.source = source
+  }
+
+  public func consume(_ diagnostic: Diagnostic) {
     let start = diagnostic.range.lowerBound < source.endIndex
       ? diagnostic.range.lowerBound
       : source.lastIndex(where: { _ in true })
@@ -86,7 +90,7 @@ struct Console: DiagnosticConsumer {
   /// Writes the given message to the standard error.
   ///
   /// - Parameter string: A message.
-  func error<S>(_ string: S) where S: StringProtocol {
+  public func error<S>(_ string: S) where S: StringProtocol {
     FileHandle.standardError.write(string.data(using: .utf8)!)
   }
 
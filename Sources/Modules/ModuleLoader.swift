@@ -0,0 +1,455 @@
+import Foundation
+import LLVM
+
+import AST
+import CodeGen
+import Parse
+import Sema
+
+/// The configuration of the code generator, shared by a program and the modules it imports.
+public struct CompilerOptions {
+
+  /// The code generation mode.
+  public var mode: EmitterMode
+
+  /// The maximum size for stack-allocated arrays.
+  public var maxStackArraySize: Int
+
+  /// The maximum number of instructions added by call-site specialization, in each module.
+  public var specializationBudget: Int
+
+  /// The maximum number of instructions of a function whose body is exported for inlining.
+  public var inlineThreshold: Int
+
+  public init(
+    mode                : EmitterMode,
+    maxStackArraySize   : Int,
+    specializationBudget: Int,
+    inlineThreshold     : Int
+  ) {
+    self.mode = mode
+    self.maxStackArraySize = maxStackArraySize
+    self.specializationBudget = specializationBudget
+    self.inlineThreshold = inlineThreshold
+  }
+
+}
+
+/// The interface of a compiled module, which is written next to its object file.
+///
+/// An interface lets other modules type check and optimize their uses of a module without parsing,
+/// checking or emitting its source.
+public struct ModuleInterface: Codable {
+
+  /// The name of the module.
+  public var name: String
+
+  /// A hash of the module's source and of the options with which it was compiled.
+  public var sourceHash: String
+
+  /// The names of the modules imported by the module, in order.
+  public var imports: [String]
+
+  /// The fingerprints of the modules on which the module depends, directly or transitively, at
+  /// the time it was compiled, indexed by name.
+  public var dependencies: [String: String]
+
+  /// The declarations of the module, in MVS syntax.
+  ///
+  /// Functions are declared by their signature, or defined by their body if it is small enough
+  /// to be inlined in the modules that import them.
+  public var declarations: String
+
+  /// The optimization summaries of the module's functions, indexed by name.
+  public var summaries: [String: FunctionSummary]
+
+  /// A hash of the declarations and summaries of the module. Modules that depend on this module
+  /// must be recompiled when it changes.
+  public var fingerprint: String
+
+}
+
+/// The declarations that a program or module imports from other modules.
+public struct ImportedDeclarations {
+
+  /// The structs declared by the imported modules.
+  public var types: [StructDecl] = []
+
+  /// The functions declared by the imported modules, whose bodies are not exported.
+  public var funcs: [FuncDecl] = []
+
+  /// The functions defined by the imported modules whose bodies are exported, in order.
+  public var inlinableFuncs: [FuncBindingExpr] = []
+
+  /// The summaries of the imported functions, indexed by symbol.
+  public var summaries: [String: FunctionSummary] = [:]
+
+  /// The fingerprints of the imported modules, indexed by name.
+  public var fingerprints: [String: String] = [:]
+
+  /// The modules defining the imported functions, indexed by function name.
+  public var owners: [String: String] = [:]
+
+  /// The names of the imported structs.
+  public var structNames: Set<String> { Set(types.map({ $0.name })) }
+
+  public init() {}
+
+  /// Records that the given module defines a function, checking that no other imported module
+  /// defines a function with the same name.
+  ///
+  /// The check applies to inlinable functions and functions declared by their signature alike, so
+  /// that whether two modules may define the same name does not depend on the size of their bodies.
+  mutating func declare(function name: String, module: String) throws {
+    if let owner = owners[name] {
+      throw ModuleError.duplicateFunction(name: name, modules: (owner, module))
+    }
+    owners[name] = module
+  }
+
+  /// Adds the imported declarations to the given program.
+  ///
+  /// Inlinable functions are bound around the program's entry, so that their bodies are emitted
+  /// in the program's LLVM module.
+  ///
+  /// - Returns: `false` if one of the functions defined by the program has the same name as an
+  ///   imported function, in which case the diagnostic is reported to `diagConsumer`.
+  public func add(to program: inout Program, diagConsumer: DiagnosticConsumer) -> Bool {
+    // Check that the program's functions don't shadow the imported ones.
+    var expr = program.entry
+    while let binding = expr as? FuncBindingExpr {
+      if let owner = owners[binding.name] {
+        diagConsumer.consume(
+          Diagnostic(
+            range: binding.range.lowerBound ..< binding.literal.range.lowerBound,
+            message: "duplicate function declaration '\(binding.name)', "
+              + "already declared by module '\(owner)'"))
+        return false
+      }
+      expr = binding.body
+    }
+
+    program.types = types + program.types
+    program.funcs = funcs + program.funcs
+    for var binding in inlinableFuncs.reversed() {
+      binding.body = program.entry
+      program.entry = binding
+    }
+    return true
+  }
+
+}
+
+/// An error that occurred while loading a module.
+public enum ModuleError: Error, CustomStringConvertible {
+
+  /// The module could not be found in the search paths.
+  case notFound(name: String)
+
+  /// The module imports itself, directly or transitively.
+  case cyclicImport(name: String)
+
+  /// The module failed to compile.
+  case invalidModule(name: String)
+
+  /// The interface of the module could not be read.
+  case invalidInterface(name: String)
+
+  /// Two imported modules define a function with the same name.
+  case duplicateFunction(name: String, modules: (String, String))
+
+  public var description: String {
+    switch self {
+    case .notFound(let name):
+      return "no such module '\(name)'"
+    case .cyclicImport(let name):
+      return "module '\(name)' imports itself"
+    case .invalidModule(let name):
+      return "failed to compile module '\(name)'"
+    case .invalidInterface(let name):
+      return "invalid interface for module '\(name)'"
+    case .duplicateFunction(let name, let modules):
+      return "function '\(name)' is defined by both modules '\(modules.0)' and '\(modules.1)'"
+    }
+  }
+
+}
+
+/// An object that locates the modules imported by a program, recompiles those that are out of
+/// date, and loads their interfaces.
+///
+/// A module is compiled into an object file and an interface, next to its source. It is out of
+/// date if its source or the options of the compiler changed since then, or if the fingerprint of
+/// one of its dependencies did. Modules without source are loaded from their interface as is.
+public struct ModuleLoader {
+
+  /// The directories in which modules are searched, in order.
+  public let searchPaths: [URL]
+
+  /// The configuration of the code generator.
+  public let options: CompilerOptions
+
+  /// The machine target for which modules are compiled.
+  public let target: TargetMachine
+
+  /// The interfaces of the modules loaded so far, indexed by name.
+  public private(set) var interfaces: [String: ModuleInterface] = [:]
+
+  /// The names of the modules compiled by this loader, in the order in which they were compiled.
+  public private(set) var compiledModules: [String] = []
+
+  /// The declarations parsed from the interfaces loaded so far, indexed by module name.
+  private var parsedDeclarations: [String: Program] = [:]
+
+  /// The names of the modules being loaded, used to detect cyclic imports.
+  private var pending: Set<String> = []
+
+  /// A file manager.
+  private let manager = FileManager.default
+
+  public init(searchPaths: [URL], options: CompilerOptions, target: TargetMachine) {
+    self.searchPaths = searchPaths
+    self.options = options
+    self.target = target
+  }
+
+  /// Loads the given modules and the modules they import, and returns their declarations.
+  public mutating func load(imports names: [String]) throws -> ImportedDeclarations {
+    // Sort the modules so that each of them follows its dependencies.
+    var order: [String] = []
+    var visited: Set<String> = []
+    for name in names {
+      try collect(name, into: &order, visited: &visited)
+    }
+
+    var result = ImportedDeclarations()
+    for name in order {
+      let interface = interfaces[name]!
+      var decls = try declarations(of: interface, knownStructs: result.structNames)
+
+      result.types.append(contentsOf: decls.types)
+      for decl in decls.funcs {
+        try result.declare(function: decl.name, module: name)
+        result.funcs.append(decl)
+      }
+      while let binding = decls.entry as? FuncBindingExpr {
+        try result.declare(function: binding.name, module: name)
+        result.inlinableFuncs.append(binding)
+        decls.entry = binding.body
+      }
+
+      for (function, summary) in interface.summaries {
+        result.summaries["\(name).\(function)"] = summary
+      }
+      result.fingerprints[name] = interface.fingerprint
+    }
+
+    return result
+  }
+
+  /// Loads the given module and appends it to `order` after its dependencies.
+  private mutating func collect(
+    _ name: String, into order: inout [String], visited: inout Set<String>
+  ) throws {
+    guard !visited.contains(name) else { return }
+    visited.insert(name)
+
+    let interface = try load(name)
+    for dependency in interface.imports {
+      try collect(dependency, into: &order, visited: &visited)
+    }
+    order.append(name)
+  }
+
+  /// Returns the interface of the given module, recompiling the module first if it is out of date.
+  public mutating func load(_ name: String) throws -> ModuleInterface {
+    if let interface = interfaces[name] {
+      return interface
+    }
+
+    guard !pending.contains(name) else { throw ModuleError.cyclicImport(name: name) }
+    pending.insert(name)
+    defer { pending.remove(name) }
+
+    // Locate the module.
+    guard let directory = searchPaths.first(where: { (path) -> Bool in
+      manager.fileExists(atPath: path.appendingPathComponent(name + ".mvs").path) ||
+      manager.fileExists(atPath: path.appendingPathComponent(name + ".mvsi").path)
+    }) else { throw ModuleError.notFound(name: name) }
+
+    let sourceURL = directory.appendingPathComponent(name + ".mvs")
+    let interfaceURL = directory.appendingPathComponent(name + ".mvsi")
+    let objectURL = directory.appendingPathComponent(name + ".o")
+
+    var interface = (try? Data(contentsOf: interfaceURL)).flatMap({ data in
+      try? JSONDecoder().decode(ModuleInterface.self, from: data)
+    })
+
+    // Recompile the module if it is out of date.
+    if let source = try? String(contentsOf: sourceURL) {
+      let sourceHash = stableHash(source + String(describing: options))
+      var isUpToDate = false
+      if let i = interface,
+         i.sourceHash == sourceHash,
+         manager.fileExists(atPath: objectURL.path)
+      {
+        isUpToDate = try dependenciesAreUpToDate(i)
+      }
+
+      if !isUpToDate {
+        let newInterface = try compile(
+          module: name, source: source, sourceHash: sourceHash, object: objectURL)
+
+        let encoder = JSONEncoder()
+        encoder.outputFormatting = [.prettyPrinted, .sortedKeys]
+        try encoder.encode(newInterface).write(to: interfaceURL)
+        interface = newInterface
+        compiledModules.append(name)
+      }
+    }
+
+    guard let result = interface else { throw ModuleError.invalidInterface(name: name) }
+    interfaces[name] = result
+    return result
+  }
+
+  /// Returns whether the dependencies of a module have the same fingerprint as when it was
+  /// compiled, recompiling them if necessary.
+  private mutating func dependenciesAreUpToDate(_ interface: ModuleInterface) throws -> Bool {
+    for (name, fingerprint) in interface.dependencies {
+      if try load(name).fingerprint != fingerprint {
+        return false
+      }
+    }
+    return true
+  }
+
+  /// Compiles a module into an object file, and returns its interface.
+  private mutating func compile(
+    module name: String,
+    source: String,
+    sourceHash: String,
+    object: URL
+  ) throws -> ModuleInterface {
+    let console = Console(source: source)
+    var parser = MVSParser()
+
+    // Load the modules imported by this module.
+    let imports = parser.parseImports(source: source, diagConsumer: console).map({ $0.name })
+    let imported = try load(imports: imports)
+
+    // Parse the module.
+    guard var library = parser.parse(
+      module: source, knownStructs: imported.structNames, diagConsumer: console)
+    else { throw ModuleError.invalidModule(name: name) }
+
+    if let decl = library.funcs.first {
+      console.consume(
+        Diagnostic(range: decl.range, message: "missing body of function '\(decl.name)'"))
+      throw ModuleError.invalidModule(name: name)
+    }
+
+    // Export the functions defined by the module, under a symbol prefixed by its name.
+    var exported: [FuncBindingExpr] = []
+    library.entry = export(library.entry, module: name, into: &exported)
+    let types = library.types
+
+    // Type check the module in the context of its imports.
+    guard imported.add(to: &library, diagConsumer: console) else {
+      throw ModuleError.invalidModule(name: name)
+    }
+    var checker = TypeChecker(diagConsumer: console)
+    guard checker.visit(&library) else { throw ModuleError.invalidModule(name: name) }
+
+    // Emit the module's object file.
+    var emitter = try Emitter(
+      target              : target,
+      mode                : options.mode,
+      maxStackArraySize   : options.maxStackArraySize,
+      specializationBudget: options.specializationBudget)
+    emitter.importedSummaries = imported.summaries
+    let module = try emitter.emit(module: &library, name: name)
+    try target.emitToFile(module: module, type: .object, path: object.path)
+
+    // Describe the module's interface. Structs and inlinable functions are copied from the source,
+    // other functions are declared by their signature.
+    var declarations = ""
+    for decl in types {
+      declarations += "\(source[decl.range]) in\n"
+    }
+
+    var summaries: [String: FunctionSummary] = [:]
+    for binding in exported {
+      let summary = emitter.exportedSummaries[binding.symbol!]!
+      let literal = binding.literal
+      if summary.instructionCount <= options.inlineThreshold {
+        declarations += "fun \(binding.name)\(source[literal.range]) in\n"
+      } else {
+        let signature = literal.range.lowerBound ..< literal.output.range.upperBound
+        declarations += "fun \(binding.name)\(source[signature]) in\n"
+      }
+      summaries[binding.name] = summary
+    }
+
+    let encoder = JSONEncoder()
+    encoder.outputFormatting = [.sortedKeys]
+    let encodedSummaries = try encoder.encode(summaries)
+
+    return ModuleInterface(
+      name: name,
+      sourceHash: sourceHash,
+      imports: imports,
+      dependencies: imported.fingerprints,
+      declarations: declarations,
+      summaries: summaries,
+      fingerprint: stableHash(declarations + String(decoding: encodedSummaries, as: UTF8.self)))
+  }
+
+  /// Sets the symbol of each function in the given chain of function bindings, and appends them
+  /// to `exported`.
+  private func export(
+    _ expr: Expr, module: String, into exported: inout [FuncBindingExpr]
+  ) -> Expr {
+    guard var binding = expr as? FuncBindingExpr else { return expr }
+    binding.symbol = "\(module).\(binding.name)"
+    exported.append(binding)
+    binding.body = export(binding.body, module: module, into: &exported)
+    return binding
+  }
+
+  /// Returns the declarations of a module, parsed from its interface.
+  ///
+  /// Functions declared by their signature are bound to the symbols that the module exports.
+  private mutating func declarations(
+    of interface: ModuleInterface, knownStructs: Set<String>
+  ) throws -> Program {
+    if let decls = parsedDeclarations[interface.name] {
+      return decls
+    }
+
+    var parser = MVSParser()
+    guard var decls = parser.parse(
+      module: interface.declarations,
+      knownStructs: knownStructs,
+      diagConsumer: Console(source: interface.declarations))
+    else { throw ModuleError.invalidInterface(name: interface.name) }
+
+    for i in 0 ..< decls.funcs.count {
+      decls.funcs[i].symbol = "\(interface.name).\(decls.funcs[i].name)"
+    }
+
+    parsedDeclarations[interface.name] = decls
+    return decls
+  }
+
+}
+
+/// Returns a hash of the given string that does not depend on the process computing it.
+func stableHash(_ string: String) -> String {
+  // FNV-1a, 64 bits.
+  var hash: UInt64 = 0xcbf29ce484222325
+  for byte in string.utf8 {
+    hash = (hash ^ UInt64(byte)) &* 0x100000001b3
+  }
+  return String(hash, radix: 16)
+}
@@ -44,6 +44,7 @@ struct Lexer: IteratorProtocol {
       case "as"     : token.kind = .as
       case "if"     : token.kind = .if
       case "in"     : token.kind = .in
+      case "import" : token.kind = .import
       case "let"    : token.kind = .let
       case "var"    : token.kind = .var
       case "fun"    : token.kind = .fun
@@ -62,6 +63,12 @@ struct Lexer: IteratorProtocol {
       return token
     }
 
+    // Scan for string literals.
+    if head == "\"" {
+      scanStringLiteral(&token)
+      return token
+    }
+
     // Scan for operators and punctuation.
     switch head {
     case ",": token.kind = .comma
@@ -79,6 +86,9 @@ struct Lexer: IteratorProtocol {
     case "+": token.kind = .add
     case "*": token.kind = .mul
     case "/": token.kind = .div
+    case "|": token.kind = .pipe
+    case "^": token.kind = .caret
+    case "~": token.kind = .tilde
 
     case "-":
       if source.suffix(from: index).starts(with: "->") {
@@ -114,6 +124,9 @@ struct Lexer: IteratorProtocol {
       if source.suffix(from: index).starts(with: "<=") {
         token.kind = .le
         index = source.index(after: index)
+      } else if source.suffix(from: index).starts(with: "<<") {
+        token.kind = .shl
+        index = source.index(after: index)
       } else {
         token.kind = .lt
       }
@@ -122,6 +135,9 @@ struct Lexer: IteratorProtocol {
       if source.suffix(from: index).starts(with: ">=") {
         token.kind = .ge
         index = source.index(after: index)
+      } else if source.suffix(from: index).starts(with: ">>") {
+        token.kind = .shr
+        index = source.index(after: index)
       } else {
         token.kind = .gt
       }
@@ -168,6 +184,28 @@ struct Lexer: IteratorProtocol {
     token.range = token.range.lowerBound ..< index
   }
 
+  private mutating func scanStringLiteral(_ token: inout Token) {
+    // Consume the opening quote.
+    index = source.index(after: index)
+
+    // Consume characters up to the closing quote, skipping over escape sequences. Escapes are
+    // decoded by the parser.
+    while let ch = peek(), ch != "\"", !ch.isNewline {
+      index = source.index(after: index)
+      if (ch == "\\") && (index < source.endIndex) {
+        index = source.index(after: index)
+      }
+    }
+
+    // Consume the closing quote, or leave the literal unterminated.
+    if peek() == "\"" {
+      index = source.index(after: index)
+      token.kind = .string
+    }
+
+    token.range = token.range.lowerBound ..< index
+  }
+
   /// Returns the next character in the stream, without consuming it.
   private func peek() -> Character? {
     guard index < source.endIndex else { return nil }
@@ -16,14 +16,74 @@ public struct MVSParser {
         .or((take(.lParen) << sign) >> take(.rParen)))
   }
 
-  public mutating func parse(source: String, diagConsumer: DiagnosticConsumer) -> Program? {
+  /// Parses a program.
+  ///
+  /// - Parameters:
+  ///   - source: The source of the program.
+  ///   - knownStructs: The names of the structs declared by the modules that the program imports,
+  ///     so that their constructors are recognized as such.
+  ///   - diagConsumer: A diagnostic consumer.
+  public mutating func parse(
+    source: String,
+    knownStructs: Set<String> = [],
+    diagConsumer: DiagnosticConsumer
+  ) -> Program? {
+    return parse(
+      source: source, with: program, knownStructs: knownStructs, diagConsumer: diagConsumer)
+  }
+
+  /// Parses a module, or the declarations of a module interface.
+  ///
+  /// The functions of the module are returned as a chain of function bindings in the program's
+  /// entry, ending with a placeholder. Functions that are declared without a body are returned in
+  /// the program's `funcs`.
+  ///
+  /// - Parameters:
+  ///   - module: The source of the module.
+  ///   - knownStructs: The names of the structs declared by the modules that the module imports.
+  ///   - diagConsumer: A diagnostic consumer.
+  public mutating func parse(
+    module source: String,
+    knownStructs: Set<String> = [],
+    diagConsumer: DiagnosticConsumer
+  ) -> Program? {
+    return parse(
+      source: source, with: module, knownStructs: knownStructs, diagConsumer: diagConsumer)
+  }
+
+  /// Parses the import declarations at the beginning of a program or module, ignoring the rest of
+  /// the source.
+  public mutating func parseImports(
+    source: String,
+    diagConsumer: DiagnosticConsumer
+  ) -> [ImportDecl] {
+    let tokens = Array(AnySequence({ Lexer(source: source) }))
+    let state = ParserState(
+      source: source,
+      tokens: tokens[0...],
+      diagConsumer: diagConsumer)
+
+    if case .success(let imports, _) = self.imports.parse(state) {
+      return imports
+    } else {
+      return []
+    }
+  }
+
+  private func parse<P>(
+    source: String,
+    with parser: P,
+    knownStructs: Set<String>,
+    diagConsumer: DiagnosticConsumer
+  ) -> Program? where P: Parser, P.Element == Program, P.Stream == ParserState {
     let tokens = Array(AnySequence({ Lexer(source: source) }))
     let state = ParserState(
       source: source,
       tokens: tokens[0...],
+      knownStructs: knownStructs,
       diagConsumer: diagConsumer)
 
-    switch program.parse(state) {
+    switch parser.parse(state) {
     case .success(let program, let remainder):
       if let next = remainder.tokens.first {
         let diag = Diagnostic(
@@ -44,10 +104,53 @@ public struct MVSParser {
   // MARK: Declarations
   // ----------------------------------------------------------------------------------------------
 
-  /// `( structDecl 'in' )* expr`
-  lazy var program = (structDecl >> take(.in)).many
+  /// `imports ( structDecl 'in' )* expr`
+  lazy var program = imports
+    .then((structDecl >> take(.in)).many)
     .then(expr)
-    .map(Program.init)
+    .map({ tree -> Program in
+      let ((imports, types), entry) = tree
+      return Program(imports: imports, types: types, entry: entry)
+    })
+
+  /// `imports ( structDecl 'in' )* ( moduleFuncDecl 'in' )*`
+  lazy var module = imports
+    .then((structDecl >> take(.in)).many)
+    .then((moduleFuncDecl >> take(.in)).many)
+    .assemble({ (state, tree) -> Program in
+      let ((imports, types), members) = tree
+
+      // Chain the definitions of the functions, so that each of them is in the scope of the
+      // functions that follow it.
+      var entry: Expr = IntExpr(value: 0, range: state.source.endIndex ..< state.source.endIndex)
+      var funcs: [FuncDecl] = []
+      for (decl, literal) in members.reversed() {
+        if let literal = literal {
+          entry = FuncBindingExpr(
+            name: decl.name,
+            literal: literal,
+            body: entry,
+            range: decl.range ..< entry.range)
+        } else {
+          funcs.insert(decl, at: 0)
+        }
+      }
+
+      return Program(imports: imports, types: types, funcs: funcs, entry: entry)
+    })
+
+  /// `( importDecl 'in' )*`
+  lazy var imports = (importDecl >> take(.in)).many
+
+  /// `'import' name`
+  lazy var importDecl = take(.import)
+    .then(take(.name))
+    .assemble({ (state, tree) -> ImportDecl in
+      let (head, name) = tree
+      return ImportDecl(
+        name: String(name.value(in: state.source)),
+        range: head.range ..< name.range)
+    })
 
   /// `structDeclHead structDeclBody`
   lazy var structDecl = (structDeclHead ++ structDeclBody)
@@ -108,6 +211,30 @@ public struct MVSParser {
   lazy var funcDecl = declHead(introducer: .fun)
     .then(funcExpr)
 
+  /// `'fun' name '(' paramDeclList? ')' '->' sign ( '{' expr '}' )?`
+  lazy var moduleFuncDecl = declHead(introducer: .fun)
+    .then(take(.lParen))
+    .then(paramDeclList.optional)
+    .then((take(.rParen) << take(.arrow)) << sign)
+    .then(((take(.lBrace) << expr).then(take(.rBrace))).optional)
+    .map({ tree -> (decl: FuncDecl, literal: FuncExpr?) in
+      let (((((head, name), lParen), params), output), body) = tree
+      let decl = FuncDecl(
+        name: name,
+        params: params ?? [],
+        output: output,
+        range: head.range ..< output.range)
+
+      // The function is only declared if it has no body.
+      guard let body = body else { return (decl, nil) }
+      let literal = FuncExpr(
+        params: decl.params,
+        output: output,
+        body: body.0,
+        range: lParen.range ..< body.1.range)
+      return (decl, literal)
+    })
+
   /// `paramDecl ( ',' paramDecl )*`
   lazy var paramDeclList = paramDecl
     .then((take(.comma) << paramDecl).many >> take(.comma).optional)
@@ -178,8 +305,8 @@ public struct MVSParser {
       })
     })
 
-  lazy var mulExpr = preExpr
-    .then(mulOperExpr.then(preExpr).many)
+  lazy var mulExpr = shiftExpr
+    .then(mulOperExpr.then(shiftExpr).many)
     .map({ (head, tail) -> Expr in
       tail.reduce(into: head, { (lhs, pair) in
         let (oper, rhs) = pair
@@ -187,7 +314,31 @@ public struct MVSParser {
       })
     })
 
-  lazy var preExpr = take(.amp).optional
+  lazy var shiftExpr = preExpr
+    .then(shiftOperExpr.then(preExpr).many)
+    .map({ (head, tail) -> Expr in
+      tail.reduce(into: head, { (lhs, pair) in
+        let (oper, rhs) = pair
+        lhs = InfixExpr(lhs: lhs, rhs: rhs, oper: oper, range: lhs.range ..< rhs.range)
+      })
+    })
+
+  /// `'~'* inoutExpr`
+  ///
+  /// The bitwise complement `~x` is parsed as `x ^ -1`.
+  lazy var preExpr = take(.tilde).many
+    .then(inoutExpr)
+    .map({ (heads, expr) -> Expr in
+      heads.reversed().reduce(expr, { (operand, head) in
+        InfixExpr(
+          lhs: operand,
+          rhs: IntExpr(value: -1, range: head.range),
+          oper: OperExpr(kind: .xor, range: head.range),
+          range: head.range ..< operand.range)
+      })
+    })
+
+  lazy var inoutExpr = take(.amp).optional
     .then(postExpr)
     .map({ (amp, expr) throws -> Expr in
       guard let head = amp else { return expr }
@@ -272,6 +423,7 @@ public struct MVSParser {
   lazy var primaryExpr = namePath
     .or(intExpr)
     .or(floatExpr)
+    .or(stringExpr)
     .or(arrayExpr)
     .or(bindingExpr)
     .or(funcBindingExpr)
@@ -310,6 +462,34 @@ public struct MVSParser {
       return FloatExpr(value: value, range: literal.range)
     })
 
+  let stringExpr = take(.string)
+    .assemble({ (state, literal) throws -> Expr in
+      let string = literal.value(in: state.source)
+
+      // Decode escape sequences, dropping the surrounding quotes.
+      var value = ""
+      var chars = string.dropFirst().dropLast().makeIterator()
+      while let ch = chars.next() {
+        guard ch == "\\" else {
+          value.append(ch)
+          continue
+        }
+
+        switch chars.next() {
+        case "\"": value.append("\"")
+        case "\\": value.append("\\")
+        case "n" : value.append("\n")
+        case "t" : value.append("\t")
+        case "0" : value.append("\0")
+        default:
+          throw ParseError(
+            diagnostic: Diagnostic.invalidLiteral(value: string, range: literal.range))
+        }
+      }
+
+      return StringExpr(value: value, range: literal.range)
+    })
+
   lazy var arrayExpr = take(.lBracket)
     .then(exprList.optional)
     .then(take(.rBracket))
@@ -387,14 +567,16 @@ public struct MVSParser {
         range: head.range ..< tail.range)
     })
 
-  lazy var operExpr = cmpOperExpr.or(addOperExpr).or(mulOperExpr)
+  lazy var operExpr = cmpOperExpr.or(addOperExpr).or(mulOperExpr).or(shiftOperExpr)
     .map({ $0 as Expr })
 
   let cmpOperExpr = oper(kinds: [.eq, .ne, .lt, .le, .gt, .ge])
 
-  let addOperExpr = oper(kinds: [.add, .sub])
+  let addOperExpr = oper(kinds: [.add, .sub, .pipe, .caret])
+
+  let mulOperExpr = oper(kinds: [.mul, .div, .amp])
 
-  let mulOperExpr = oper(kinds: [.mul, .div])
+  let shiftOperExpr = oper(kinds: [.shl, .shr])
 
   // ----------------------------------------------------------------------------------------------
   // MARK: Signatures
@@ -520,6 +702,11 @@ extension OperExpr {
     case .sub: self = OperExpr(kind: .sub, range: token.range)
     case .mul: self = OperExpr(kind: .mul, range: token.range)
     case .div: self = OperExpr(kind: .div, range: token.range)
+    case .amp  : self = OperExpr(kind: .and, range: token.range)
+    case .pipe : self = OperExpr(kind: .or , range: token.range)
+    case .caret: self = OperExpr(kind: .xor, range: token.range)
+    case .shl  : self = OperExpr(kind: .shl, range: token.range)
+    case .shr  : self = OperExpr(kind: .shr, range: token.range)
     default: return nil
     }
   }
@@ -33,11 +33,13 @@ public struct Token {
     case fun
     case `if`
     case `in`
+    case `import`
     case `while`
     case `inout`
     case `as`
     case int
     case float
+    case string
     case comma
     case dot
     case colon
@@ -58,6 +60,11 @@ public struct Token {
     case sub
     case mul
     case div
+    case pipe
+    case caret
+    case tilde
+    case shl
+    case shr
     case lParen
     case rParen
     case lBrace
@@ -15,6 +15,12 @@ extension Diagnostic {
       message: "call to non-function type '\(type)'")
   }
 
+  static func duplicateFuncDecl(decl: FuncDecl) -> Diagnostic {
+    return Diagnostic(
+      range: decl.range,
+      message: "duplicate function declaration '\(decl.name)'")
+  }
+
   static func duplicateParamDecl(decl: ParamDecl) -> Diagnostic {
     return Diagnostic(
       range: decl.range,
@@ -45,6 +51,18 @@ extension Diagnostic {
       message: "possible violation of exclusive access")
   }
 
+  static func genericBuiltinReference(name: String, range: SourceRange) -> Diagnostic {
+    return Diagnostic(
+      range: range,
+      message: "built-in function '\(name)' must be called directly")
+  }
+
+  static func invalidGenericBuiltinArg(name: String, type: Type, range: SourceRange) -> Diagnostic {
+    return Diagnostic(
+      range: range,
+      message: "built-in function '\(name)' cannot be applied to an argument of type '\(type)'")
+  }
+
   static func immutableInout(type: Type, range: SourceRange) -> Diagnostic {
     return Diagnostic(
       range: range,
@@ -1,5 +1,140 @@
 import AST
 
+/// An integer expression of the form `symbol + offset`, where `symbol` is the name of a binding.
+///
+/// Constant expressions have no symbol. Offsets wrap around on overflow, like the integer
+/// arithmetic of the emitted code, so that equal offsets denote equal indices.
+struct AffineIndex: Hashable {
+
+  /// The name of the binding whose value is offset, if any.
+  let symbol: String?
+
+  /// The constant offset.
+  let offset: Int
+
+  /// Creates the affine form of the given index expression, or returns `nil` if the expression is
+  /// not of the form `n`, `x`, `x + n`, `n + x` or `x - n`.
+  init?(_ expr: Expr) {
+    switch expr {
+    case let e as IntExpr:
+      symbol = nil
+      offset = e.value
+
+    case let e as NamePath:
+      symbol = e.name
+      offset = 0
+
+    case let e as InfixExpr:
+      guard let lhs = AffineIndex(e.lhs), let rhs = AffineIndex(e.rhs) else { return nil }
+      switch e.oper.kind {
+      case .add where rhs.symbol == nil:
+        symbol = lhs.symbol
+        offset = lhs.offset &+ rhs.offset
+      case .add where lhs.symbol == nil:
+        symbol = rhs.symbol
+        offset = lhs.offset &+ rhs.offset
+      case .sub where rhs.symbol == nil:
+        symbol = lhs.symbol
+        offset = lhs.offset &- rhs.offset
+      default:
+        return nil
+      }
+
+    default:
+      return nil
+    }
+  }
+
+}
+
+/// A set of facts about integer bindings, used to prove that element paths are disjoint.
+struct IndexFacts {
+
+  /// Pairs of indices that are known to have different values, as established by guards.
+  private(set) var disequalities: [(AffineIndex, AffineIndex)] = []
+
+  /// The names of the bindings whose value may change while the paths are evaluated, and about
+  /// which nothing can be assumed.
+  var unstable: Set<String> = []
+
+  init() {}
+
+  /// Returns these facts, extended with what the given condition implies when it evaluates to
+  /// `holds`.
+  ///
+  /// Only facts about constant bindings are recorded, as the value of mutable bindings may change
+  /// after the condition has been evaluated.
+  ///
+  /// - Parameters:
+  ///   - cond: A condition.
+  ///   - holds: The value of the condition.
+  ///   - isConstant: A function that returns whether a binding is immutable.
+  func assuming(
+    _ cond: Expr, holds: Bool, isConstant: (String) -> Bool
+  ) -> IndexFacts {
+    guard let infix = cond as? InfixExpr,
+          let lhs = AffineIndex(infix.lhs),
+          let rhs = AffineIndex(infix.rhs),
+          [lhs.symbol, rhs.symbol].allSatisfy({ s in s.map(isConstant) ?? true })
+    else { return self }
+
+    let implies: Bool
+    switch infix.oper.kind {
+    case .ne, .lt, .gt: implies = holds
+    case .eq, .le, .ge: implies = !holds
+    default           : implies = false
+    }
+
+    var result = self
+    if implies {
+      result.disequalities.append((lhs, rhs))
+    }
+    return result
+  }
+
+  /// Returns these facts without the ones mentioning the binding with the given name.
+  ///
+  /// This method should be called when `name` is shadowed by a new declaration.
+  func forgetting(_ name: String) -> IndexFacts {
+    var result = self
+    result.disequalities.removeAll(where: { (a, b) in a.symbol == name || b.symbol == name })
+    return result
+  }
+
+  /// Returns whether the given index expressions are known to have the same value.
+  func provesEqual(_ lhs: Expr, _ rhs: Expr) -> Bool {
+    guard let a = AffineIndex(lhs), let b = AffineIndex(rhs), isStable(a), isStable(b) else {
+      return false
+    }
+    return a == b
+  }
+
+  /// Returns whether the given index expressions are known to have different values.
+  func provesDistinct(_ lhs: Expr, _ rhs: Expr) -> Bool {
+    guard let a = AffineIndex(lhs), let b = AffineIndex(rhs), isStable(a), isStable(b) else {
+      return false
+    }
+
+    // `x + m` and `x + n` are distinct if `m != n`.
+    if a.symbol == b.symbol {
+      return a.offset != b.offset
+    }
+
+    // `x + m` and `y + n` are distinct if `x + p != y + q` is known and `m - n == p - q`, which
+    // also holds modulo the width of the integers.
+    return disequalities.contains(where: { (p, q) in
+      (p.symbol == a.symbol && q.symbol == b.symbol && a.offset &- b.offset == p.offset &- q.offset)
+      ||
+      (p.symbol == b.symbol && q.symbol == a.symbol && b.offset &- a.offset == p.offset &- q.offset)
+    })
+  }
+
+  private func isStable(_ index: AffineIndex) -> Bool {
+    return index.symbol.map({ !unstable.contains($0) }) ?? true
+  }
+
+}
+
 /// Returns a Boolean value indicating whether the two given expressions may represent overlapping
 /// memory locations.
 ///
@@ -8,37 +143,116 @@ import AST
 /// - Parameters:
 ///   - lhs: An expression.
 ///   - rhs: Another expression.
+///   - facts: Facts about the integer bindings in scope.
 ///
 /// - Returns: `true` if both `lhs` and `rhs` denote memory locations that may overlap.
-func mayOverlap(_ lhs: Expr, _ rhs: Expr) -> Bool {
-  // guard let a = lhs as? Path, let b = rhs as? Path else { return false }
-
+func mayOverlap(_ lhs: Expr, _ rhs: Expr, facts: IndexFacts = IndexFacts()) -> Bool {
   switch (lhs, rhs) {
   case (let a as NamePath, let b as NamePath):
     return a.name == b.name
 
   case (let a as NamePath, let b as ElemPath):
-    return mayOverlap(a, b.base)
+    return mayOverlap(a, b.base, facts: facts)
 
   case (let a as NamePath, let b as PropPath):
-    return mayOverlap(a, b.base)
+    return mayOverlap(a, b.base, facts: facts)
 
   case (let a as ElemPath, let b as ElemPath):
-    guard let leftIndex = a.index as? IntExpr, let rightIndex = b.index as? IntExpr else {
-      return true
+    // Elements of the same array overlap only if their indices may be equal.
+    if mustAlias(a.base, b.base, facts: facts) {
+      return !facts.provesDistinct(a.index, b.index)
     }
-    return leftIndex.value != rightIndex.value
+
+    // Each path denotes a location contained in that of its base.
+    return mayOverlap(a, b.base, facts: facts) && mayOverlap(a.base, b, facts: facts)
 
   case (let a as ElemPath, let b as PropPath):
-    return mayOverlap(a.base, b) || mayOverlap(a, b.base)
+    return mayOverlap(a.base, b, facts: facts) || mayOverlap(a, b.base, facts: facts)
 
   case (let a as PropPath, let b as PropPath):
-    return (a.name == b.name) && mayOverlap(a.base, b.base)
+    if mustAlias(a.base, b.base, facts: facts) {
+      return a.name == b.name
+    }
+    return mayOverlap(a, b.base, facts: facts) && mayOverlap(a.base, b, facts: facts)
 
   case (is Path, is Path):
-    return mayOverlap(rhs, lhs)
+    return mayOverlap(rhs, lhs, facts: facts)
 
   default:
     return false
   }
 }
+
+/// Returns a Boolean value indicating whether the two given expressions are known to denote the
+/// same memory location.
+///
+/// - Parameters:
+///   - lhs: An expression.
+///   - rhs: Another expression.
+///   - facts: Facts about the integer bindings in scope.
+private func mustAlias(_ lhs: Expr, _ rhs: Expr, facts: IndexFacts) -> Bool {
+  switch (lhs, rhs) {
+  case (let a as NamePath, let b as NamePath):
+    return a.name == b.name
+
+  case (let a as PropPath, let b as PropPath):
+    return (a.name == b.name) && mustAlias(a.base, b.base, facts: facts)
+
+  case (let a as ElemPath, let b as ElemPath):
+    return facts.provesEqual(a.index, b.index) && mustAlias(a.base, b.base, facts: facts)
+
+  default:
+    return false
+  }
+}
+
+/// Returns the names of the bindings that may be mutated by evaluating the given expression, or
+/// `nil` if they cannot be determined.
+func mutatedNames(in expr: Expr) -> Set<String>? {
+  switch expr {
+  case is IntExpr, is FloatExpr, is StringExpr, is OperExpr, is NamePath, is FuncExpr:
+    return []
+
+  case let e as InoutExpr:
+    var result = mutatedNames(in: e.path)
+    if let root = e.path.root as? NamePath {
+      result?.insert(root.name)
+    }
+    return result
+
+  case let e as PropPath:
+    return mutatedNames(in: e.base)
+
+  case let e as ElemPath:
+    return union(of: [e.base, e.index])
+
+  case let e as CallExpr:
+    return union(of: [e.callee] + e.args)
+
+  case let e as InfixExpr:
+    return union(of: [e.lhs, e.rhs])
+
+  case let e as ArrayExpr:
+    return union(of: e.elems)
+
+  case let e as StructExpr:
+    return union(of: e.args)
+
+  case let e as CastExpr:
+    return mutatedNames(in: e.value)
+
+  default:
+    return nil
+  }
+}
+
+/// Returns the names of the bindings that may be mutated by evaluating the given expressions, or
+/// `nil` if they cannot be determined.
+private func union(of exprs: [Expr]) -> Set<String>? {
+  var result: Set<String> = []
+  for expr in exprs {
+    guard let names = mutatedNames(in: expr) else { return nil }
+    result.formUnion(names)
+  }
+  return result
+}
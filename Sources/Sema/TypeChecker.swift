@@ -14,6 +14,9 @@ public struct TypeChecker: DeclVisitor, ExprVisitor, PathVisitor, SignVisitor {
   /// The typing context Γ.
   private var gamma: [String: PathResult] = [:]
 
+  /// The facts about integer bindings that hold in the current context, established by guards.
+  private var indexFacts = IndexFacts()
+
   /// The expected type of the next expression to visit.
   ///
   /// This property must be reset (i.e., set to `nil`) after each visitor.
@@ -46,6 +49,19 @@ public struct TypeChecker: DeclVisitor, ExprVisitor, PathVisitor, SignVisitor {
       delta[program.types[i].name] = program.types[i].type!
     }
 
+    // Type check the declarations of the functions defined in other modules, which are visible
+    // from the entry point.
+    for i in 0 ..< program.funcs.count {
+      // Check for duplicate declarations.
+      guard gamma[program.funcs[i].name] == nil else {
+        diagConsumer.consume(.duplicateFuncDecl(decl: program.funcs[i]))
+        return false
+      }
+
+      guard visit(&program.funcs[i]) else { return false }
+      gamma[program.funcs[i].name] = (.let, program.funcs[i].type!)
+    }
+
     // Type check the entry point of the program.
     guard program.entry.accept(&self) else { return false }
     return true
@@ -100,6 +116,20 @@ public struct TypeChecker: DeclVisitor, ExprVisitor, PathVisitor, SignVisitor {
     return !type.hasError
   }
 
+  public mutating func visit(_ decl: inout FuncDecl) -> Bool {
+    // Realize the type of the signature.
+    let type = visit(params: &decl.params, output: &decl.output)
+    decl.type = type
+
+    // Bail out if the signature has an error.
+    return !type.hasError
+  }
+
+  public mutating func visit(_ decl: inout ImportDecl) -> Bool {
+    // Imported declarations are added to the program before it is type checked.
+    return true
+  }
+
   /// T-ConstLit.
   public mutating func visit(_ expr: inout IntExpr) -> Bool {
     defer { expectedType = nil }
@@ -124,6 +154,18 @@ public struct TypeChecker: DeclVisitor, ExprVisitor, PathVisitor, SignVisitor {
     }
   }
 
+  /// T-ConstLit.
+  public mutating func visit(_ expr: inout StringExpr) -> Bool {
+    defer { expectedType = nil }
+
+    if let expected = expectedType, expected != .string {
+      diagConsumer.consume(.typeError(expected: expected, actual: .string, range: expr.range))
+      return false
+    } else {
+      return true
+    }
+  }
+
   /// T-ArrayLit.
   public mutating func visit(_ expr: inout ArrayExpr) -> Bool {
     defer { expectedType = nil }
@@ -221,9 +263,23 @@ public struct TypeChecker: DeclVisitor, ExprVisitor, PathVisitor, SignVisitor {
     // Save the expected type, if any.
     let expectedExprType = expectedType
 
-    // Type check the callee.
+    // Type check the callee. The type of generic built-in functions is inferred from the type of
+    // their first argument, which is therefore checked first.
     expectedType = nil
-    var isWellTyped = expr.callee.accept(&self)
+    var isWellTyped: Bool
+    var checkedArgCount = 0
+    if var path = expr.callee as? NamePath,
+       gamma[path.name] == nil,
+       TypeChecker.genericBuiltins.contains(path.name),
+       !expr.args.isEmpty
+    {
+      isWellTyped = expr.args[0].accept(&self)
+      checkedArgCount = 1
+      isWellTyped = visit(genericBuiltin: &path, firstArg: expr.args[0]) && isWellTyped
+      expr.callee = path
+    } else {
+      isWellTyped = expr.callee.accept(&self)
+    }
 
     // The callee must have a function type.
     guard case .func(let params, let output) = expr.callee.type else {
@@ -240,15 +296,22 @@ public struct TypeChecker: DeclVisitor, ExprVisitor, PathVisitor, SignVisitor {
       return false
     }
 
+    // Bindings that are mutated while the arguments are evaluated may not have the same value when
+    // each path is evaluated.
+    var facts = indexFacts
+    facts.unstable = mutatedNames(in: expr) ?? Set(gamma.keys)
+
     // The arguments should have the same type as the parameters.
     var inoutArgs: [Path] = []
     for i in 0 ..< params.count {
-      expectedType = params[i]
-      isWellTyped = expr.args[i].accept(&self) && isWellTyped
+      if i >= checkedArgCount {
+        expectedType = params[i]
+        isWellTyped = expr.args[i].accept(&self) && isWellTyped
+      }
 
       if case .inout = params[i], let path = (expr.args[i] as? InoutExpr)?.path {
         for other in inoutArgs {
-          if mayOverlap(path, other) {
+          if mayOverlap(path, other, facts: facts) {
             diagConsumer.consume(.exclusiveAccessViolation(range: expr.args[i].range))
             isWellTyped = false
           }
@@ -366,7 +429,9 @@ public struct TypeChecker: DeclVisitor, ExprVisitor, PathVisitor, SignVisitor {
     }
 
     // Update the typing context.
+    let oldFacts = indexFacts
     gamma[expr.decl.name] = (expr.decl.mutability, expr.decl.type!)
+    indexFacts = indexFacts.forgetting(expr.decl.name)
 
     // Type check the body of the expression.
     expectedType = expectedExprType
@@ -375,6 +440,7 @@ public struct TypeChecker: DeclVisitor, ExprVisitor, PathVisitor, SignVisitor {
 
     // Restore the typing context.
     gamma[expr.decl.name] = nil
+    indexFacts = oldFacts
 
     // Make sure the type we inferred is the same type as what was expected.
     guard (expectedExprType == nil) || (expectedExprType == expr.type) else {
@@ -472,11 +538,17 @@ public struct TypeChecker: DeclVisitor, ExprVisitor, PathVisitor, SignVisitor {
     expectedType = .int
     var isWellTyped = expr.cond.accept(&self)
 
-    // Type check both branches.
+    // Type check both branches, assuming the facts that the condition establishes.
+    let oldFacts = indexFacts
+    let isConstant = { [gamma] (name: String) in gamma[name]?.mutability == .let }
+
     expectedType = expectedExprType
+    indexFacts = oldFacts.assuming(expr.cond, holds: true, isConstant: isConstant)
     isWellTyped = expr.succ.accept(&self) && isWellTyped
     expectedType = expectedExprType ?? expr.succ.type
+    indexFacts = oldFacts.assuming(expr.cond, holds: false, isConstant: isConstant)
     isWellTyped = expr.fail.accept(&self) && isWellTyped
+    indexFacts = oldFacts
 
     // Make sure the type we inferred is the same type as what was expected.
     expr.type = expr.succ.type
@@ -499,10 +571,16 @@ public struct TypeChecker: DeclVisitor, ExprVisitor, PathVisitor, SignVisitor {
     expectedType = .int
     var isWellTyped = expr.cond.accept(&self)
 
-    // Type the body.
+    // Type the body, assuming the facts that the condition establishes.
+    let oldFacts = indexFacts
+    let isConstant = { [gamma] (name: String) in gamma[name]?.mutability == .let }
+
     expectedType = nil
+    indexFacts = oldFacts.assuming(expr.cond, holds: true, isConstant: isConstant)
     isWellTyped = expr.body.accept(&self) && isWellTyped
+    indexFacts = oldFacts.assuming(expr.cond, holds: false, isConstant: isConstant)
     isWellTyped = expr.tail.accept(&self) && isWellTyped
+    indexFacts = oldFacts
 
     // Make sure the type we inferred is the same type as what was expected.
     expr.type = expr.tail.type
@@ -614,6 +692,99 @@ public struct TypeChecker: DeclVisitor, ExprVisitor, PathVisitor, SignVisitor {
     return !type.hasError
   }
 
+  /// The names of the built-in functions whose type depends on that of their first argument.
+  static let genericBuiltins: Set<String> = [
+    "append", "poplast", "pushfront", "popfront", "heappush", "heappop", "copyrange", "fill",
+    "reverse", "concat", "count", "repeating", "scatter", "spill", "advise",
+  ]
+
+  /// Infers the type of a reference to a generic built-in function from the first argument of
+  /// the call in which it occurs.
+  private mutating func visit(genericBuiltin path: inout NamePath, firstArg: Expr) -> Bool {
+    path.mutability = .let
+
+    guard let argType = firstArg.type, !argType.hasError else {
+      path.type = .error
+      return false
+    }
+
+    // `scatter` takes a unary function, which it applies to each element of an array.
+    if path.name == "scatter" {
+      guard case .func(let params, let output) = argType,
+            params.count == 1, !params[0].isInoutType
+      else {
+        diagConsumer.consume(
+          .invalidGenericBuiltinArg(name: path.name, type: argType, range: firstArg.range))
+        path.type = .error
+        return false
+      }
+
+      path.type = .func(params: [argType, .array(elem: params[0])], output: .array(elem: output))
+      return true
+    }
+
+    // `repeating` takes a value of any type, which it copies into each element of a new array.
+    if path.name == "repeating" {
+      guard !argType.isInoutType else {
+        diagConsumer.consume(
+          .invalidGenericBuiltinArg(name: path.name, type: argType, range: firstArg.range))
+        path.type = .error
+        return false
+      }
+
+      path.type = .func(params: [argType, .int], output: .array(elem: argType))
+      return true
+    }
+
+    // `concat`, `count` and `advise` take their first argument by value; all other functions
+    // take it `inout`.
+    let byValue = ["concat", "count", "advise"].contains(path.name)
+    let elem: Type
+    switch argType {
+    case .inout(base: .array(let e)) where !byValue:
+      elem = e
+    case .array(let e) where byValue:
+      elem = e
+    default:
+      diagConsumer.consume(
+        .invalidGenericBuiltinArg(name: path.name, type: argType, range: firstArg.range))
+      path.type = .error
+      return false
+    }
+
+    let source = Type.array(elem: elem)
+    let array = Type.inout(base: source)
+    let less = Type.func(params: [elem, elem], output: .int)
+    switch path.name {
+    case "append", "pushfront":
+      path.type = .func(params: [array, elem], output: .int)
+    case "poplast", "popfront":
+      path.type = .func(params: [array], output: elem)
+    case "heappush":
+      path.type = .func(params: [array, elem, less], output: .int)
+    case "heappop":
+      path.type = .func(params: [array, less], output: elem)
+    case "copyrange":
+      path.type = .func(params: [array, .int, source, .int, .int], output: .int)
+    case "fill":
+      path.type = .func(params: [array, .int, .int, elem], output: .int)
+    case "reverse":
+      path.type = .func(params: [array, .int, .int], output: .int)
+    case "concat":
+      path.type = .func(params: [source, source], output: source)
+    case "count":
+      path.type = .func(params: [source], output: .int)
+    case "spill":
+      path.type = .func(params: [array], output: .int)
+    case "advise":
+      path.type = .func(params: [source, .int], output: .int)
+    default:
+      unreachable()
+    }
+
+    return true
+  }
+
   // T-BindingRef.
   public mutating func visit(path: inout NamePath) -> PathResult {
     defer { expectedType = nil }
@@ -634,12 +805,44 @@ public struct TypeChecker: DeclVisitor, ExprVisitor, PathVisitor, SignVisitor {
     case "sqrt":
       path.type = .func(params: [.float], output: .float)
 
-    case "imod":
+    case "imod", "rotl", "rotr":
       path.type = .func(params: [.int, .int], output: .int)
 
+    case "popcount", "clz", "ctz":
+      path.type = .func(params: [.int], output: .int)
+
+    case "strlen", "strhash":
+      path.type = .func(params: [.string], output: .int)
+
+    case "strbyte":
+      path.type = .func(params: [.string, .int], output: .int)
+
+    case "strfind":
+      path.type = .func(params: [.string, .string], output: .int)
+
+    case "strslice":
+      path.type = .func(params: [.string, .int, .int], output: .string)
+
+    case "strcat":
+      path.type = .func(params: [.string, .string], output: .string)
+
+    case "pack", "unpack":
+      path.type = .func(params: [.array(elem: .int)], output: .array(elem: .int))
+
+    case "packedcount":
+      path.type = .func(params: [.array(elem: .int)], output: .int)
+
+    case "packedget":
+      path.type = .func(params: [.array(elem: .int), .int], output: .int)
+
+    case "packedset":
+      path.type = .func(params: [.inout(base: .array(elem: .int)), .int, .int], output: .int)
+
     default:
       if path.name == "_" {
         diagConsumer.consume(.invalidUseOfUnderscore(range: path.range))
+      } else if TypeChecker.genericBuiltins.contains(path.name) {
+        diagConsumer.consume(.genericBuiltinReference(name: path.name, range: path.range))
       } else {
         diagConsumer.consume(.undefinedBinding(name: path.name, range: path.range))
       }
@@ -748,9 +951,10 @@ public struct TypeChecker: DeclVisitor, ExprVisitor, PathVisitor, SignVisitor {
 
     // Check for built-in names.
     switch sign.name {
-    case "Any"  : sign.type = .any
-    case "Int"  : sign.type = .int
-    case "Float": sign.type = .float
+    case "Any"   : sign.type = .any
+    case "Int"   : sign.type = .int
+    case "Float" : sign.type = .float
+    case "String": sign.type = .string
     default:
       diagConsumer.consume(.undefinedType(name: sign.name, range: sign.range))
       sign.type = .error
@@ -786,29 +990,34 @@ public struct TypeChecker: DeclVisitor, ExprVisitor, PathVisitor, SignVisitor {
 
   /// Type checks the signature of the given function literal.
   private mutating func visit(signOf literal: inout FuncExpr) -> Type {
-    // Type check the parameters of the function literal.
+    return visit(params: &literal.params, output: &literal.output)
+  }
+
+  /// Type checks the parameters and the output signature of a function.
+  private mutating func visit(params decls: inout [ParamDecl], output: inout Sign) -> Type {
+    // Type check the parameters of the function.
     var names : Set<String> = []
     var params: [Type] = []
 
-    for i in 0 ..< literal.params.count {
+    for i in 0 ..< decls.count {
       // Realize the parameter's signature.
-      let name = literal.params[i].name
-      let type = literal.params[i].sign.accept(&self)
+      let name = decls[i].name
+      let type = decls[i].sign.accept(&self)
 
       // Check for duplicate parameter declaration.
       if names.contains(name) {
-        diagConsumer.consume(.duplicateParamDecl(decl: literal.params[i]))
-        literal.params[i].type = .error
+        diagConsumer.consume(.duplicateParamDecl(decl: decls[i]))
+        decls[i].type = .error
       } else {
         names.insert(name)
-        literal.params[i].type = type
+        decls[i].type = type
       }
 
-      params.append(literal.params[i].type!)
+      params.append(decls[i].type!)
     }
 
     // Realize the type of the function's output.
-    let outputType = literal.output.accept(&self)
+    let outputType = output.accept(&self)
 
     return .func(params: params, output: outputType)
   }
@@ -821,8 +1030,10 @@ public struct TypeChecker: DeclVisitor, ExprVisitor, PathVisitor, SignVisitor {
   private mutating func visit(bodyOf literal: inout FuncExpr) -> Bool {
     // Save the current typing context.
     let oldGamma = gamma
+    let oldFacts = indexFacts
     defer {
       gamma = oldGamma
+      indexFacts = oldFacts
       expectedType = nil
     }
 
@@ -833,6 +1044,7 @@ public struct TypeChecker: DeclVisitor, ExprVisitor, PathVisitor, SignVisitor {
 
     // Update the typing context.
     for param in literal.params {
+      indexFacts = indexFacts.forgetting(param.name)
       if case .inout(let baseType) = param.type {
         gamma[param.name] = (.var, baseType)
       } else {
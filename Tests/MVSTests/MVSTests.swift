@@ -3,6 +3,7 @@ import LLVM
 
 import AST
 import CodeGen
+import Modules
 import Parse
 import Sema
 
@@ -61,20 +62,477 @@ final class MVSTests: XCTestCase {
     }
   }
 
+  func testModules() throws {
+    let consumer = Consumer()
+    let target = try TargetMachine()
+    var parser = MVSParser()
+
+    // Compile a module, exporting its functions.
+    let source = """
+      struct Pair { var x: Int; var y: Int } in
+      fun sum(p: Pair) -> Int { p.x + p.y } in
+      fun total(a: [Int]) -> Int { a[0] + a[1] } in
+      fun bump(a: [Int], x: Int) -> [Int] { var b = a in b[0] = b[0] + x in b } in
+      """
+    var library = try XCTUnwrap(parser.parse(module: source, diagConsumer: consumer))
+    library.entry = export(library.entry, module: "lib")
+
+    var checker = TypeChecker(diagConsumer: consumer)
+    XCTAssert(checker.visit(&library))
+
+    var libraryEmitter = try Emitter(target: target)
+    let libraryModule = try libraryEmitter.emit(module: &library, name: "lib")
+    XCTAssertEqual(libraryEmitter.exportedSummaries["lib.bump"]?.inPlaceParams, [0])
+    XCTAssertEqual(libraryEmitter.exportedSummaries["lib.total"]?.inPlaceParams, [])
+
+    // Compile a program that calls these functions through their declarations.
+    let interface = """
+      struct Pair { var x: Int; var y: Int } in
+      fun sum(p: Pair) -> Int in
+      fun total(a: [Int]) -> Int in
+      fun bump(a: [Int], x: Int) -> [Int] in
+      """
+    let decls = try XCTUnwrap(parser.parse(module: interface, diagConsumer: consumer))
+    XCTAssertEqual(decls.funcs.count, 3)
+
+    let input = "var s = [1, 2] in s = bump(s, 10) in total(s) * 100 + sum(Pair(3, 4))"
+    var program = try XCTUnwrap(
+      parser.parse(source: input, knownStructs: ["Pair"], diagConsumer: consumer))
+    program.types = decls.types
+    program.funcs = decls.funcs
+    for i in 0 ..< program.funcs.count {
+      program.funcs[i].symbol = "lib.\(program.funcs[i].name)"
+    }
+
+    checker = TypeChecker(diagConsumer: consumer)
+    XCTAssert(checker.visit(&program))
+
+    var emitter = try Emitter(target: target, shouldEmitPrint: true)
+    emitter.importedSummaries = libraryEmitter.exportedSummaries
+    let module = try emitter.emit(program: &program)
+
+    let output = try exec(module: module, on: target, linkingWith: [libraryModule])
+    XCTAssertEqual(output, "1307")
+  }
+
+  func testModuleLoader() throws {
+    let directory = try manager.url(
+      for           : .itemReplacementDirectory,
+      in            : .userDomainMask,
+      appropriateFor: productsDirectory,
+      create        : true)
+    let dependencies = directory.appendingPathComponent("deps")
+    try manager.createDirectory(at: dependencies, withIntermediateDirectories: true)
+
+    // `twice` is small enough to be exported for inlining, `weigh` is exported by its signature.
+    let library = """
+      fun twice(x: Int) -> Int { x * 2 } in
+      fun weigh(a: [Int], i: Int, n: Int) -> Int {
+        if i >= n ? 0 ! a[i] * 3 + weigh(a, i + 1, n)
+      } in
+      """
+    let libraryURL = dependencies.appendingPathComponent("lib.mvs")
+    try library.write(to: libraryURL, atomically: true, encoding: .utf8)
+    try """
+      import lib in
+      fun quad(x: Int) -> Int { twice(twice(x)) } in
+      fun total(a: [Int]) -> Int { weigh(a, 0, 2) } in
+      """.write(to: directory.appendingPathComponent("app.mvs"), atomically: true, encoding: .utf8)
+
+    let target = try TargetMachine()
+    func makeLoader() -> ModuleLoader {
+      return ModuleLoader(
+        searchPaths: [directory, dependencies],
+        options: CompilerOptions(
+          mode                : .debug,
+          maxStackArraySize   : 256,
+          specializationBudget: 2048,
+          inlineThreshold     : 16),
+        target: target)
+    }
+
+    // Modules are compiled after their dependencies, and export the bodies of small functions.
+    var loader = makeLoader()
+    let input = "import app in quad(5) * 100 + total([1, 2])"
+    var parser = MVSParser()
+    let imports = parser.parseImports(source: input, diagConsumer: Consumer())
+    XCTAssertEqual(imports.map({ $0.name }), ["app"])
+
+    let imported = try loader.load(imports: imports.map({ $0.name }))
+    XCTAssertEqual(loader.compiledModules, ["lib", "app"])
+    let declarations = try XCTUnwrap(loader.interfaces["lib"]?.declarations)
+    XCTAssert(declarations.contains("fun twice(x: Int) -> Int { x * 2 } in"))
+    XCTAssert(declarations.contains("fun weigh(a: [Int], i: Int, n: Int) -> Int in"))
+    XCTAssertEqual(imported.inlinableFuncs.map({ $0.name }), ["twice", "quad", "total"])
+    XCTAssertEqual(imported.funcs.map({ $0.name }), ["weigh"])
+
+    // Compile a program importing these modules, and link it with their object files.
+    var program = try XCTUnwrap(
+      parser.parse(source: input, knownStructs: imported.structNames, diagConsumer: Consumer()))
+    XCTAssert(imported.add(to: &program, diagConsumer: Consumer()))
+    var checker = TypeChecker(diagConsumer: Consumer())
+    XCTAssert(checker.visit(&program))
+
+    var emitter = try Emitter(target: target, shouldEmitPrint: true)
+    emitter.importedSummaries = imported.summaries
+    let module = try emitter.emit(program: &program)
+    let objects = [dependencies.appendingPathComponent("lib.o"),
+                   directory.appendingPathComponent("app.o")]
+    XCTAssertEqual(try exec(link(module: module, on: target, objects: objects).path), "2009")
+
+    // Unchanged modules are not recompiled.
+    loader = makeLoader()
+    _ = try loader.load(imports: ["app"])
+    XCTAssertEqual(loader.compiledModules, [])
+
+    // Editing the body of a function exported by its signature does not recompile the importers.
+    let fingerprint = loader.interfaces["lib"]!.fingerprint
+    try library.replacingOccurrences(of: "a[i] * 3", with: "a[i] * 4")
+      .write(to: libraryURL, atomically: true, encoding: .utf8)
+    loader = makeLoader()
+    _ = try loader.load(imports: ["app"])
+    XCTAssertEqual(loader.compiledModules, ["lib"])
+    XCTAssertEqual(loader.interfaces["lib"]?.fingerprint, fingerprint)
+
+    // Editing the body of an inlinable function does.
+    try library.replacingOccurrences(of: "x * 2", with: "x * 3")
+      .write(to: libraryURL, atomically: true, encoding: .utf8)
+    loader = makeLoader()
+    _ = try loader.load(imports: ["app"])
+    XCTAssertEqual(loader.compiledModules, ["lib", "app"])
+
+    // Two modules may not define the same function, whether or not its body is exported.
+    try "fun twice(x: Int) -> Int { x + x } in"
+      .write(to: directory.appendingPathComponent("other.mvs"), atomically: true, encoding: .utf8)
+    loader = makeLoader()
+    XCTAssertThrowsError(try loader.load(imports: ["lib", "other"])) { error in
+      guard case ModuleError.duplicateFunction(name: "twice", modules: ("lib", "other")) = error
+      else { return XCTFail("unexpected error: \(error)") }
+    }
+
+    // Neither may a program redefine an imported function.
+    let log = DiagnosticLog()
+    let redefinition = "import lib in fun weigh(x: Int) -> Int { x } in weigh(1)"
+    program = try XCTUnwrap(parser.parse(source: redefinition, diagConsumer: Consumer()))
+    XCTAssertFalse(try loader.load(imports: ["lib"]).add(to: &program, diagConsumer: log))
+    XCTAssertEqual(
+      log.messages, ["duplicate function declaration 'weigh', already declared by module 'lib'"])
+
+    // Cyclic imports are diagnosed.
+    try "import b in fun f() -> Int { 1 } in"
+      .write(to: directory.appendingPathComponent("a.mvs"), atomically: true, encoding: .utf8)
+    try "import a in fun g() -> Int { 2 } in"
+      .write(to: directory.appendingPathComponent("b.mvs"), atomically: true, encoding: .utf8)
+    XCTAssertThrowsError(try loader.load(imports: ["a"])) { error in
+      guard case ModuleError.cyclicImport(name: "a") = error
+      else { return XCTFail("unexpected error: \(error)") }
+    }
+  }
+
+  func testSpecialization() throws {
+    // Call-site specialization is disabled in debug mode, in which the other test cases are
+    // compiled. Both loops forward their bound to their recursive call, like those of NBody.
+    let input = """
+      fun fill(a: inout [Int], i: Int, n: Int) -> Int {
+        if i >= n ? 0 ! (
+          a[i] = a[i] * 2 + i in
+          fill(&a, i + 1, n)
+        )
+      } in
+      fun sum(a: [Int], i: Int, n: Int) -> Int {
+        if i >= n ? 0 ! a[i] + sum(a, i + 1, n)
+      } in
+      var a = [1, 2, 3, 4] in
+      _ = fill(&a, 0, 4) in
+      sum(a, 0, 4) * 10 + sum(a, 2, 4)
+      """
+
+    let target = try TargetMachine()
+    var parser = MVSParser()
+    let parsed = try XCTUnwrap(parser.parse(source: input, diagConsumer: Consumer()))
+    var checker = TypeChecker(diagConsumer: Consumer())
+    var checked = parsed
+    XCTAssert(checker.visit(&checked))
+
+    // Clones are named after the original function, followed by its identifier.
+    func describe(_ spec: EmitterStatistics.Specialization) -> String {
+      let name = spec.original.dropFirst().prefix(while: { $0.isLetter })
+      return "\(name)(\(spec.reasons.joined(separator: ", ")))"
+    }
+
+    // The recursive calls of each clone are dispatched to a clone specialized for `n` only.
+    var program = checked
+    var emitter = try Emitter(target: target, mode: .release, shouldEmitPrint: true)
+    var module = try emitter.emit(program: &program)
+    XCTAssertEqual(try exec(module: module, on: target), "279")
+
+    let specializations = emitter.statistics.specializations
+    XCTAssert(specializations.allSatisfy({ $0.clone != nil }))
+    XCTAssertEqual(specializations.map(describe).sorted(), [
+      "fill(i = 0, n = 4)",
+      "fill(n = 4)",
+      "sum(i = 0, n = 4)",
+      "sum(i = 2, n = 4)",
+      "sum(n = 4)",
+    ])
+    XCTAssertGreaterThan(emitter.statistics.specializationGrowth, 0)
+
+    // Without budget, every specialization is rejected and the calls use the original functions.
+    program = checked
+    emitter = try Emitter(
+      target: target, mode: .release, shouldEmitPrint: true, specializationBudget: 0)
+    module = try emitter.emit(program: &program)
+    XCTAssertEqual(try exec(module: module, on: target), "279")
+
+    let rejected = emitter.statistics.specializations
+    XCTAssert(rejected.allSatisfy({ $0.clone == nil }))
+    XCTAssertEqual(rejected.map(describe).sorted(), [
+      "fill(i = 0, n = 4)",
+      "sum(i = 0, n = 4)",
+      "sum(i = 2, n = 4)",
+    ])
+    XCTAssertEqual(emitter.statistics.specializationGrowth, 0)
+
+    // Clones are charged the size of the finished original function before their nested clones
+    // are emitted, so that the growth never exceeds the budget.
+    for budget in [16, 32, 64, 128, 256] {
+      program = checked
+      emitter = try Emitter(
+        target: target, mode: .release, shouldEmitPrint: true, specializationBudget: budget)
+      module = try emitter.emit(program: &program)
+      XCTAssertEqual(try exec(module: module, on: target), "279")
+      XCTAssertLessThanOrEqual(emitter.statistics.specializationGrowth, budget)
+    }
+
+    // The size of `walk` is unknown while its body is emitted, so the call to `walk(n, 0)` in the
+    // original function isn't specialized. Calls emitted after its definition are.
+    let recursive = """
+      fun walk(i: Int, n: Int) -> Int {
+        if i >= n ? i ! walk(i + 1, n) + walk(n, 0)
+      } in
+      walk(0, 3)
+      """
+    program = try XCTUnwrap(parser.parse(source: recursive, diagConsumer: Consumer()))
+    checker = TypeChecker(diagConsumer: Consumer())
+    XCTAssert(checker.visit(&program))
+    emitter = try Emitter(target: target, mode: .release, shouldEmitPrint: true)
+    module = try emitter.emit(program: &program)
+    XCTAssertEqual(try exec(module: module, on: target), "12")
+
+    let unfinished = emitter.statistics.specializations.filter({ $0.clone == nil })
+    XCTAssertEqual(unfinished.map(describe), ["walk(n = 0)"])
+  }
+
+  func testHoistedAddressOnlyValues() throws {
+    // The struct built at each iteration is hoisted out of the loop and passed by pointer to the
+    // function emitted for its body, which must therefore be allowed to read memory.
+    let input = """
+      struct P { var x: Int; var y: Int } in
+      fun sum(i: Int, n: Int, k: Int, acc: Int) -> Int {
+        let p = P(k, k * 2) in
+        if i >= n ? acc ! sum(i + 1, n, k, acc + p.x + p.y)
+      } in
+      sum(0, 4, 5, 0)
+      """
+
+    let target = try TargetMachine()
+    var parser = MVSParser()
+    var program = try XCTUnwrap(parser.parse(source: input, diagConsumer: Consumer()))
+    var checker = TypeChecker(diagConsumer: Consumer())
+    XCTAssert(checker.visit(&program))
+
+    var emitter = try Emitter(target: target, mode: .release, shouldEmitPrint: true)
+    let module = try emitter.emit(program: &program)
+    XCTAssertEqual(try exec(module: module, on: target), "60")
+
+    let inner = try XCTUnwrap(
+      emitter.statistics.effectAttributes.first(where: { $0.function.hasSuffix(".inv") }))
+    XCTAssertFalse(inner.attributes.contains("readnone"))
+    XCTAssert(inner.attributes.contains("readonly"))
+  }
+
+  func testStorageReuse() throws {
+    // A function that consumes its input and builds an output of the same length reinitializes
+    // the storage of its input when called in place, rather than dropping it.
+    let input = """
+      fun step(s: [Int], n: Int) -> [Int] {
+        if n == 0 ? s ! step([s[1], s[0] + s[1], s[2] + 1], n - 1)
+      } in
+      fun tag(a: [Int], x: Int) -> [Int] {
+        let k = a[0] in
+        [x, k]
+      } in
+      var s = [0, 1, 0] in
+      let t = s in
+      s = step(s, 10) in
+      var b = [7, 8] in
+      b = tag(b, 5) in
+      s[1] * 100 + t[1] * 10 + b[1]
+      """
+
+    let target = try TargetMachine()
+    var parser = MVSParser()
+    var program = try XCTUnwrap(parser.parse(source: input, diagConsumer: Consumer()))
+    var checker = TypeChecker(diagConsumer: Consumer())
+    XCTAssert(checker.visit(&program))
+
+    var emitter = try Emitter(target: target, shouldEmitPrint: true)
+    let module = try emitter.emit(program: &program)
+    XCTAssertEqual(try exec(module: module, on: target), "8917")
+
+    // The literal built by `tag` reads a constant alias of its input, so it is not reused.
+    XCTAssertEqual(emitter.statistics.reusedTailCount, 1)
+  }
+
+  func testRemarks() throws {
+    // `fill` is a loop written as a recursive function, which uniquifies `a` at each iteration.
+    // `reset` uniquifies it once per call.
+    let input = """
+      fun fill(a: inout [Int], i: Int, n: Int) -> Int {
+        if i >= n ? 0 ! (
+          a[i] = i * 2 in
+          fill(&a, i + 1, n)
+        )
+      } in
+      fun reset(a: inout [Int]) -> Int {
+        a[0] = 9 in 0
+      } in
+      var a = [0, 0, 0] in
+      _ = fill(&a, 0, 3) in
+      _ = reset(&a) in
+      a[0] * 100 + a[1] * 10 + a[2]
+      """
+
+    let target = try TargetMachine()
+    var parser = MVSParser()
+    var program = try XCTUnwrap(parser.parse(source: input, diagConsumer: Consumer()))
+    var checker = TypeChecker(diagConsumer: Consumer())
+    XCTAssert(checker.visit(&program))
+
+    var emitter = try Emitter(target: target, shouldEmitPrint: true)
+    let module = try emitter.emit(program: &program)
+    XCTAssertEqual(try exec(module: module, on: target), "924")
+
+    let remarks = emitter.statistics.remarks.filter({ $0.message.hasPrefix("uniq not hoisted") })
+    XCTAssertEqual(remarks.count, 1)
+    XCTAssertEqual(
+      remarks.first?.message, "uniq not hoisted: array uniquified on every iteration of the loop")
+    XCTAssertEqual(remarks.first?.range, input.range(of: "a[i]"))
+  }
+
+  func testMalformedPackedArrays() throws {
+    // Packed arrays are ordinary arrays of integers, so programs can corrupt their encoding. The
+    // runtime must reject them rather than read out of their storage.
+    let inputs = [
+      "count(unpack([5]))",
+      "var p = pack([1, 2, 3]) in p[0] = 1000000 in count(unpack(p))",
+      "var p = pack([1, 2, 3]) in p[1] = 7 in packedcount(p)",
+      "var p = pack([1, 2, 3]) in p[4] = 100 in count(unpack(p))",
+      "var p = pack([1, 2, 3]) in p[4] = 256002 in packedget(p, 1)",
+      "var p = pack([1, 2, 3]) in p[4] = 2 in packedset(&p, 1, 1000000)",
+      "let p = pack([1, 2, 3]) in packedget(p, 3)",
+      "var p = pack([1, 2, 3]) in packedset(&p, -1, 0)",
+    ]
+
+    let target = try TargetMachine()
+    for input in inputs {
+      var parser = MVSParser()
+      var program = try XCTUnwrap(parser.parse(source: input, diagConsumer: Consumer()))
+      var checker = TypeChecker(diagConsumer: Consumer())
+      XCTAssert(checker.visit(&program))
+
+      var emitter = try Emitter(target: target, shouldEmitPrint: true)
+      let module = try emitter.emit(program: &program)
+      let result = try run(link(module: module, on: target).path)
+      XCTAssertNil(result.output, input)
+      XCTAssertNotEqual(result.status, 0, input)
+    }
+  }
+
+  func testExecutorWorkerFailures() throws {
+    // Applying `probe` to 5 aborts, killing the worker that processes it. The worker is restarted
+    // and the batch is sent again, until it has killed 3 workers and the program is aborted.
+    let input = """
+      fun probe(n: Int) -> Int {
+        let p = pack([1, 2, 3]) in
+        packedget(p, n)
+      } in
+      let r = scatter(probe, [0, 1, 2, 5, 1, 0]) in
+      r[0] + r[1] + r[2]
+      """
+
+    let target = try TargetMachine()
+    var parser = MVSParser()
+    let parsed = try XCTUnwrap(parser.parse(source: input, diagConsumer: Consumer()))
+    var checker = TypeChecker(diagConsumer: Consumer())
+    var program = parsed
+    XCTAssert(checker.visit(&program))
+
+    var emitter = try Emitter(target: target, shouldEmitPrint: true)
+    let module = try emitter.emit(program: &program)
+    let path = try link(module: module, on: target).path
+
+    let result = try run(path, environment: ["MVS_WORKERS": "2", "MVS_EXECUTOR_BATCH": "1"])
+    XCTAssertNil(result.output)
+    XCTAssertNotEqual(result.status, 0)
+    XCTAssert(
+      result.errors.contains("fatal error: worker processes died 3 times on elements [3, 4)"),
+      result.errors)
+    XCTAssertEqual(
+      result.errors.components(separatedBy: "index 5 out of range of packed array").count - 1, 3)
+
+    // Without workers, the caller aborts on the first failure.
+    let local = try run(path, environment: ["MVS_WORKERS": "0"])
+    XCTAssertNotEqual(local.status, 0)
+    XCTAssertFalse(local.errors.contains("worker processes died"))
+  }
+
+  /// Sets the symbol of each function in the given chain of function bindings.
+  private func export(_ expr: Expr, module: String) -> Expr {
+    guard var binding = expr as? FuncBindingExpr else { return expr }
+    binding.symbol = "\(module).\(binding.name)"
+    binding.body = export(binding.body, module: module)
+    return binding
+  }
+
   /// Compiles and executes the given module.
   ///
   /// - Parameters:
   ///   - module: The LLVM module to compile and execute.
   ///   - target: The target machine for which the module should be compiled.
-  private func exec(module: LLVM.Module, on target: TargetMachine) throws -> String? {
-    // Compile the module.
+  ///   - others: The modules defining the functions that `module` imports.
+  private func exec(
+    module: LLVM.Module, on target: TargetMachine, linkingWith others: [LLVM.Module] = []
+  ) throws -> String? {
+    return try exec(link(module: module, on: target, linkingWith: others).path)
+  }
+
+  /// Compiles the given module and links it with the runtime, returning the executable's URL.
+  ///
+  /// - Parameters:
+  ///   - module: The LLVM module to compile.
+  ///   - target: The target machine for which the module should be compiled.
+  ///   - others: The modules defining the functions that `module` imports.
+  ///   - compiledObjects: The object files defining the functions that `module` imports.
+  private func link(
+    module: LLVM.Module,
+    on target: TargetMachine,
+    linkingWith others: [LLVM.Module] = [],
+    objects compiledObjects: [URL] = []
+  ) throws -> URL {
+    // Compile the modules.
     let temporary = try manager.url(
       for           : .itemReplacementDirectory,
       in            : .userDomainMask,
       appropriateFor: productsDirectory,
       create        : true)
-    let object = temporary.appendingPathComponent("\(module.name).o")
-    try target.emitToFile(module: module, type: .object, path: object.path)
+
+    var objects = compiledObjects.map({ $0.path })
+    for m in [module] + others {
+      let object = temporary.appendingPathComponent("\(m.name).o")
+      try target.emitToFile(module: m, type: .object, path: object.path)
+      objects.append(object.path)
+    }
 
     // Get the path to the runtime library.
     let runtime = ProcessInfo.processInfo.environment["MVS_RUNTIME"]
@@ -82,10 +540,8 @@ final class MVSTests: XCTestCase {
 
     // Link the module.
     let output = temporary.appendingPathComponent("\(module.name)")
-    _ = try exec("/usr/bin/clang++", args: ["-std=c++14", object.path, runtime, "-o", output.path])
-
-    // Run the executable.
-    return try exec(output.path)
+    _ = try exec("/usr/bin/clang++", args: ["-std=c++14"] + objects + [runtime, "-o", output.path])
+    return output
   }
 
   /// Executes the given executable.
@@ -96,27 +552,49 @@ final class MVSTests: XCTestCase {
   ///
   /// - Returns: The standard output of the process, or `nil` if it was empty.
   private func exec(_ path: String, args: [String] = []) throws -> String? {
+    return try run(path, args: args).output
+  }
+
+  /// Executes the given executable.
+  ///
+  /// - Parameters:
+  ///   - path: The path to the executable that should be ran.
+  ///   - args: A list of arguments that are passed to the executable.
+  ///   - environment: Variables added to the environment of the process.
+  ///
+  /// - Returns: The standard output of the process, or `nil` if it was empty, its standard error,
+  ///   and the status with which it terminated.
+  private func run(
+    _ path: String, args: [String] = [], environment: [String: String] = [:]
+  ) throws -> (output: String?, errors: String, status: Int32) {
     let pipe = Pipe()
+    let errorPipe = Pipe()
     let process = Process()
 
     // https://stackoverflow.com/questions/67595371
-    process.environment?["OS_ACTIVITY_DT_MODE"] = nil
+    var env = ProcessInfo.processInfo.environment
+    env["OS_ACTIVITY_DT_MODE"] = nil
+    env.merge(environment, uniquingKeysWith: { _, new in new })
+    process.environment = env
 
     process.executableURL = URL(fileURLWithPath: path).absoluteURL
     process.arguments = args
     process.standardOutput = pipe
+    process.standardError = errorPipe
     try process.run()
+
+    // Read the pipes before waiting, so that the process doesn't block on a full pipe.
+    let outputData = pipe.fileHandleForReading.readDataToEndOfFile()
+    let errorData = errorPipe.fileHandleForReading.readDataToEndOfFile()
     process.waitUntilExit()
 
-    guard let output = String(
-            data: pipe.fileHandleForReading.readDataToEndOfFile(),
-            encoding: .utf8)
-    else {
-      return nil
+    let errors = String(decoding: errorData, as: UTF8.self)
+    guard let output = String(data: outputData, encoding: .utf8) else {
+      return (nil, errors, process.terminationStatus)
     }
 
     let result = output.trimmingCharacters(in: .whitespacesAndNewlines)
-    return result.isEmpty ? nil : result
+    return (result.isEmpty ? nil : result, errors, process.terminationStatus)
   }
 
 
@@ -134,6 +612,18 @@ final class MVSTests: XCTestCase {
 
 }
 
+/// A diagnostic consumer that records the messages of the diagnostics it consumes.
+private final class DiagnosticLog: DiagnosticConsumer {
+
+  /// The messages of the consumed diagnostics, in order.
+  var messages: [String] = []
+
+  func consume(_ diagnostic: Diagnostic) {
+    messages.append(diagnostic.message)
+  }
+
+}
+
 private struct Consumer: DiagnosticConsumer {
 
   /// The line number at which assertion failures are thrown.